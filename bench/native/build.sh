@@ -0,0 +1,9 @@
+#!/bin/sh
+# Build the native benchmark driver against a system GDAL (gdal-config on PATH).
+# The WASM side is the app itself: run the harness against `pnpm run dev`.
+set -e
+cd "$(dirname "$0")"
+${CXX:-c++} -O2 -std=c++17 -DNDEBUG -I../../src/native $(gdal-config --cflags) \
+  ../../src/native/native.cpp native-bench.cpp \
+  -o native-bench $(gdal-config --libs) -lpthread
+echo "built $(pwd)/native-bench"
@@ -0,0 +1,105 @@
+// Native benchmark driver: runs one conversion through the same Native API the
+// worker uses and prints a JSON record (see bench/README.md).
+//
+//   native-bench <input> <inputFormat> <outputFormat> [--repeat N] [--save <path>]
+#include "native.h"
+#include <sys/resource.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+static std::string escapeJson(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) out += c;
+    }
+    return out;
+}
+
+// peak resident set size of the process so far (ru_maxrss is in KB on Linux)
+static long long peakRssBytes() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<long long>(usage.ru_maxrss) * 1024;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        fprintf(stderr, "usage: %s <input> <inputFormat> <outputFormat> [--repeat N] [--save <path>]\n", argv[0]);
+        return 2;
+    }
+    const std::string inputPath = argv[1];
+    const std::string inputFormat = argv[2];
+    const std::string outputFormat = argv[3];
+    int repeat = 1;
+    std::string savePath;
+    for (int i = 4; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--repeat") == 0) repeat = std::max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--save") == 0) savePath = argv[i + 1];
+    }
+
+    std::ifstream in(inputPath, std::ios::binary);
+    if (!in) {
+        fprintf(stderr, "cannot read %s\n", inputPath.c_str());
+        return 2;
+    }
+    const std::vector<char> input((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    Native::initialize("");
+
+    ConversionPlan plan;
+    plan.outputFormat = outputFormat;
+    plan.explodeCollections = true;
+
+    double bestWall = -1;
+    std::string bestTimings = "{}";
+    std::string bestMemory = "{}";
+    size_t outputBytes = 0;
+    std::string error;
+
+    for (int run = 0; run < repeat && error.empty(); run++) {
+        // converted from a fresh VSIMalloc copy, like the worker's copyToHeap
+        const size_t address = Native::allocBuffer(input.size());
+        memcpy(reinterpret_cast<void*>(address), input.data(), input.size());
+
+        const auto start = std::chrono::steady_clock::now();
+        const int outputId = Native::convertBufferWithPlan(address, input.size(), inputFormat, plan);
+        const double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Native::freeBuffer(address);
+
+        if (!outputId) {
+            error = Native::getLastError();
+            if (error.empty()) error = "Conversion failed";
+            break;
+        }
+
+        outputBytes = Native::getOutputSize(outputId);
+        if (bestWall < 0 || wall < bestWall) {
+            bestWall = wall;
+            bestTimings = Native::getLastTimings();
+            bestMemory = Native::getLastMemoryUsage();
+        }
+        if (run == 0 && !savePath.empty()) {
+            std::ofstream out(savePath, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(Native::getOutputAddress(outputId)), outputBytes);
+        }
+        Native::releaseOutput(outputId);
+    }
+
+    printf("{\"input\":\"%s\",\"inputFormat\":\"%s\",\"outputFormat\":\"%s\",\"inputBytes\":%zu,",
+           escapeJson(inputPath).c_str(), escapeJson(inputFormat).c_str(),
+           escapeJson(outputFormat).c_str(), input.size());
+    if (!error.empty()) {
+        printf("\"ok\":false,\"error\":\"%s\"}\n", escapeJson(error).c_str());
+        return 1;
+    }
+    printf("\"ok\":true,\"runs\":%d,\"wallMs\":%.3f,\"outputBytes\":%zu,\"peakHeapBytes\":%lld,\"timings\":%s,\"memory\":%s}\n",
+           repeat, bestWall, outputBytes, peakRssBytes(), bestTimings.c_str(), bestMemory.c_str());
+    return 0;
+}
@@ -0,0 +1,311 @@
+#!/usr/bin/env node
+/**
+ * Conversion benchmark harness.
+ *
+ * Generates synthetic GeoJSON datasets (e2e/fixtures/generate-fixtures.cjs),
+ * derives the other input formats from them with the converter itself, then
+ * times every input→output pair and reports features/s, MB/s and peak heap,
+ * per phase where the native timings split the work. See bench/README.md.
+ *
+ *   node bench/run.cjs --target wasm --features 1e3,1e5 --geometry point,polygon
+ */
+const fs = require('fs');
+const path = require('path');
+const { execFileSync } = require('child_process');
+const { writeSyntheticGeoJson } = require('../e2e/fixtures/generate-fixtures.cjs');
+
+const BENCH_DIR = __dirname;
+const DATA_DIR = path.join(BENCH_DIR, 'data');
+const RESULTS_DIR = path.join(BENCH_DIR, 'results');
+const NATIVE_BINARY = path.join(BENCH_DIR, 'native', 'native-bench');
+
+// Read/write formats of the converter (the inputOutput entries of
+// src/components/SupportedFormats.jsx); 'core' is the default matrix
+const CORE_FORMATS = [
+  'geojson', 'shapefile', 'geopackage', 'kml', 'gpx', 'gml', 'flatgeobuf', 'csv', 'geojsonseq'
+];
+const ALL_FORMATS = [
+  'geojson', 'shapefile', 'geopackage', 'kml', 'gpx', 'gml', 'mapinfo', 'mapinfomif',
+  'flatgeobuf', 'dxf', 'csv', 'pmtiles', 'mbtiles', 'dgn', 'geojsonseq', 'georss',
+  'geoconcept', 'jml', 'jsonfg', 'mapml', 'ods', 'ogr_gmt', 'pcidsk', 'pds4', 's57',
+  'sqlite', 'selafin', 'vdv', 'vicar', 'wasp', 'xlsx', 'openfilegdb'
+];
+
+// Phases of the native timing report, in pipeline order
+const PHASES = ['materialize', 'open', 'count', 'translate', 'zip', 'copyOut'];
+
+const MB = 1024 * 1024;
+
+const parseArgs = (argv) => {
+  const args = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (!argv[i].startsWith('--')) continue;
+    const next = argv[i + 1];
+    if (next === undefined || next.startsWith('--')) {
+      args[argv[i].slice(2)] = true;
+    } else {
+      args[argv[i].slice(2)] = next;
+      i++;
+    }
+  }
+  return args;
+};
+
+const listArg = (value, fallback) => String(value ?? fallback).split(',').map((v) => v.trim()).filter(Boolean);
+
+const formatsArg = (value) => {
+  if (value === undefined || value === 'core') return CORE_FORMATS;
+  if (value === 'all') return ALL_FORMATS;
+  return listArg(value);
+};
+
+// Build the dataset list and write any GeoJSON files that are not on disk yet
+const prepareDatasets = ({ features, geometries, fields, vertices }) => {
+  const datasets = [];
+  for (const geometry of geometries) {
+    for (const count of features) {
+      for (const fieldCount of fields) {
+        const name = `${geometry}-${count}-f${fieldCount}`;
+        const file = path.join(DATA_DIR, `${name}.geojson`);
+        if (!fs.existsSync(file)) {
+          console.log(`generating ${name}...`);
+          writeSyntheticGeoJson(file, { features: count, geometry, fields: fieldCount, vertices });
+        }
+        datasets.push({ name, geometry, features: count, fields: fieldCount, file });
+      }
+    }
+  }
+  return datasets;
+};
+
+// Throughput figures of one timed conversion
+const summarize = (dataset, inputFormat, outputFormat, result) => {
+  const record = { dataset: dataset.name, geometry: dataset.geometry, features: dataset.features,
+                   fields: dataset.fields, inputFormat, outputFormat, ...result };
+  if (!result.ok) return record;
+
+  const inputMB = result.inputBytes / MB;
+  const rate = (ms) => (ms > 0 ? { featuresPerSec: dataset.features / (ms / 1000), mbPerSec: inputMB / (ms / 1000) } : {});
+  record.featuresPerSec = rate(result.wallMs).featuresPerSec;
+  record.mbPerSec = rate(result.wallMs).mbPerSec;
+  record.phases = {};
+  for (const phase of PHASES) {
+    const ms = result.timings?.[phase] ?? 0;
+    record.phases[phase] = { ms, ...rate(ms) };
+  }
+  return record;
+};
+
+// ---- native target: bench/native/native-bench, one process per conversion
+
+const runNative = (file, inputFormat, outputFormat, { repeat, save }) => {
+  const args = [file, inputFormat, outputFormat, '--repeat', String(repeat)];
+  if (save) args.push('--save', save);
+  let stdout;
+  try {
+    stdout = execFileSync(NATIVE_BINARY, args, { encoding: 'utf8', maxBuffer: 16 * MB });
+  } catch (error) {
+    stdout = error.stdout || '';
+    if (!stdout.trim()) return { ok: false, error: error.message };
+  }
+  return JSON.parse(stdout.trim().split('\n').pop());
+};
+
+const benchNative = async (datasets, inputs, outputs, repeat) => {
+  if (!fs.existsSync(NATIVE_BINARY)) {
+    throw new Error('Native driver not built: run bench/native/build.sh first');
+  }
+  const records = [];
+  for (const dataset of datasets) {
+    for (const inputFormat of inputs) {
+      let file = dataset.file;
+      if (inputFormat !== 'geojson') {
+        file = path.join(DATA_DIR, 'derived', `${dataset.name}.${inputFormat}`);
+        if (!fs.existsSync(file)) {
+          fs.mkdirSync(path.dirname(file), { recursive: true });
+          const derived = runNative(dataset.file, 'geojson', inputFormat, { repeat: 1, save: file });
+          if (!derived.ok) {
+            console.log(`skip ${dataset.name} as ${inputFormat}: ${derived.error}`);
+            continue;
+          }
+        }
+      }
+      for (const outputFormat of outputs) {
+        const record = summarize(dataset, inputFormat, outputFormat,
+                                 runNative(file, inputFormat, outputFormat, { repeat }));
+        printRecord(record);
+        records.push(record);
+      }
+    }
+  }
+  return records;
+};
+
+// ---- wasm target: the app's converter worker in a Playwright browser
+
+// Runs in the page: loads inputs from /__bench/, derives formats and times
+// conversions, each in a fresh worker so heapBytes is that conversion's peak
+const setupBenchPage = () => {
+  const inputs = new Map();
+
+  const request = (worker, message, transfer = []) => new Promise((resolve, reject) => {
+    const onMessage = (e) => {
+      if (e.data.type === 'chunk' || e.data.type === 'progress' || e.data.type === 'probe') return;
+      worker.removeEventListener('message', onMessage);
+      if (e.data.success) resolve(e.data);
+      else reject(new Error(e.data.error));
+    };
+    worker.addEventListener('message', onMessage);
+    worker.postMessage(message, transfer);
+  });
+
+  const startWorker = async () => {
+    const worker = new Worker('/src/workers/converter.worker.js');
+    // any request loads and initializes the module; closing no session is a no-op
+    await request(worker, { type: 'closeSession', sessionId: 0 });
+    return worker;
+  };
+
+  const convert = (worker, key, inputFormat, outputFormat) => {
+    const fileData = inputs.get(key).slice(0); // the worker takes ownership
+    return request(worker, {
+      type: 'convert', fileData, fileName: key, inputFormat, outputFormat,
+      options: { explodeCollections: true }
+    }, [fileData]);
+  };
+
+  window.__bench = {
+    async load(key, url) {
+      inputs.set(key, await (await fetch(url)).arrayBuffer());
+      return inputs.get(key).byteLength;
+    },
+    async derive(key, fromKey, inputFormat, outputFormat) {
+      const worker = await startWorker();
+      try {
+        inputs.set(key, (await convert(worker, fromKey, inputFormat, outputFormat)).data);
+        return { ok: true };
+      } catch (error) {
+        return { ok: false, error: error.message };
+      } finally {
+        worker.terminate();
+      }
+    },
+    async run(key, inputFormat, outputFormat, repeat) {
+      const worker = await startWorker();
+      const inputBytes = inputs.get(key).byteLength;
+      let best = null;
+      try {
+        for (let i = 0; i < repeat; i++) {
+          const start = performance.now();
+          const result = await convert(worker, key, inputFormat, outputFormat);
+          const wallMs = performance.now() - start;
+          if (!best || wallMs < best.wallMs) {
+            best = { ok: true, runs: repeat, wallMs, inputBytes, outputBytes: result.data.byteLength,
+                     peakHeapBytes: result.heapBytes, timings: result.timings, memory: result.memory };
+          }
+        }
+        return best;
+      } catch (error) {
+        return { ok: false, inputBytes, error: error.message };
+      } finally {
+        worker.terminate();
+      }
+    },
+    drop(key) {
+      inputs.delete(key);
+    }
+  };
+};
+
+const benchWasm = async (datasets, inputs, outputs, repeat, url) => {
+  const { chromium } = require('@playwright/test');
+  const browser = await chromium.launch();
+  const records = [];
+
+  try {
+    const page = await browser.newPage();
+    await page.route('**/__bench/data/*', (route) => {
+      const name = decodeURIComponent(new URL(route.request().url()).pathname.split('/').pop());
+      return route.fulfill({ path: path.join(DATA_DIR, name), contentType: 'application/octet-stream' });
+    });
+    await page.goto(url);
+    await page.evaluate(setupBenchPage);
+
+    for (const dataset of datasets) {
+      const sourceKey = `${dataset.name}.geojson`;
+      await page.evaluate(([key, src]) => window.__bench.load(key, src),
+                          [sourceKey, `/__bench/data/${path.basename(dataset.file)}`]);
+
+      for (const inputFormat of inputs) {
+        const key = `${dataset.name}.${inputFormat}`;
+        if (inputFormat !== 'geojson') {
+          const derived = await page.evaluate(([k, src, fmt]) => window.__bench.derive(k, src, 'geojson', fmt),
+                                              [key, sourceKey, inputFormat]);
+          if (!derived.ok) {
+            console.log(`skip ${dataset.name} as ${inputFormat}: ${derived.error}`);
+            continue;
+          }
+        }
+        for (const outputFormat of outputs) {
+          const result = await page.evaluate(([k, i, o, r]) => window.__bench.run(k, i, o, r),
+                                             [key, inputFormat, outputFormat, repeat]);
+          const record = summarize(dataset, inputFormat, outputFormat, result);
+          printRecord(record);
+          records.push(record);
+        }
+        if (inputFormat !== 'geojson') await page.evaluate((k) => window.__bench.drop(k), key);
+      }
+      await page.evaluate((k) => window.__bench.drop(k), sourceKey);
+    }
+  } finally {
+    await browser.close();
+  }
+  return records;
+};
+
+// ---- reporting
+
+const fixed = (v, digits = 1) => (v === undefined ? '-' : v.toFixed(digits));
+
+const printRecord = (r) => {
+  const pair = `${r.dataset} ${r.inputFormat}→${r.outputFormat}`.padEnd(48);
+  if (!r.ok) {
+    console.log(`${pair} FAILED: ${r.error}`);
+    return;
+  }
+  const phases = PHASES.filter((p) => r.phases[p].ms > 0)
+    .map((p) => `${p} ${fixed(r.phases[p].ms)}ms`).join(', ');
+  console.log(`${pair} ${fixed(r.wallMs).padStart(10)} ms ${fixed(r.featuresPerSec, 0).padStart(10)} feat/s ` +
+              `${fixed(r.mbPerSec, 2).padStart(8)} MB/s ${fixed(r.peakHeapBytes / MB).padStart(8)} MB heap  [${phases}]`);
+};
+
+const main = async () => {
+  const args = parseArgs(process.argv.slice(2));
+  const target = args.target ?? 'wasm';
+  const formats = formatsArg(args.formats);
+  const inputs = args.inputs ? formatsArg(args.inputs) : formats;
+  const outputs = args.outputs ? formatsArg(args.outputs) : formats;
+  const repeat = Math.max(1, Number(args.repeat ?? 3));
+
+  const datasets = prepareDatasets({
+    features: listArg(args.features, '1e3,1e4,1e5').map(Number),
+    geometries: listArg(args.geometry, 'point,line,polygon'),
+    fields: listArg(args.fields, '8').map(Number),
+    vertices: Number(args.vertices ?? 16)
+  });
+
+  const started = new Date();
+  const records = target === 'native'
+    ? await benchNative(datasets, inputs, outputs, repeat)
+    : await benchWasm(datasets, inputs, outputs, repeat, args.url ?? 'http://localhost:5173');
+
+  fs.mkdirSync(RESULTS_DIR, { recursive: true });
+  const out = args.out ?? path.join(RESULTS_DIR, `${target}-${started.toISOString().replace(/[:.]/g, '-')}.json`);
+  fs.writeFileSync(out, JSON.stringify({ target, started: started.toISOString(), repeat, records }, null, 2));
+  console.log(`\n${records.filter((r) => r.ok).length}/${records.length} conversions, results in ${out}`);
+};
+
+main().catch((error) => {
+  console.error(error.message);
+  process.exit(1);
+});
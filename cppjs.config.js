@@ -8,4 +8,10 @@ export default {
   paths: {
     config: import.meta.url,
   },
+  // multithreaded (pthreads) runtime: the native thread pool runs makeValid,
+  // simplify and ZIP deflate. SharedArrayBuffer needs a cross-origin isolated
+  // page, see the COOP/COEP headers in vite.config.js and public/_headers.
+  target: {
+    runtime: "mt",
+  },
 };
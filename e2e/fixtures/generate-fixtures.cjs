@@ -4,6 +4,11 @@
  *
  * This script checks which fixture files are missing and provides
  * instructions for generating them using GDAL or the web application.
+ *
+ * With --synthetic it instead writes a generated GeoJSON dataset for the
+ * benchmarks (see bench/README.md):
+ *   node e2e/fixtures/generate-fixtures.cjs --synthetic --features 1e5 \
+ *     --geometry polygon --fields 64 --out bench/data/polygon-1e5.geojson
  */
 
 const fs = require('fs');
@@ -23,69 +28,227 @@ const REQUIRED_FIXTURES = [
 
 const fixturesDir = __dirname;
 
-console.log('🔍 Checking test fixtures...\n');
+// Deterministic PRNG (mulberry32) so synthetic datasets are identical across runs
+const createRandom = (seed) => {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6d2b79f5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+};
 
-let allPresent = true;
-const missingFiles = [];
+const SYNTHETIC_GEOMETRIES = ['point', 'line', 'polygon', 'mixed'];
 
-REQUIRED_FIXTURES.forEach(fixture => {
-  const filePath = path.join(fixturesDir, fixture.name);
-  const exists = fs.existsSync(filePath);
+// Features are spread over a 10° square around the sample fixtures' area
+const SYNTHETIC_CENTER = [106.8456, -6.2088];
+const SYNTHETIC_EXTENT = 10;
 
-  if (exists) {
-    const stats = fs.statSync(filePath);
-    console.log(`✅ ${fixture.name} (${(stats.size / 1024).toFixed(2)} KB)`);
-  } else {
-    console.log(`❌ ${fixture.name} - MISSING`);
-    missingFiles.push(fixture);
-    allPresent = false;
+// Flush generated text to disk in blocks of this size
+const SYNTHETIC_WRITE_SIZE = 4 * 1024 * 1024;
+
+const roundCoordinate = (v) => Math.round(v * 1e6) / 1e6;
+
+const syntheticGeometry = (kind, random, vertices) => {
+  const cx = SYNTHETIC_CENTER[0] + (random() - 0.5) * SYNTHETIC_EXTENT;
+  const cy = SYNTHETIC_CENTER[1] + (random() - 0.5) * SYNTHETIC_EXTENT;
+
+  if (kind === 'point') {
+    return { type: 'Point', coordinates: [roundCoordinate(cx), roundCoordinate(cy)] };
   }
-});
-
-if (allPresent) {
-  console.log('\n✨ All fixture files are present!');
-  console.log('You can run the tests with: pnpm run e2e:dev');
-} else {
-  console.log('\n⚠️  Some fixture files are missing. Here\'s how to generate them:\n');
-
-  console.log('Option 1: Using the GeoConverter web application');
-  console.log('------------------------------------------------');
-  console.log('1. Start dev server: pnpm run dev');
-  console.log('2. Open http://localhost:5173');
-  console.log('3. Upload sample.geojson');
-  console.log('4. Convert to each missing format and save to e2e/fixtures/\n');
-
-  console.log('Missing files to generate:');
-  missingFiles.forEach(fixture => {
-    console.log(`   - ${fixture.name} (${fixture.format})`);
-  });
 
-  console.log('\nOption 2: Using GDAL command line (if installed)');
-  console.log('------------------------------------------------');
-  console.log('cd e2e/fixtures');
-
-  missingFiles.forEach(fixture => {
-    if (fixture.type === 'binary') {
-      switch (fixture.format) {
-        case 'Shapefile':
-          console.log('ogr2ogr -f "ESRI Shapefile" temp.shp sample.geojson');
-          console.log('zip sample-shapefile.zip temp.*');
-          console.log('rm temp.*');
-          break;
-        case 'GeoPackage':
-          console.log('ogr2ogr -f "GPKG" sample.gpkg sample.geojson');
-          break;
-        case 'FlatGeobuf':
-          console.log('ogr2ogr -f "FlatGeobuf" sample.fgb sample.geojson');
-          break;
-        case 'PMTiles':
-          console.log('ogr2ogr -f "PMTiles" sample.pmtiles sample.geojson');
-          break;
+  if (kind === 'line') {
+    // random walk of `vertices` steps
+    const coordinates = [];
+    let x = cx;
+    let y = cy;
+    for (let i = 0; i < vertices; i++) {
+      coordinates.push([roundCoordinate(x), roundCoordinate(y)]);
+      x += (random() - 0.5) * 0.01;
+      y += (random() - 0.5) * 0.01;
+    }
+    return { type: 'LineString', coordinates };
+  }
+
+  // star-shaped (so always valid) closed ring of `vertices` points
+  const ring = [];
+  for (let i = 0; i < vertices; i++) {
+    const angle = (2 * Math.PI * i) / vertices;
+    const radius = 0.002 + random() * 0.003;
+    ring.push([roundCoordinate(cx + radius * Math.cos(angle)), roundCoordinate(cy + radius * Math.sin(angle))]);
+  }
+  ring.push(ring[0]);
+  return { type: 'Polygon', coordinates: [ring] };
+};
+
+// Attribute columns cycle through integer, real and string values
+const syntheticProperties = (index, fields, random) => {
+  const properties = { id: index };
+  for (let i = 0; i < fields; i++) {
+    const name = `field_${i}`;
+    switch (i % 3) {
+      case 0: properties[name] = Math.floor(random() * 1e6); break;
+      case 1: properties[name] = Math.round(random() * 1e6) / 1e3; break;
+      default: properties[name] = `value ${Math.floor(random() * 1e4)}`; break;
+    }
+  }
+  return properties;
+};
+
+/**
+ * Write a synthetic GeoJSON FeatureCollection to filePath.
+ *
+ * features: feature count; geometry: point | line | polygon | mixed (cycles the
+ * three); fields: attribute columns besides `id`; vertices: points per line or
+ * polygon ring. Returns the number of bytes written.
+ */
+function writeSyntheticGeoJson(filePath, {
+  features = 1000,
+  geometry = 'point',
+  fields = 8,
+  vertices = 16,
+  seed = 1
+} = {}) {
+  if (!SYNTHETIC_GEOMETRIES.includes(geometry)) {
+    throw new Error(`Unknown geometry "${geometry}" (expected ${SYNTHETIC_GEOMETRIES.join(', ')})`);
+  }
+
+  const random = createRandom(seed);
+  const kinds = geometry === 'mixed' ? ['point', 'line', 'polygon'] : [geometry];
+
+  fs.mkdirSync(path.dirname(filePath), { recursive: true });
+  const fd = fs.openSync(filePath, 'w');
+  let bytes = 0;
+  let pending = '{"type":"FeatureCollection","features":[\n';
+
+  try {
+    for (let i = 0; i < features; i++) {
+      const feature = {
+        type: 'Feature',
+        properties: syntheticProperties(i, fields, random),
+        geometry: syntheticGeometry(kinds[i % kinds.length], random, vertices)
+      };
+      pending += (i > 0 ? ',\n' : '') + JSON.stringify(feature);
+
+      if (pending.length >= SYNTHETIC_WRITE_SIZE) {
+        bytes += fs.writeSync(fd, pending);
+        pending = '';
       }
     }
+    pending += '\n]}\n';
+    bytes += fs.writeSync(fd, pending);
+  } finally {
+    fs.closeSync(fd);
+  }
+
+  return bytes;
+}
+
+// --name value pairs (numbers accept 1e5-style notation)
+const parseArgs = (argv) => {
+  const args = {};
+  for (let i = 0; i < argv.length; i++) {
+    if (!argv[i].startsWith('--')) continue;
+    const key = argv[i].slice(2);
+    const next = argv[i + 1];
+    if (next === undefined || next.startsWith('--')) {
+      args[key] = true;
+    } else {
+      args[key] = next;
+      i++;
+    }
+  }
+  return args;
+};
+
+function checkFixtures() {
+  console.log('🔍 Checking test fixtures...\n');
+
+  let allPresent = true;
+  const missingFiles = [];
+
+  REQUIRED_FIXTURES.forEach(fixture => {
+    const filePath = path.join(fixturesDir, fixture.name);
+    const exists = fs.existsSync(filePath);
+
+    if (exists) {
+      const stats = fs.statSync(filePath);
+      console.log(`✅ ${fixture.name} (${(stats.size / 1024).toFixed(2)} KB)`);
+    } else {
+      console.log(`❌ ${fixture.name} - MISSING`);
+      missingFiles.push(fixture);
+      allPresent = false;
+    }
   });
 
-  console.log('\nAfter generating all files, run this script again to verify.');
+  if (allPresent) {
+    console.log('\n✨ All fixture files are present!');
+    console.log('You can run the tests with: pnpm run e2e:dev');
+  } else {
+    console.log('\n⚠️  Some fixture files are missing. Here\'s how to generate them:\n');
+
+    console.log('Option 1: Using the GeoConverter web application');
+    console.log('------------------------------------------------');
+    console.log('1. Start dev server: pnpm run dev');
+    console.log('2. Open http://localhost:5173');
+    console.log('3. Upload sample.geojson');
+    console.log('4. Convert to each missing format and save to e2e/fixtures/\n');
+
+    console.log('Missing files to generate:');
+    missingFiles.forEach(fixture => {
+      console.log(`   - ${fixture.name} (${fixture.format})`);
+    });
+
+    console.log('\nOption 2: Using GDAL command line (if installed)');
+    console.log('------------------------------------------------');
+    console.log('cd e2e/fixtures');
+
+    missingFiles.forEach(fixture => {
+      if (fixture.type === 'binary') {
+        switch (fixture.format) {
+          case 'Shapefile':
+            console.log('ogr2ogr -f "ESRI Shapefile" temp.shp sample.geojson');
+            console.log('zip sample-shapefile.zip temp.*');
+            console.log('rm temp.*');
+            break;
+          case 'GeoPackage':
+            console.log('ogr2ogr -f "GPKG" sample.gpkg sample.geojson');
+            break;
+          case 'FlatGeobuf':
+            console.log('ogr2ogr -f "FlatGeobuf" sample.fgb sample.geojson');
+            break;
+          case 'PMTiles':
+            console.log('ogr2ogr -f "PMTiles" sample.pmtiles sample.geojson');
+            break;
+        }
+      }
+    });
+
+    console.log('\nAfter generating all files, run this script again to verify.');
+  }
+
+  return allPresent;
 }
 
-process.exit(allPresent ? 0 : 1);
+module.exports = { writeSyntheticGeoJson, SYNTHETIC_GEOMETRIES };
+
+if (require.main === module) {
+  const args = parseArgs(process.argv.slice(2));
+
+  if (args.synthetic) {
+    const options = {
+      features: Number(args.features ?? 1000),
+      geometry: args.geometry ?? 'point',
+      fields: Number(args.fields ?? 8),
+      vertices: Number(args.vertices ?? 16),
+      seed: Number(args.seed ?? 1)
+    };
+    const out = args.out ?? path.join(fixturesDir, `synthetic-${options.geometry}-${options.features}.geojson`);
+    const bytes = writeSyntheticGeoJson(out, options);
+    console.log(`✅ ${out} (${options.features} features, ${(bytes / 1024 / 1024).toFixed(2)} MB)`);
+  } else {
+    process.exit(checkFixtures() ? 0 : 1);
+  }
+}
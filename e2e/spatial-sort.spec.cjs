@@ -0,0 +1,86 @@
+// @ts-check
+const { test, expect } = require('@playwright/test');
+const { openWorkerPage, point, collection } = require('./worker-page.cjs');
+
+/**
+ * spatialSort stages GeoPackage layers through a FlatGeobuf to Hilbert-sort
+ * them. The sorted output must keep the schema of the unsorted one: layers
+ * with types the staging file does not keep are written in source order.
+ */
+
+const FEATURES = 50;
+const points = (makeProperties) => collection(Array.from({ length: FEATURES }, (_, i) => point(i, makeProperties(i))));
+
+const inputs = {
+  'plain fields (sorted)': points((i) => ({ name: `f${i}`, rank: i, share: i / 50, open: i % 2 === 0 })),
+  'dates and datetimes': points((i) => ({
+    name: `f${i}`,
+    day: `2024-05-${String(1 + (i % 28)).padStart(2, '0')}`,
+    seen: `2024-05-01T10:${String(i % 60).padStart(2, '0')}:00Z`
+  }))
+};
+
+// converts source to a GeoPackage and reads back its info and features in FID order
+const convertAndRead = (page, source, spatialSort) => page.evaluate(async ([text, sort, limit]) => {
+  const { request, describe, features } = window.__worker;
+  const converted = await request({
+    type: 'convert',
+    fileData: new TextEncoder().encode(text).buffer,
+    fileName: 'sorted.geojson',
+    inputFormat: 'geojson',
+    outputFormat: 'geopackage',
+    options: { sourceCrs: '', spatialSort: sort, cache: false }
+  });
+  if (!converted.success) return { error: converted.error };
+
+  const info = await describe(converted.data, 'geopackage');
+  const opened = await request({
+    type: 'openBlobSession', fileBlob: new Blob([converted.data]), inputFormat: 'geopackage',
+    fileName: 'sorted.gpkg', options: { sourceCrs: '' }
+  });
+  if (!opened.success) return { error: opened.error };
+  const rows = await features(opened.sessionId, 0, limit);
+  await request({ type: 'closeSession', sessionId: opened.sessionId });
+  if (rows.error) return { error: rows.error };
+  return { info, fids: rows.fids, points: rows.points, names: rows.columns.find((c) => c.name === 'name').values };
+}, [source, spatialSort, FEATURES]);
+
+// distance travelled from point to point in FID order
+const pathLength = (coordinates) => coordinates.slice(1)
+  .reduce((sum, [x, y], i) => sum + Math.hypot(x - coordinates[i][0], y - coordinates[i][1]), 0);
+
+test.describe('Spatially sorted GeoPackage output', () => {
+  test.beforeEach(async ({ page }) => {
+    await openWorkerPage(page);
+  });
+
+  for (const [title, text] of Object.entries(inputs)) {
+    test(`keeps the schema: ${title}`, async ({ page }) => {
+      const unsorted = await convertAndRead(page, text, false);
+      const sorted = await convertAndRead(page, text, true);
+
+      expect(unsorted.error).toBeUndefined();
+      expect(sorted.error).toBeUndefined();
+      expect(sorted.info.fields).toEqual(unsorted.info.fields);
+      expect(sorted.info.featureCount).toBe(unsorted.info.featureCount);
+    });
+  }
+
+  test('numbers the features along the Hilbert curve', async ({ page }) => {
+    const text = inputs['plain fields (sorted)'];
+    const unsorted = await convertAndRead(page, text, false);
+    const sorted = await convertAndRead(page, text, true);
+    expect(unsorted.error).toBeUndefined();
+    expect(sorted.error).toBeUndefined();
+
+    // every feature once, FIDs 1..n in the new order
+    const ascending = Array.from({ length: FEATURES }, (_, i) => i + 1);
+    expect(sorted.fids).toEqual(ascending);
+    expect([...sorted.names].sort()).toEqual([...unsorted.names].sort());
+    expect(sorted.names).not.toEqual(unsorted.names);
+
+    // neighbours in FID order are neighbours on the map
+    expect(sorted.points.every(Boolean)).toBe(true);
+    expect(pathLength(sorted.points)).toBeLessThan(pathLength(unsorted.points) / 2);
+  });
+});
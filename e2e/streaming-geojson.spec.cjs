@@ -0,0 +1,76 @@
+// @ts-check
+const { test, expect } = require('@playwright/test');
+const { openWorkerPage } = require('./worker-page.cjs');
+
+/**
+ * Large GeoJSON inputs are read by the native streaming layer instead of the
+ * GDAL driver. With the size threshold lowered to one byte, small documents
+ * take the streaming path, and their schema must match the driver's.
+ */
+
+const STREAM_EVERYTHING = { GEOCONVERTER_STREAMING_GEOJSON_MIN_SIZE: '1' };
+
+const collection = (features, extra = {}) => JSON.stringify({ type: 'FeatureCollection', ...extra, features });
+const point = (id, properties, x = 1, y = 2) => ({
+  type: 'Feature',
+  ...(id === undefined ? {} : { id }),
+  properties,
+  geometry: { type: 'Point', coordinates: [x, y] }
+});
+
+const documents = {
+  'dates, lists and a collection name': collection([
+    point('a-1', {
+      name: 'first', day: '2024-05-01', seen: '2024-05-01T10:20:30Z', at: '10:20:30',
+      ints: [1, 2], reals: [1.5, 2], tags: ['a', 'b'], flags: [true, false], mixed: [1, 'a'],
+      count: 3, nested: { k: 1 }
+    }),
+    point('a-2', { name: 'second', day: '2024-05-02T08:00:00', count: 4.5, big: [5000000000], empty: [] }, 3, 4)
+  ], { name: 'parcels' }),
+  'string ids next to a properties id': collection([
+    point('f-1', { id: 'p-1', label: 'x' }),
+    point('f-2', { label: 'y' }, 3, 4)
+  ]),
+  'string ids after the first properties': collection([
+    point(undefined, { label: 'x', when: '2023-01-01' }),
+    point('f-2', { label: 'y', extra: 1 }, 3, 4)
+  ]),
+  'integer ids and a properties id': collection([
+    point(7, { id: 'p-7', value: 1 }),
+    point(8, { id: 'p-8', value: 2 }, 3, 4)
+  ])
+};
+
+test.describe('Streaming GeoJSON schema', () => {
+  test.beforeEach(async ({ page }) => {
+    await openWorkerPage(page);
+  });
+
+  for (const [title, text] of Object.entries(documents)) {
+    test(`matches the GeoJSON driver: ${title}`, async ({ page }) => {
+      const describe = (gdalConfig) => page.evaluate(async ([source, config]) => {
+        const { request } = window.__worker;
+        const fileBlob = new Blob([source], { type: 'application/geo+json' });
+        const opened = await request({
+          type: 'openBlobSession', fileBlob, inputFormat: 'geojson', fileName: 'sample.geojson',
+          options: { sourceCrs: '', gdalConfig: config }
+        });
+        if (!opened.success) return { error: opened.error };
+        const reply = await request({ type: 'getSessionInfo', sessionId: opened.sessionId, options: { sourceCrs: '', exact: true } });
+        await request({ type: 'closeSession', sessionId: opened.sessionId });
+        return reply.success ? JSON.parse(reply.info) : { error: reply.error };
+      }, [text, gdalConfig]);
+
+      const driver = await describe({});
+      const streamed = await describe(STREAM_EVERYTHING);
+
+      expect(driver.error).toBeUndefined();
+      expect(streamed.error).toBeUndefined();
+      expect(streamed.layerName).toBe(driver.layerName);
+      expect(streamed.fields).toEqual(driver.fields);
+      expect(streamed.featureCount).toBe(driver.featureCount);
+      expect(streamed.geometryType).toBe(driver.geometryType);
+      expect(streamed.properties).toEqual(driver.properties);
+    });
+  }
+});
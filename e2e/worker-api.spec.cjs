@@ -0,0 +1,239 @@
+// @ts-check
+const { test, expect } = require('@playwright/test');
+const { openWorkerPage, point, collection } = require('./worker-page.cjs');
+
+/**
+ * Worker requests without the UI: the native feature pump against
+ * GDALVectorTranslate, batches, updates of earlier outputs and feature pages.
+ */
+
+const FIXTURES = [
+  ['sample.geojson', 'geojson'],
+  ['sample.gpkg', 'geopackage'],
+  ['sample.fgb', 'flatgeobuf'],
+  ['sample.csv', 'csv']
+];
+const OUTPUTS = ['geojson', 'geopackage', 'flatgeobuf', 'csv'];
+
+test.describe('Worker API', () => {
+  test.beforeEach(async ({ page }) => {
+    await openWorkerPage(page);
+  });
+
+  test.describe('native engine matches translate', () => {
+    for (const [fixture, inputFormat] of FIXTURES) {
+      for (const outputFormat of OUTPUTS) {
+        test(`${fixture} to ${outputFormat}`, async ({ page }) => {
+          const describeOutput = (engine) => page.evaluate(async ([name, input, output, mode]) => {
+            const { request, fixture: load, describe } = window.__worker;
+            const converted = await request({
+              type: 'convert',
+              fileData: await load(name),
+              fileName: name,
+              inputFormat: input,
+              outputFormat: output,
+              options: { sourceCrs: '', engine: mode, cache: false }
+            });
+            if (!converted.success) return { error: converted.error };
+            return describe(converted.data, output);
+          }, [fixture, inputFormat, outputFormat, engine]);
+
+          const translated = await describeOutput('translate');
+          const native = await describeOutput('native');
+
+          expect(translated.error).toBeUndefined();
+          expect(native.error).toBeUndefined();
+          expect(native.featureCount).toBe(translated.featureCount);
+          expect(native.fields).toEqual(translated.fields);
+        });
+      }
+    }
+  });
+
+  test.describe('native tiler matches the MVT writer', () => {
+    for (const outputFormat of ['pmtiles', 'mbtiles']) {
+      test(`sample.geojson to ${outputFormat}`, async ({ page }) => {
+        const describeTiles = (engine) => page.evaluate(async ([output, mode]) => {
+          const { request, fixture, describe } = window.__worker;
+          const converted = await request({
+            type: 'convert',
+            fileData: await fixture('sample.geojson'),
+            fileName: 'sample.geojson',
+            inputFormat: 'geojson',
+            outputFormat: output,
+            options: { sourceCrs: '', engine: mode, cache: false, tileMinZoom: 2, tileMaxZoom: 8 }
+          });
+          if (!converted.success) return { error: converted.error };
+          return describe(converted.data, output);
+        }, [outputFormat, engine]);
+
+        const driver = await describeTiles('driver');
+        const native = await describeTiles('native');
+
+        expect(driver.error).toBeUndefined();
+        expect(native.error).toBeUndefined();
+        expect(native.layerName).toBe(driver.layerName);
+        expect(native.featureCount).toBeGreaterThan(0);
+        // names only: GDAL's writer also stores tile statistics, from which the reader tells Integer from Real
+        const names = (info) => info.fields.map((f) => f.name).sort();
+        expect(names(native)).toEqual(names(driver));
+      });
+    }
+  });
+
+  test.describe('convertBatch', () => {
+    // a.geojson and b.geojson are the sample fixture, broken.geojson fails to open
+    const runBatch = (page, merge, outputFormat) => page.evaluate(async ([mode, output]) => {
+      const { request, fixture, describe } = window.__worker;
+      const source = await fixture('sample.geojson');
+      const files = [
+        { fileData: source.slice(0), fileName: 'a.geojson', inputFormat: 'geojson' },
+        { fileData: new TextEncoder().encode('not geojson').buffer, fileName: 'broken.geojson', inputFormat: 'geojson' },
+        { fileData: source.slice(0), fileName: 'b.geojson', inputFormat: 'geojson' }
+      ];
+      const reply = await request({
+        type: 'convertBatch', files, merge: mode, inputFormat: 'geojson', outputFormat: output,
+        fileName: 'batch', options: { sourceCrs: '', cache: false }
+      });
+      const items = reply.messages
+        .filter((m) => m.type === 'batchItem')
+        .map((m) => ({ index: m.index, fileName: m.fileName, success: m.success, hasData: Boolean(m.data) }));
+      return {
+        success: reply.success,
+        error: reply.error,
+        converted: reply.converted,
+        failed: reply.failed,
+        items,
+        signature: reply.data ? Array.from(new Uint8Array(reply.data, 0, 2)) : null,
+        info: reply.data && mode === 'layer' ? await describe(reply.data, output) : null
+      };
+    }, [merge, outputFormat]);
+
+    test('keeps one output per input and reports failed inputs', async ({ page }) => {
+      const result = await runBatch(page, '', 'geojson');
+      expect(result.success).toBe(true);
+      expect(result.converted).toBe(2);
+      expect(result.failed).toBe(1);
+      expect(result.items).toEqual([
+        { index: 0, fileName: 'a.geojson', success: true, hasData: true },
+        { index: 1, fileName: 'broken.geojson', success: false, hasData: false },
+        { index: 2, fileName: 'b.geojson', success: true, hasData: true }
+      ]);
+    });
+
+    test('collects the outputs in one ZIP', async ({ page }) => {
+      const result = await runBatch(page, 'zip', 'geojson');
+      expect(result.success).toBe(true);
+      expect(result.items.map((item) => item.success)).toEqual([true, false, true]);
+      expect(result.signature).toEqual([0x50, 0x4b]);
+    });
+
+    test('merges the inputs into one layer', async ({ page }) => {
+      const result = await runBatch(page, 'layer', 'geopackage');
+      expect(result.success).toBe(true);
+      expect(result.info.error).toBeUndefined();
+      expect(result.info.featureCount).toBe(6);
+    });
+  });
+
+  test.describe('updateOutput', () => {
+    const base = collection([
+      point(0, { name: 'a', value: 1 }),
+      point(1, { name: 'b', value: 2 }),
+      point(2, { name: 'c', value: 3 })
+    ]);
+    const changes = collection([
+      point(3, { name: 'b', value: 20 }),
+      point(4, { name: 'd', value: 4 })
+    ]);
+
+    // converts base to format, updates it with changes and reads the result back
+    const runUpdate = (page, targetFormat, mode, key) => page.evaluate(async ([baseText, changesText, format, updateMode, keyField]) => {
+      const { request, describe, features } = window.__worker;
+      const encode = (text) => new TextEncoder().encode(text).buffer;
+      const target = await request({
+        type: 'convert', fileData: encode(baseText), fileName: 'base.geojson',
+        inputFormat: 'geojson', outputFormat: format, options: { sourceCrs: '', cache: false }
+      });
+      if (!target.success) return { error: target.error };
+
+      const updated = await request({
+        type: 'updateOutput', fileData: encode(changesText), fileName: 'changes.geojson', inputFormat: 'geojson',
+        update: { targetData: target.data, targetFormat: format, mode: updateMode, key: keyField },
+        options: { sourceCrs: '', cache: false }
+      });
+      if (!updated.success) return { error: updated.error };
+
+      const info = await describe(updated.data, format);
+      const opened = await request({
+        type: 'openBlobSession', fileBlob: new Blob([updated.data]), inputFormat: format,
+        fileName: `updated.${format}`, options: { sourceCrs: '' }
+      });
+      if (!opened.success) return { error: opened.error };
+      const rows = await features(opened.sessionId, 0, 100);
+      await request({ type: 'closeSession', sessionId: opened.sessionId });
+      if (rows.error) return { error: rows.error };
+      const column = (name) => rows.columns.find((c) => c.name === name).values;
+      const names = column('name');
+      const values = column('value');
+      return {
+        featureCount: info.featureCount,
+        rows: names.map((name, i) => [name, values[i]]).sort((a, b) => String(a[0]).localeCompare(String(b[0])) || a[1] - b[1])
+      };
+    }, [base, changes, targetFormat, mode, key]);
+
+    for (const format of ['geopackage', 'flatgeobuf']) {
+      test(`appends to a ${format}`, async ({ page }) => {
+        const result = await runUpdate(page, format, 'append', '');
+        expect(result.error).toBeUndefined();
+        expect(result.featureCount).toBe(5);
+        expect(result.rows).toEqual([['a', 1], ['b', 2], ['b', 20], ['c', 3], ['d', 4]]);
+      });
+
+      test(`upserts into a ${format} by key`, async ({ page }) => {
+        const result = await runUpdate(page, format, 'upsert', 'name');
+        expect(result.error).toBeUndefined();
+        expect(result.featureCount).toBe(4);
+        expect(result.rows).toEqual([['a', 1], ['b', 20], ['c', 3], ['d', 4]]);
+      });
+    }
+  });
+
+  test('getFeatures pages through a layer', async ({ page }) => {
+    const text = collection(Array.from({ length: 250 }, (_, i) => point(i, { rank: i, name: `f${i}` })));
+    const result = await page.evaluate(async (source) => {
+      const { request, features } = window.__worker;
+      const opened = await request({
+        type: 'openBlobSession', fileBlob: new Blob([source]), inputFormat: 'geojson',
+        fileName: 'pages.geojson', options: { sourceCrs: '' }
+      });
+      if (!opened.success) return { error: opened.error };
+
+      const pages = [];
+      for (let offset = 0; offset >= 0 && pages.length < 10;) {
+        const featurePage = await features(opened.sessionId, offset, 100);
+        if (featurePage.error) return { error: featurePage.error };
+        pages.push(featurePage);
+        offset = featurePage.nextOffset;
+      }
+      const seek = await features(opened.sessionId, 150, 10);
+      const beyond = await features(opened.sessionId, 1000, 100);
+      await request({ type: 'closeSession', sessionId: opened.sessionId });
+      return { pages, seek, beyond };
+    }, text);
+
+    expect(result.error).toBeUndefined();
+    const { pages, seek, beyond } = result;
+    expect(pages.map((p) => p.rowCount)).toEqual([100, 100, 50]);
+    expect(pages.map((p) => p.nextOffset)).toEqual([100, 200, -1]);
+
+    const ranks = pages.flatMap((p) => p.columns.find((c) => c.name === 'rank').values);
+    expect(ranks).toEqual(Array.from({ length: 250 }, (_, i) => i));
+    expect(new Set(pages.flatMap((p) => p.fids)).size).toBe(250);
+    expect(pages.every((p) => p.geometryTypes.every((type) => type === 'Point'))).toBe(true);
+    expect(seek.columns.find((c) => c.name === 'rank').values).toEqual(Array.from({ length: 10 }, (_, i) => 150 + i));
+    expect(seek.nextOffset).toBe(160);
+    expect(beyond.rowCount).toBe(0);
+    expect(beyond.nextOffset).toBe(-1);
+  });
+});
@@ -0,0 +1,92 @@
+// @ts-check
+
+/**
+ * Helpers for specs that drive the converter worker directly instead of the UI,
+ * the way bench/run.cjs does: one worker in the app page, requests posted as
+ * the pool posts them.
+ */
+
+// Runs in the page: window.__worker.request(message) resolves with the final
+// reply (success or not); typed messages (progress, chunk, probe, batchItem)
+// are collected in reply.messages
+const setupWorkerPage = async () => {
+  const worker = new Worker('/src/workers/converter.worker.js');
+  const { decodeFeaturePage, wkbGeometryType } = await import('/src/workers/featurePage.js');
+
+  const request = (message, transfer = []) => new Promise((resolve, reject) => {
+    const messages = [];
+    const onMessage = (e) => {
+      if (e.data.type) {
+        messages.push(e.data);
+        return;
+      }
+      worker.removeEventListener('message', onMessage);
+      worker.removeEventListener('error', onError);
+      resolve({ ...e.data, messages });
+    };
+    const onError = (e) => {
+      worker.removeEventListener('message', onMessage);
+      worker.removeEventListener('error', onError);
+      reject(new Error(e.message || 'Converter worker crashed'));
+    };
+    worker.addEventListener('message', onMessage);
+    worker.addEventListener('error', onError);
+    worker.postMessage(message, transfer);
+  });
+
+  const fixture = async (name) => {
+    const response = await fetch(`/e2e/fixtures/${name}`);
+    if (!response.ok) throw new Error(`Missing fixture ${name}`);
+    return response.arrayBuffer();
+  };
+
+  // Dataset info (the getSessionInfo JSON) of a converted output
+  const describe = async (data, inputFormat) => {
+    const opened = await request({
+      type: 'openBlobSession', fileBlob: new Blob([data]), inputFormat,
+      fileName: `output.${inputFormat}`, options: { sourceCrs: '' }
+    });
+    if (!opened.success) return { error: opened.error };
+    const reply = await request({ type: 'getSessionInfo', sessionId: opened.sessionId, options: { sourceCrs: '' } });
+    await request({ type: 'closeSession', sessionId: opened.sessionId });
+    return reply.success ? JSON.parse(reply.info) : { error: reply.error };
+  };
+
+  // One getFeatures page of a session, decoded into plain values
+  const features = async (sessionId, offset, limit) => {
+    const reply = await request({ type: 'getFeatures', sessionId, offset, limit, options: { sourceCrs: '' } });
+    if (!reply.success) return { error: reply.error };
+    const page = decodeFeaturePage(reply.page);
+    return {
+      rowCount: page.rowCount,
+      nextOffset: page.nextOffset,
+      fids: page.fids,
+      geometryTypes: page.geometries.map(wkbGeometryType),
+      // [x, y] of the 2D point geometries, null for the others
+      points: page.geometries.map((wkb) => {
+        if (wkbGeometryType(wkb) !== 'Point') return null;
+        const view = new DataView(wkb.buffer, wkb.byteOffset, wkb.byteLength);
+        return [view.getFloat64(5, wkb[0] === 1), view.getFloat64(13, wkb[0] === 1)];
+      }),
+      columns: page.columns
+    };
+  };
+
+  window.__worker = { request, fixture, describe, features };
+};
+
+const openWorkerPage = async (page) => {
+  await page.goto('/');
+  await page.evaluate(setupWorkerPage);
+};
+
+// GeoJSON inputs for the specs: point i is spread over the map, so consecutive
+// points are far apart
+const point = (i, properties) => ({
+  type: 'Feature',
+  properties,
+  geometry: { type: 'Point', coordinates: [(i * 37) % 180, (i * 11) % 80] }
+});
+const collection = (features) => JSON.stringify({ type: 'FeatureCollection', features });
+
+module.exports = { openWorkerPage, point, collection };
@@ -1,4 +1,4 @@
-import { useState, useEffect, useRef } from "react";
+import { useState, useEffect, useRef, useMemo, useCallback } from "react";
 import { Button } from "@/components/button";
 import { Select } from "@/components/select";
 import { Input } from "@/components/input";
@@ -24,10 +24,15 @@ import JSZip from "jszip";
 import proj4 from "proj4";
 import epsg from "epsg-index/all.json" with { type: "json" };
 import { initCppJs, Native } from "@/native/native.h";
+import { convertLayersInParallel } from "./workers/layerPool";
+import { createWorkerPool } from "./workers/workerPool";
+import { decodeFeaturePage } from "./workers/featurePage";
+import { decodeVectorInfo } from "./workers/vectorInfo";
 import { Text } from "@/components/text";
 import {
   SupportedFormats,
   SUPPORTED_FORMATS,
+  availableFormats,
 } from "@/components/SupportedFormats";
 import { ChangelogCard } from "@/components/ChangelogCard";
 import { FeedbackForm } from "@/components/FeedbackForm";
@@ -87,27 +92,28 @@ const FORMAT_LOOKUP = SUPPORTED_FORMATS.reduce((acc, format) => {
   return acc;
 }, {});
 
-const READABLE_FORMATS = SUPPORTED_FORMATS.filter(
-  (format) => format.capabilities.read,
-);
-const WRITABLE_FORMATS = SUPPORTED_FORMATS.filter(
-  (format) => format.capabilities.write,
-);
+const readableFormats = (formats) =>
+  formats.filter((format) => format.capabilities.read);
+const writableFormats = (formats) =>
+  formats.filter((format) => format.capabilities.write);
+
+// Formats every GDAL build has; optional ones join once the drivers are checked
+const BASE_FORMATS = availableFormats();
 
 const DEFAULT_INPUT_FORMAT =
-  READABLE_FORMATS.find((format) => format.value === "geojson")?.value ??
-  READABLE_FORMATS[0]?.value ??
+  readableFormats(BASE_FORMATS).find((format) => format.value === "geojson")?.value ??
+  readableFormats(BASE_FORMATS)[0]?.value ??
   "";
 
 const DEFAULT_OUTPUT_FORMAT =
-  WRITABLE_FORMATS.find((format) => format.value === "shapefile")?.value ??
-  WRITABLE_FORMATS.find((format) => format.value === "geojson")?.value ??
-  WRITABLE_FORMATS[0]?.value ??
+  writableFormats(BASE_FORMATS).find((format) => format.value === "shapefile")?.value ??
+  writableFormats(BASE_FORMATS).find((format) => format.value === "geojson")?.value ??
+  writableFormats(BASE_FORMATS)[0]?.value ??
   "";
 
-const INPUT_ACCEPT_ATTRIBUTE = Array.from(
+const inputAcceptAttribute = (formats) => Array.from(
   new Set(
-    READABLE_FORMATS.flatMap((format) =>
+    formats.flatMap((format) =>
       Array.isArray(format.extensions) ? format.extensions : [],
     ),
   ),
@@ -120,10 +126,25 @@ const INPUT_ACCEPT_ATTRIBUTE = Array.from(
   .filter(Boolean)
   .join(",");
 
+// Preview session requests go to the pool worker holding the session (typed
+// messages such as probes go to onMessage)
+const previewRequest = (pin, message, onMessage) => pin.run(message, { onMessage }).then((data) => {
+  if (!data.success) throw new Error(data.error);
+  return data;
+});
+
 function App() {
   const [gdalVersion, setGdalVersion] = useState("Initializing...");
   const [isInitializing, setIsInitializing] = useState(true);
+  const [formats, setFormats] = useState(BASE_FORMATS);
+  const inputFormats = useMemo(() => readableFormats(formats), [formats]);
+  const outputFormats = useMemo(() => writableFormats(formats), [formats]);
+  const inputAccept = useMemo(
+    () => inputAcceptAttribute(inputFormats),
+    [inputFormats],
+  );
   const [isConverting, setIsConverting] = useState(false);
+  const [conversionProgress, setConversionProgress] = useState(null); // 0..1, null when unknown
   const [selectedFiles, setSelectedFiles] = useState([]);
   const [inputFormat, setInputFormat] = useState(DEFAULT_INPUT_FORMAT);
   const [outputFormat, setOutputFormat] = useState(DEFAULT_OUTPUT_FORMAT);
@@ -150,6 +171,9 @@ function App() {
   const [geojsonPrecision, setGeojsonPrecision] = useState(7);
   const [csvGeometryMode, setCsvGeometryMode] = useState("WKT"); // WKT or XY
 
+  // Multiple files: "" (one output each), "zip" (one ZIP) or "layer" (one merged layer)
+  const [batchMerge, setBatchMerge] = useState("");
+
   // Toast state
   const [toast, setToast] = useState({
     isOpen: false,
@@ -170,14 +194,19 @@ function App() {
   // Preview cache - cache preview data by file name, size, and lastModified
   const previewCache = useRef({});
 
+  // Blob session kept open while the preview shows, for its paged feature table
+  const [previewSession, setPreviewSession] = useState(null);
+  const previewSessionRef = useRef(null);
+  const previewEpochRef = useRef(0); // bumped on close, so late opens are dropped
+
   // Help dialog state
   const [showHelp, setShowHelp] = useState(false);
 
   // Drag and drop state
   const [isDragging, setIsDragging] = useState(false);
 
-  // Initialize Web Worker for off-thread processing
-  const converterWorkerRef = useRef(null);
+  // Pool of warm Web Workers for off-thread processing
+  const workerPoolRef = useRef(null);
 
   // No need for complex control flow - we'll always try to reproject bbox if possible
 
@@ -185,18 +214,18 @@ function App() {
     // Initialize WASM module for main thread (for getGdalInfo)
     initCppJs().then(() => {
       setGdalVersion(Native.getGdalInfo());
+      // the workers register the same drivers as this instance
+      setFormats(availableFormats((driver) => Native.hasDriver(driver)));
       setIsInitializing(false);
     });
 
-    // Initialize Web Worker
-    converterWorkerRef.current = new Worker(
-      new URL('./workers/converter.worker.js', import.meta.url)
-    );
+    // Start the worker pool (its workers set up GDAL before the first request)
+    workerPoolRef.current = createWorkerPool();
 
-    // Cleanup worker on unmount
+    // Cleanup workers on unmount
     return () => {
-      if (converterWorkerRef.current) {
-        converterWorkerRef.current.terminate();
+      if (workerPoolRef.current) {
+        workerPoolRef.current.terminate();
       }
     };
   }, []);
@@ -208,7 +237,7 @@ function App() {
     let matchedFormat = null;
     let longestMatch = 0;
 
-    for (const format of SUPPORTED_FORMATS) {
+    for (const format of formats) {
       if (!Array.isArray(format.extensions)) continue;
       for (const rawExtension of format.extensions) {
         if (!rawExtension) continue;
@@ -418,6 +447,7 @@ function App() {
 
     setSelectedFiles(supportedFiles);
     setPreviewData(null); // Reset preview data
+    closePreviewSession();
 
     // Clear preview cache when new files are selected to prevent memory buildup
     previewCache.current = {};
@@ -430,10 +460,10 @@ function App() {
     setInputFormat(nextInputFormat);
     setFormatAutoDetected(Boolean(detectedFormat));
 
-    const geojsonAvailable = WRITABLE_FORMATS.some(
+    const geojsonAvailable = outputFormats.some(
       (format) => format.value === "geojson",
     );
-    const shapefileAvailable = WRITABLE_FORMATS.some(
+    const shapefileAvailable = outputFormats.some(
       (format) => format.value === "shapefile",
     );
 
@@ -442,7 +472,7 @@ function App() {
     } else if (detectedFormat === "geojson" && shapefileAvailable) {
       setOutputFormat("shapefile");
     } else if (
-      !WRITABLE_FORMATS.some((format) => format.value === outputFormat)
+      !outputFormats.some((format) => format.value === outputFormat)
     ) {
       setOutputFormat(DEFAULT_OUTPUT_FORMAT);
     } else if (
@@ -610,9 +640,101 @@ function App() {
     return [Math.min(...xs), Math.min(...ys), Math.max(...xs), Math.max(...ys)];
   };
 
+  // Parse the worker's info (a binary record or JSON) and reproject its bbox for the map
+  const buildPreviewMetadata = async (jsonString, finalSourceCrs) => {
+    // Binary records decode as they are; JSON is parsed with fallback
+    // sanitization for control characters
+    let metadata = jsonString instanceof ArrayBuffer ? decodeVectorInfo(jsonString) : null;
+    try {
+      // First attempt: try parsing as-is
+      if (!metadata) metadata = JSON.parse(jsonString);
+    } catch (parseError) {
+      // If parsing fails, try to sanitize the JSON string
+      console.warn(
+        "Initial JSON parse failed, attempting to sanitize:",
+        parseError.message,
+      );
+
+      // Sanitize by removing or escaping control characters in string values
+      // This regex finds string values and replaces control characters within them
+      jsonString = jsonString.replace(
+        /"([^"\\]*(\\.[^"\\]*)*)"/g,
+        (match) => {
+          // For each string, replace control characters
+          return match.replace(/[\x00-\x1F\x7F]/g, (char) => {
+            // Keep allowed control chars that are already escaped
+            const code = char.charCodeAt(0);
+            switch (code) {
+              case 0x08:
+                return "\\b";
+              case 0x09:
+                return "\\t";
+              case 0x0a:
+                return "\\n";
+              case 0x0c:
+                return "\\f";
+              case 0x0d:
+                return "\\r";
+              default:
+                return ""; // Remove other control characters
+            }
+          });
+        },
+      );
+
+      // Try parsing again after sanitization
+      metadata = JSON.parse(jsonString);
+    }
+
+    if (metadata.error) {
+      throw new Error(metadata.error);
+    }
+
+    // Use user-specified source CRS if provided, otherwise use auto-detected CRS
+    const crsForReprojection = finalSourceCrs || metadata.crs;
+
+    // Check if CRS is already in geographic coordinates (lat/lon)
+    const isAlreadyGeographic =
+      !crsForReprojection ||
+      crsForReprojection === "Unknown" ||
+      crsForReprojection === "EPSG:4326" ||
+      crsForReprojection.includes("+proj=longlat") ||
+      crsForReprojection.includes("+proj=latlong");
+
+    // Always try to reproject bbox to WGS84 for map display using proj4
+    // Only skip if already in geographic coordinates or missing data
+    if (metadata.bbox && metadata.bbox.length === 4 && !isAlreadyGeographic) {
+      try {
+        // Store original bbox before transformation
+        metadata.bboxOriginal = [...metadata.bbox];
+        const transformedBbox = await transformBboxWithProj4(
+          metadata.bbox,
+          crsForReprojection,
+        );
+        metadata.bbox = transformedBbox;
+        metadata.bboxReprojected = true;
+        metadata.crsUsedForReprojection = crsForReprojection;
+        console.log(
+          `✓ Bbox reprojected to WGS84 using ${finalSourceCrs ? "user-specified" : "auto-detected"} CRS:`,
+          crsForReprojection,
+        );
+      } catch (projError) {
+        console.warn(
+          "Bbox reprojection failed, using original coordinates:",
+          projError.message,
+        );
+        // Keep original bbox as fallback
+        metadata.bboxReprojected = false;
+      }
+    }
+
+    return metadata;
+  };
+
   const extractPreviewData = async (fileToPreview = null) => {
     if (!selectedFiles || selectedFiles.length === 0 || isInitializing) return;
 
+    let session = null;
     try {
       setIsLoadingPreview(true);
 
@@ -627,9 +749,12 @@ function App() {
       let fileFormat = detectFormatFromFile(selectedFile.name) || inputFormat;
 
       // Check if this is a shapefile component that needs bundling
-      let arrayBuffer;
+      // Blob/File handed to the worker, which reads only the byte ranges GDAL asks for
+      let previewSource;
       let displayName = selectedFile.name;
       let cacheKey;
+      // the selected files the preview session reads (exports of them reuse it)
+      let sourceFiles = [selectedFile];
 
       // Check if this is a multi-file format that needs bundling
       const shpBaseName = getShapefileBaseName(selectedFile.name);
@@ -648,7 +773,8 @@ function App() {
             const fileBuffer = await file.arrayBuffer();
             zip.file(file.name, fileBuffer);
           }
-          arrayBuffer = await zip.generateAsync({ type: 'arraybuffer' });
+          previewSource = await zip.generateAsync({ type: 'blob' });
+          sourceFiles = relatedFiles;
           displayName = shpBaseName + '.shp';
 
           // Create cache key based on all related files
@@ -656,7 +782,7 @@ function App() {
           cacheKey = `${allFileInfo}_${fileFormat}_${finalSourceCrs || 'auto'}`;
         } else {
           // Single file, process normally
-          arrayBuffer = await selectedFile.arrayBuffer();
+          previewSource = selectedFile;
           cacheKey = `${selectedFile.name}_${selectedFile.size}_${selectedFile.lastModified}_${fileFormat}_${finalSourceCrs || 'auto'}`;
         }
       } else if (tabBaseName && fileFormat === 'mapinfo' && !selectedFile.name.toLowerCase().endsWith('.zip')) {
@@ -671,7 +797,8 @@ function App() {
             const fileBuffer = await file.arrayBuffer();
             zip.file(file.name, fileBuffer);
           }
-          arrayBuffer = await zip.generateAsync({ type: 'arraybuffer' });
+          previewSource = await zip.generateAsync({ type: 'blob' });
+          sourceFiles = relatedFiles;
           displayName = tabBaseName + '.tab';
 
           // Create cache key based on all related files
@@ -679,7 +806,7 @@ function App() {
           cacheKey = `${allFileInfo}_${fileFormat}_${finalSourceCrs || 'auto'}`;
         } else {
           // Single file, process normally
-          arrayBuffer = await selectedFile.arrayBuffer();
+          previewSource = selectedFile;
           cacheKey = `${selectedFile.name}_${selectedFile.size}_${selectedFile.lastModified}_${fileFormat}_${finalSourceCrs || 'auto'}`;
         }
       } else if (mifBaseName && fileFormat === 'mapinfomif') {
@@ -694,7 +821,8 @@ function App() {
             const fileBuffer = await file.arrayBuffer();
             zip.file(file.name, fileBuffer);
           }
-          arrayBuffer = await zip.generateAsync({ type: 'arraybuffer' });
+          previewSource = await zip.generateAsync({ type: 'blob' });
+          sourceFiles = relatedFiles;
           displayName = mifBaseName + '.mif';
 
           // Create cache key based on all related files
@@ -702,12 +830,12 @@ function App() {
           cacheKey = `${allFileInfo}_${fileFormat}_${finalSourceCrs || 'auto'}`;
         } else {
           // Single file, process normally
-          arrayBuffer = await selectedFile.arrayBuffer();
+          previewSource = selectedFile;
           cacheKey = `${selectedFile.name}_${selectedFile.size}_${selectedFile.lastModified}_${fileFormat}_${finalSourceCrs || 'auto'}`;
         }
       } else {
         // Not a multi-file format component or already a ZIP
-        arrayBuffer = await selectedFile.arrayBuffer();
+        previewSource = selectedFile;
         cacheKey = `${selectedFile.name}_${selectedFile.size}_${selectedFile.lastModified}_${fileFormat}_${finalSourceCrs || 'auto'}`;
       }
 
@@ -717,6 +845,9 @@ function App() {
         setPreviewData(previewCache.current[cacheKey]);
         setShowPreview(true);
         setIsLoadingPreview(false);
+        // Without a session the preview just has no feature table
+        openPreviewSession(previewSource, displayName, fileFormat, sourceFiles)
+          .catch((error) => console.warn("Feature table unavailable:", error.message));
 
         // Show toast to inform user that cached data is being used
         setToast({
@@ -730,98 +861,37 @@ function App() {
 
       console.log('⟳ Loading preview data for:', displayName);
 
-      // Call worker to extract metadata (off main thread)
-      let jsonString = await getVectorInfoWithWorker(
-        arrayBuffer,
-        displayName,
-        fileFormat,
-        finalSourceCrs,
-      );
-
-      // Parse JSON with fallback sanitization for control characters
-      let metadata;
-      try {
-        // First attempt: try parsing as-is
-        metadata = JSON.parse(jsonString);
-      } catch (parseError) {
-        // If parsing fails, try to sanitize the JSON string
-        console.warn(
-          "Initial JSON parse failed, attempting to sanitize:",
-          parseError.message,
-        );
-
-        // Sanitize by removing or escaping control characters in string values
-        // This regex finds string values and replaces control characters within them
-        jsonString = jsonString.replace(
-          /"([^"\\]*(\\.[^"\\]*)*)"/g,
-          (match) => {
-            // For each string, replace control characters
-            return match.replace(/[\x00-\x1F\x7F]/g, (char) => {
-              // Keep allowed control chars that are already escaped
-              const code = char.charCodeAt(0);
-              switch (code) {
-                case 0x08:
-                  return "\\b";
-                case 0x09:
-                  return "\\t";
-                case 0x0a:
-                  return "\\n";
-                case 0x0c:
-                  return "\\f";
-                case 0x0d:
-                  return "\\r";
-                default:
-                  return ""; // Remove other control characters
-              }
-            });
-          },
-        );
-
-        // Try parsing again after sanitization
-        metadata = JSON.parse(jsonString);
-      }
-
-      if (metadata.error) {
-        throw new Error(metadata.error);
-      }
-
-      // Use user-specified source CRS if provided, otherwise use auto-detected CRS
-      const crsForReprojection = finalSourceCrs || metadata.crs;
-
-      // Check if CRS is already in geographic coordinates (lat/lon)
-      const isAlreadyGeographic =
-        !crsForReprojection ||
-        crsForReprojection === "Unknown" ||
-        crsForReprojection === "EPSG:4326" ||
-        crsForReprojection.includes("+proj=longlat") ||
-        crsForReprojection.includes("+proj=latlong");
-
-      // Always try to reproject bbox to WGS84 for map display using proj4
-      // Only skip if already in geographic coordinates or missing data
-      if (metadata.bbox && metadata.bbox.length === 4 && !isAlreadyGeographic) {
+      // One session serves the metadata and then the feature table. Large files
+      // may first deliver a fast probe (sampled count/bbox) that is shown until
+      // exact values arrive.
+      session = await openPreviewSession(previewSource, displayName, fileFormat, sourceFiles);
+      if (!session) return; // another preview replaced this one
+
+      let settled = false;
+      const { info } = await previewRequest(session.pin, {
+        type: 'getSessionInfoBinary',
+        sessionId: session.sessionId,
+        fileBlob: previewSource, // keys the worker's info cache
+        fileName: displayName,
+        options: {
+          sourceCrs: finalSourceCrs
+        }
+      }, async (data) => {
+        if (data.type !== 'probe') return;
         try {
-          // Store original bbox before transformation
-          metadata.bboxOriginal = [...metadata.bbox];
-          const transformedBbox = await transformBboxWithProj4(
-            metadata.bbox,
-            crsForReprojection,
-          );
-          metadata.bbox = transformedBbox;
-          metadata.bboxReprojected = true;
-          metadata.crsUsedForReprojection = crsForReprojection;
-          console.log(
-            `✓ Bbox reprojected to WGS84 using ${finalSourceCrs ? "user-specified" : "auto-detected"} CRS:`,
-            crsForReprojection,
-          );
-        } catch (projError) {
-          console.warn(
-            "Bbox reprojection failed, using original coordinates:",
-            projError.message,
-          );
-          // Keep original bbox as fallback
-          metadata.bboxReprojected = false;
+          const probeMetadata = await buildPreviewMetadata(data.info, finalSourceCrs);
+          if (settled) return;
+          setPreviewData(probeMetadata);
+          setShowPreview(true);
+          setIsLoadingPreview(false);
+        } catch (probeError) {
+          console.warn("Preview probe ignored:", probeError.message);
         }
-      }
+      });
+      settled = true;
+      if (previewSessionRef.current !== session) return;
+
+      const metadata = await buildPreviewMetadata(info, finalSourceCrs);
 
       // Log debug info
       console.log("=== Preview Data ===");
@@ -837,6 +907,8 @@ function App() {
       setPreviewData(metadata);
       setShowPreview(true);
     } catch (error) {
+      // the preview was closed or replaced while its session was busy
+      if (session && previewSessionRef.current !== session) return;
       console.error("Error extracting preview data:", error);
       setToast({
         isOpen: true,
@@ -848,6 +920,74 @@ function App() {
     }
   };
 
+  const closeWorkerSession = (session) => {
+    previewRequest(session.pin, { type: 'closeSession', sessionId: session.sessionId, fileName: session.fileName })
+      .catch(() => {})
+      .finally(() => session.pin.release());
+  };
+
+  const closePreviewSession = () => {
+    previewEpochRef.current++;
+    const session = previewSessionRef.current;
+    previewSessionRef.current = null;
+    setPreviewSession(null);
+    if (session) closeWorkerSession(session);
+  };
+
+  // Open the preview's session on a pinned worker, replacing the previous one;
+  // resolves with null when another preview or closing it came first. The
+  // session outlives the preview dialog, for exports, until the files change.
+  const openPreviewSession = async (fileBlob, fileName, fileFormat, sourceFiles) => {
+    closePreviewSession();
+    const epoch = previewEpochRef.current;
+    const pin = workerPoolRef.current.pin();
+    let sessionId;
+    try {
+      ({ sessionId } = await previewRequest(pin, {
+        type: 'openBlobSession',
+        fileBlob,
+        fileName,
+        inputFormat: fileFormat
+      }));
+    } catch (error) {
+      pin.release();
+      throw error;
+    }
+    const session = { sessionId, fileName, pin, fileBlob, inputFormat: fileFormat, sourceFiles };
+    if (epoch !== previewEpochRef.current) {
+      closeWorkerSession(session);
+      return null;
+    }
+    previewSessionRef.current = session;
+    setPreviewSession(session);
+    return session;
+  };
+
+  // One decoded page of preview rows (stable per session, for the table)
+  const loadPreviewFeatures = useCallback((offset, limit) => {
+    if (!previewSession) return Promise.reject(new Error('No preview session'));
+    return previewRequest(previewSession.pin, {
+      type: 'getFeatures',
+      sessionId: previewSession.sessionId,
+      fileName: previewSession.fileName,
+      offset,
+      limit
+    }).then((result) => decodeFeaturePage(result.page));
+  }, [previewSession]);
+
+  // The open preview session, when it reads exactly these files as this format
+  const previewSessionFor = (files, format) => {
+    const session = previewSessionRef.current;
+    if (!session || session.inputFormat !== format) return null;
+    const same = session.sourceFiles.length === files.length &&
+      files.every((file) => session.sourceFiles.includes(file));
+    return same ? session : null;
+  };
+
+  const closePreview = () => {
+    setShowPreview(false);
+  };
+
   const resolveEpsgCode = async (rawValue, scope) => {
     if (!rawValue) return;
     const match = rawValue.trim().match(EPSG_REGEX);
@@ -914,74 +1054,123 @@ function App() {
     resolveEpsgCode(customTargetCrs, "target");
   };
 
-  // Helper function to convert file using Web Worker
-  const convertFileWithWorker = (fileData, fileName, inputFormat, outputFormat, options) => {
-    return new Promise((resolve, reject) => {
-      const worker = converterWorkerRef.current;
-
-      if (!worker) {
-        reject(new Error('Worker not initialized'));
-        return;
-      }
-
-      // Set up one-time message handler for this conversion
-      const handleMessage = (e) => {
-        worker.removeEventListener('message', handleMessage);
-
-        if (e.data.success) {
-          resolve(new Uint8Array(e.data.data));
-        } else {
-          reject(new Error(e.data.error));
+  // Helper function to convert file using the worker pool
+  const convertFileWithWorker = (fileData, fileName, inputFormat, outputFormat, options, onProgress) => {
+    const pool = workerPoolRef.current;
+    if (!pool) return Promise.reject(new Error('Worker not initialized'));
+
+    // Output arrives as bounded chunks; a Blob keeps them without one big contiguous copy
+    const chunks = [];
+
+    // Send conversion request (progress and chunks, then one final message);
+    // the input size orders it behind smaller requests
+    return pool.run({
+      type: 'convert',
+      fileData,
+      fileName,
+      inputFormat,
+      outputFormat,
+      options,
+      stream: true
+    }, {
+      transfer: [fileData], // Transfer ArrayBuffer ownership to worker
+      estimatedBytes: fileData.byteLength,
+      onMessage: (data) => {
+        if (data.type === 'chunk') {
+          chunks.push(data.data);
+        } else if (data.type === 'progress' && onProgress) {
+          onProgress(data.fraction >= 0 ? data.fraction : null);
         }
-      };
-
-      worker.addEventListener('message', handleMessage);
-
-      // Send conversion request to worker
-      worker.postMessage({
-        type: 'convert',
-        fileData,
-        fileName,
-        inputFormat,
-        outputFormat,
-        options
-      }, [fileData]); // Transfer ArrayBuffer ownership to worker
+      }
+    }).then((data) => {
+      if (!data.success) throw new Error(data.error);
+      return new Blob(data.streamed ? chunks : [data.data], {
+        type: "application/octet-stream",
+      });
     });
   };
 
-  // Helper function to get vector info using Web Worker
-  const getVectorInfoWithWorker = (fileData, fileName, inputFormat, sourceCrs) => {
-    return new Promise((resolve, reject) => {
-      const worker = converterWorkerRef.current;
-
-      if (!worker) {
-        reject(new Error('Worker not initialized'));
-        return;
-      }
-
-      // Set up one-time message handler for this request
-      const handleMessage = (e) => {
-        worker.removeEventListener('message', handleMessage);
-
-        if (e.data.success) {
-          resolve(e.data.info);
-        } else {
-          reject(new Error(e.data.error));
+  // Convert many files with one plan in a single worker request; the worker
+  // reads the next file while it converts the current one. onItem gets
+  // (index, blob or null, error) per file; resolves with the merged output
+  // Blob, or null when every file got its own.
+  const convertBatchWithWorker = (entries, outputFormat, options, merge, onItem, onProgress) => {
+    const pool = workerPoolRef.current;
+    if (!pool) return Promise.reject(new Error('Worker not initialized'));
+
+    const chunks = [];
+
+    // Files are handed over as Blobs, so nothing is read before the worker needs it
+    return pool.run({
+      type: 'convertBatch',
+      files: entries,
+      fileName: merge === 'layer' ? (options.layerName || 'merged') : 'batch',
+      outputFormat,
+      options,
+      merge,
+      stream: true
+    }, {
+      estimatedBytes: entries.reduce((sum, entry) =>
+        sum + (entry.fileBlob ? entry.fileBlob.size : entry.fileData.byteLength), 0),
+      onMessage: (data) => {
+        if (data.type === 'chunk') {
+          chunks.push(data.data);
+        } else if (data.type === 'progress') {
+          if (onProgress) onProgress(data.fraction >= 0 ? data.fraction : null);
+        } else if (data.type === 'batchItem') {
+          const blob = data.data
+            ? new Blob([data.data], { type: "application/octet-stream" })
+            : null;
+          onItem(data.index, blob, data.success ? null : data.error);
         }
-      };
+      }
+    }).then((data) => {
+      if (!data.success) throw new Error(data.error);
+      if (!merge) return null;
+      return new Blob(data.streamed ? chunks : [data.data], {
+        type: "application/octet-stream",
+      });
+    });
+  };
 
-      worker.addEventListener('message', handleMessage);
+  // Export from an open session (the preview's), where the input is already
+  // parsed; outputs written per layer still spread over the pool
+  const convertSessionWithWorker = (session, outputFormat, options, onProgress) => {
+    if (outputFormat === "shapefile" || session.inputFormat === "gpx") {
+      return convertLayersInParallel({
+        pool: workerPoolRef.current,
+        session,
+        fileBlob: session.fileBlob,
+        fileName: session.fileName,
+        inputFormat: session.inputFormat,
+        outputFormat,
+        options,
+        onProgress,
+      });
+    }
 
-      // Send getVectorInfo request to worker
-      worker.postMessage({
-        type: 'getVectorInfo',
-        fileData,
-        fileName,
-        inputFormat,
-        options: {
-          sourceCrs
+    const chunks = [];
+    return session.pin.run({
+      type: 'convertSession',
+      sessionId: session.sessionId,
+      fileName: session.fileName,
+      outputFormat,
+      options,
+      stream: true
+    }, {
+      estimatedBytes: session.fileBlob.size,
+      onMessage: (data) => {
+        if (data.type === 'chunk') {
+          chunks.push(data.data);
+        } else if (data.type === 'progress' && onProgress) {
+          onProgress(data.fraction >= 0 ? data.fraction : null);
         }
-      }, [fileData]); // Transfer ArrayBuffer ownership to worker
+      }
+    }).then((data) => {
+      if (!data.success) throw new Error(data.error);
+      return new Blob(data.streamed ? chunks : [data.data], {
+        type: "application/octet-stream",
+      });
     });
   };
 
@@ -1075,12 +1264,127 @@ function App() {
         displayName: f.name
       }));
 
+      // Get final CRS values (use custom if 'custom' is selected)
+      const finalSourceCrs =
+        sourceCrs === "custom" ? customSourceCrs : sourceCrs;
+      const finalTargetCrs =
+        targetCrs === "custom" ? customTargetCrs : targetCrs;
+
+      const conversionOptions = {
+        sourceCrs: finalSourceCrs,
+        targetCrs: finalTargetCrs,
+        layerName,
+        geometryTypeFilter,
+        skipFailures,
+        makeValid,
+        keepZ,
+        whereClause,
+        selectFields,
+        simplifyTolerance,
+        explodeCollections,
+        preserveFid,
+        geojsonPrecision,
+        csvGeometryMode,
+        progress: true,
+      };
+
+      // Download an output named after its input
+      const downloadOutput = async (outputBlob, displayName) => {
+        const baseName = displayName.replace(/\.[^/.]+$/, "");
+
+        // Check if output is a ZIP (multi-file output from GPX)
+        // ZIP files start with "PK" (0x50 0x4B)
+        const outputHead = new Uint8Array(await outputBlob.slice(0, 2).arrayBuffer());
+        const isZip = outputHead.length >= 2 &&
+                      outputHead[0] === 0x50 &&
+                      outputHead[1] === 0x4B;
+
+        const outputExt = isZip ? ".zip" : (FORMAT_LOOKUP[outputFormat]?.downloadExt || ".dat");
+
+        // Trigger download
+        const url = URL.createObjectURL(outputBlob);
+        const a = document.createElement("a");
+        a.href = url;
+        a.download = `${baseName}${outputExt}`;
+
+        document.body.appendChild(a);
+        a.click();
+        document.body.removeChild(a);
+        URL.revokeObjectURL(url);
+      };
+
+      // Plain files converted as a whole go to the worker as one batch (the
+      // per-layer pool keeps Shapefile outputs and GPX inputs)
+      const itemInputFormat = (item) => detectFormatFromFile(item.file.name) || inputFormat;
+      const isBatchable = (item) =>
+        item.type === 'single' && outputFormat !== "shapefile" && itemInputFormat(item) !== "gpx";
+      const batchItems = processableItems.filter(isBatchable);
+      const remainingItems = batchItems.length > 1
+        ? processableItems.filter((item) => !isBatchable(item))
+        : processableItems;
+
+      if (batchItems.length > 1) {
+        setConversionProgress(null);
+        const downloads = [];
+        try {
+          const mergedBlob = await convertBatchWithWorker(
+            batchItems.map((item) => ({
+              fileBlob: item.file,
+              fileName: item.displayName,
+              inputFormat: itemInputFormat(item),
+            })),
+            outputFormat,
+            conversionOptions,
+            batchMerge,
+            (index, blob, error) => {
+              const displayName = batchItems[index].displayName;
+              if (error) {
+                failCount++;
+                errors.push(`${displayName}: ${error}`);
+                return;
+              }
+              successCount++;
+              successFiles.push(displayName);
+              if (blob) downloads.push(downloadOutput(blob, displayName));
+            },
+            setConversionProgress
+          );
+          if (mergedBlob) {
+            downloads.push(downloadOutput(mergedBlob, batchMerge === "layer" ? (layerName || "merged") : "batch"));
+          }
+          await Promise.all(downloads);
+        } catch (error) {
+          console.error("Batch conversion error:", error);
+          failCount++;
+          errors.push(`${batchMerge ? "Merged output" : "Batch"}: ${error.message}`);
+        }
+      }
+
       // Process each item
-      for (let itemIndex = 0; itemIndex < processableItems.length; itemIndex++) {
-        const item = processableItems[itemIndex];
+      for (let itemIndex = 0; itemIndex < remainingItems.length; itemIndex++) {
+        const item = remainingItems[itemIndex];
         const displayName = item.displayName || (item.file ? item.file.name : 'unknown');
 
         try {
+          // The preview session already holds this input: export from it
+          const session = previewSessionFor(
+            item.files || [item.file],
+            item.format || detectFormatFromFile(item.file.name) || inputFormat,
+          );
+          if (session) {
+            setConversionProgress(null);
+            const outputBlob = await convertSessionWithWorker(
+              session,
+              outputFormat,
+              conversionOptions,
+              setConversionProgress
+            );
+            await downloadOutput(outputBlob, displayName);
+            successCount++;
+            successFiles.push(displayName);
+            continue;
+          }
+
           let inputArray;
           let actualInputFormat;
 
@@ -1151,60 +1455,31 @@ function App() {
             }
           }
 
-          // Get final CRS values (use custom if 'custom' is selected)
-          const finalSourceCrs =
-            sourceCrs === "custom" ? customSourceCrs : sourceCrs;
-          const finalTargetCrs =
-            targetCrs === "custom" ? customTargetCrs : targetCrs;
-
-          // Convert using Web Worker (off main thread)
-          const outputArray = await convertFileWithWorker(
-            inputArray.buffer,
-            displayName,
-            actualInputFormat,
-            outputFormat,
-            {
-              sourceCrs: finalSourceCrs,
-              targetCrs: finalTargetCrs,
-              layerName,
-              geometryTypeFilter,
-              skipFailures,
-              makeValid,
-              keepZ,
-              whereClause,
-              selectFields,
-              simplifyTolerance,
-              explodeCollections,
-              preserveFid,
-              geojsonPrecision,
-              csvGeometryMode,
-            }
-          );
-
-          // Create blob for download
-          const baseName = displayName.replace(/\.[^/.]+$/, "");
-          const outputBlob = new Blob([outputArray], {
-            type: "application/octet-stream",
-          });
-
-          // Check if output is a ZIP (multi-file output from GPX)
-          // ZIP files start with "PK" (0x50 0x4B)
-          const isZip = outputArray.length >= 2 &&
-                        outputArray[0] === 0x50 &&
-                        outputArray[1] === 0x4B;
-
-          const outputExt = isZip ? ".zip" : (FORMAT_LOOKUP[outputFormat]?.downloadExt || ".dat");
-
-          // Trigger download
-          const url = URL.createObjectURL(outputBlob);
-          const a = document.createElement("a");
-          a.href = url;
-          a.download = `${baseName}${outputExt}`;
+          setConversionProgress(null);
+
+          // Outputs written per layer (Shapefile, GPX layers) can use a pool of
+          // workers; the rest convert in one worker (off main thread)
+          const outputBlob =
+            outputFormat === "shapefile" || actualInputFormat === "gpx"
+              ? await convertLayersInParallel({
+                pool: workerPoolRef.current,
+                fileBlob: new Blob([inputArray]),
+                fileName: displayName,
+                inputFormat: actualInputFormat,
+                outputFormat,
+                options: conversionOptions,
+                onProgress: setConversionProgress,
+              })
+              : await convertFileWithWorker(
+                inputArray.buffer,
+                displayName,
+                actualInputFormat,
+                outputFormat,
+                conversionOptions,
+                setConversionProgress
+              );
 
-          document.body.appendChild(a);
-          a.click();
-          document.body.removeChild(a);
-          URL.revokeObjectURL(url);
+          await downloadOutput(outputBlob, displayName);
 
           successCount++;
           successFiles.push(displayName);
@@ -1410,6 +1685,7 @@ function App() {
       });
     } finally {
       setIsConverting(false);
+      setConversionProgress(null);
     }
   };
 
@@ -1439,7 +1715,7 @@ function App() {
           <motion.div className="grid grid-cols-1 lg:grid-cols-12 gap-6">
             {/* Left Sidebar - Supported Formats */}
             <div className="lg:col-span-3">
-              <SupportedFormats className="w-full" />
+              <SupportedFormats className="w-full" formats={formats} />
             </div>
 
             {/* Center - Main Converter */}
@@ -1528,7 +1804,7 @@ function App() {
                       onChange={handleFileChange}
                       className="hidden"
                       id="file-select"
-                      accept={INPUT_ACCEPT_ATTRIBUTE}
+                      accept={inputAccept}
                       multiple
                     />
                     <input
@@ -1608,7 +1884,10 @@ function App() {
                         </Text>
                         <button
                           type="button"
-                          onClick={() => setSelectedFiles([])}
+                          onClick={() => {
+                            setSelectedFiles([]);
+                            closePreviewSession();
+                          }}
                           className="text-xs text-red-400 hover:text-red-300"
                         >
                           Clear all
@@ -1656,7 +1935,7 @@ function App() {
                           formatAutoDetected ? "ring-2 ring-emerald-500/30" : ""
                         }
                       >
-                        {READABLE_FORMATS.map((format) => {
+                        {inputFormats.map((format) => {
                           const optionLabel = format.capabilities.write
                             ? format.label
                             : `${format.label} (input only)`;
@@ -1676,7 +1955,7 @@ function App() {
                         value={outputFormat}
                         onChange={(e) => setOutputFormat(e.target.value)}
                       >
-                        {WRITABLE_FORMATS.map((format) => {
+                        {outputFormats.map((format) => {
                           const optionLabel = format.capabilities.read
                             ? format.label
                             : `${format.label} (output only)`;
@@ -1989,6 +2268,31 @@ function App() {
                         </FieldGroup>
                       </div>
 
+                      {/* Multiple Files */}
+                      {selectedFiles.length > 1 && (
+                        <div className="space-y-4 pt-4 border-t border-zinc-800">
+                          <Text className="font-medium text-zinc-300">
+                            Multiple Files
+                          </Text>
+                          <Field>
+                            <Label>Outputs</Label>
+                            <Select
+                              value={batchMerge}
+                              onChange={(e) => setBatchMerge(e.target.value)}
+                            >
+                              <option value="">One file per input</option>
+                              <option value="zip">All outputs in one ZIP</option>
+                              <option value="layer">Merge into one layer</option>
+                            </Select>
+                            <Text className="text-xs text-zinc-500 mt-2">
+                              Files are converted in one batch with the same
+                              options. Merged layers use the Layer Name, or
+                              "merged"
+                            </Text>
+                          </Field>
+                        </div>
+                      )}
+
                       {/* Format-Specific Options */}
                       {(outputFormat === "geojson" ||
                         outputFormat === "csv") && (
@@ -2156,7 +2460,11 @@ function App() {
                         data-slot="icon"
                         className="animate-spin"
                       />
-                      <span>Converting...</span>
+                      <span>
+                        {conversionProgress === null
+                          ? "Converting..."
+                          : `Converting... ${Math.round(conversionProgress * 100)}%`}
+                      </span>
                     </>
                   ) : (
                     <>
@@ -2181,10 +2489,12 @@ function App() {
 
       <PreviewModal
         isOpen={showPreview}
-        onClose={() => setShowPreview(false)}
+        onClose={closePreview}
         selectedFile={selectedFiles.length > 0 ? selectedFiles[0] : null}
         previewData={previewData}
         inputFormat={inputFormat}
+        featureSession={previewSession ? previewSession.sessionId : null}
+        loadFeatures={previewSession ? loadPreviewFeatures : null}
       />
 
       <Toast
@@ -1,20 +1,147 @@
+import { useEffect, useRef, useState } from 'react'
 import { motion } from 'motion/react'
 import { XMarkIcon } from '@heroicons/react/24/outline'
 import Map, { Source, Layer } from 'react-map-gl/maplibre'
+import { wkbGeometryType } from '../workers/featurePage'
+
+// Virtual-scrolled feature table: only the rows in view are rendered and only
+// a few pages around them are kept, so any row count scrolls in constant memory
+const ROW_HEIGHT = 32
+const TABLE_HEIGHT = 320
+const PAGE_SIZE = 200
+const MAX_CACHED_PAGES = 8
+
+function formatCell(value) {
+  if (value === null || value === undefined) {
+    return <span className="text-zinc-600 italic">null</span>
+  }
+  return String(value)
+}
+
+function FeatureTable({ loadFeatures, featureCount }) {
+  const pagesRef = useRef(new globalThis.Map())
+  const loadingRef = useRef(new Set())
+  const [, setVersion] = useState(0)
+  const [scrollTop, setScrollTop] = useState(0)
+  const [columns, setColumns] = useState(null)
+  const [endRow, setEndRow] = useState(null) // row count once the last page is read
+  const [error, setError] = useState(null)
+
+  // the header count may be an estimate: grow past it until a page says it is the last
+  const loadedRows = Math.max(0, ...[...pagesRef.current.entries()].map(
+    ([index, page]) => index * PAGE_SIZE + page.rowCount + (page.nextOffset >= 0 ? PAGE_SIZE : 0)
+  ))
+  const totalRows = endRow ?? Math.max(typeof featureCount === 'number' ? featureCount : 0, loadedRows)
+
+  const firstRow = Math.floor(scrollTop / ROW_HEIGHT)
+  const lastRow = Math.min(totalRows, firstRow + Math.ceil(TABLE_HEIGHT / ROW_HEIGHT) + 1)
+  const firstPage = Math.floor(firstRow / PAGE_SIZE)
+  const lastPage = Math.floor(Math.max(firstRow, lastRow - 1) / PAGE_SIZE)
+
+  useEffect(() => {
+    for (let index = firstPage; index <= lastPage; index++) {
+      if (pagesRef.current.has(index) || loadingRef.current.has(index)) continue
+      if (endRow !== null && index * PAGE_SIZE >= endRow) continue
+      loadingRef.current.add(index)
+      loadFeatures(index * PAGE_SIZE, PAGE_SIZE)
+        .then((page) => {
+          const pages = pagesRef.current
+          pages.set(index, page)
+          // drop the pages farthest from the one being read
+          while (pages.size > MAX_CACHED_PAGES) {
+            const farthest = [...pages.keys()].sort((a, b) => Math.abs(b - index) - Math.abs(a - index))[0]
+            pages.delete(farthest)
+          }
+          if (page.columns.length > 0 || page.rowCount > 0) {
+            setColumns((current) => current || page.columns.map((c) => c.name))
+          }
+          if (page.nextOffset < 0) setEndRow(index * PAGE_SIZE + page.rowCount)
+          setVersion((v) => v + 1)
+        })
+        .catch((e) => setError(e.message))
+        .finally(() => loadingRef.current.delete(index))
+    }
+  }, [firstPage, lastPage, endRow, loadFeatures])
+
+  if (error) {
+    return (
+      <div className="bg-zinc-950 border border-zinc-800 rounded-xl p-8 text-center">
+        <p className="text-sm text-zinc-500">Failed to read features: {error}</p>
+      </div>
+    )
+  }
+
+  if (endRow === 0) {
+    return (
+      <div className="bg-zinc-950 border border-zinc-800 rounded-xl p-8 text-center">
+        <p className="text-sm text-zinc-500">The first layer has no features.</p>
+      </div>
+    )
+  }
+
+  const rows = []
+  for (let row = firstRow; row < lastRow; row++) {
+    const page = pagesRef.current.get(Math.floor(row / PAGE_SIZE))
+    const i = row % PAGE_SIZE
+    rows.push(
+      <div
+        key={row}
+        className="absolute left-0 flex min-w-full border-b border-zinc-800/60 text-xs"
+        style={{ top: row * ROW_HEIGHT, height: ROW_HEIGHT }}
+      >
+        {page && i < page.rowCount ? (
+          <>
+            <div className="w-20 shrink-0 px-3 py-2 text-zinc-500 font-mono">{page.fids[i]}</div>
+            <div className="w-36 shrink-0 px-3 py-2 text-zinc-400">{wkbGeometryType(page.geometries[i]) || '—'}</div>
+            {page.columns.map((column) => (
+              <div key={column.name} className="w-40 shrink-0 truncate px-3 py-2 text-zinc-300">
+                {formatCell(column.values[i])}
+              </div>
+            ))}
+          </>
+        ) : (
+          <div className="px-3 py-2 text-zinc-600">Loading...</div>
+        )}
+      </div>
+    )
+  }
+
+  return (
+    <div
+      className="bg-zinc-950 border border-zinc-800 rounded-xl overflow-auto"
+      style={{ height: TABLE_HEIGHT }}
+      onScroll={(e) => setScrollTop(e.currentTarget.scrollTop)}
+    >
+      <div className="sticky top-0 z-10 flex min-w-full bg-zinc-900 border-b border-zinc-800 text-xs font-semibold text-zinc-400">
+        <div className="w-20 shrink-0 px-3 py-2">FID</div>
+        <div className="w-36 shrink-0 px-3 py-2">Geometry</div>
+        {(columns || []).map((name) => (
+          <div key={name} className="w-40 shrink-0 truncate px-3 py-2 font-mono">{name}</div>
+        ))}
+      </div>
+      <div className="relative" style={{ height: totalRows * ROW_HEIGHT }}>
+        {rows}
+      </div>
+    </div>
+  )
+}
 
 export function PreviewModal({
   isOpen,
   onClose,
   selectedFile,
   previewData,
-  inputFormat
+  inputFormat,
+  featureSession,
+  loadFeatures
 }) {
   if (!isOpen || !selectedFile) return null
 
   const formattedFeatureCount =
     previewData?.featureCount !== undefined
       ? typeof previewData.featureCount === 'number'
-        ? previewData.featureCount.toLocaleString()
+        ? previewData.featureCount.toLocaleString() +
+          (previewData.featureCountExact === false ? '+' : '')
         : previewData.featureCount
       : 'Loading...'
 
@@ -101,7 +228,7 @@ export function PreviewModal({
               </div>
               <div className="space-y-1">
                 <p className="text-xs text-zinc-500">
-                  Bounding box{previewData.bboxReprojected ? ' (WGS84)' : ''}: <span className="text-zinc-400 font-mono">
+                  Bounding box{previewData.bboxReprojected ? ' (WGS84)' : ''}{previewData.bboxExact === false ? ' (sampled)' : ''}: <span className="text-zinc-400 font-mono">
                     {previewData.bbox.map((value) => value.toFixed(6)).join(', ')}
                   </span>
                 </p>
@@ -204,6 +331,19 @@ export function PreviewModal({
               </div>
             )}
           </div>
+
+          {loadFeatures && (
+            <div className="space-y-3">
+              <h4 className="text-sm font-semibold text-zinc-300 flex items-center gap-2">
+                <span>📋</span> Features
+              </h4>
+              <FeatureTable
+                key={featureSession}
+                loadFeatures={loadFeatures}
+                featureCount={previewData?.featureCount}
+              />
+            </div>
+          )}
         </div>
       </motion.div>
     </div>
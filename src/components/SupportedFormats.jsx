@@ -91,6 +91,26 @@ const SUPPORTED_FORMATS = [
     description: 'Cloud-native format optimized for streaming and random access. Very fast with spatial index built-in.',
     useCase: 'Web mapping, large datasets, cloud storage'
   },
+  {
+    value: 'geoparquet',
+    label: 'GeoParquet',
+    downloadExt: '.parquet',
+    extensions: ['parquet', 'geoparquet'],
+    capabilities: CAPABILITIES.inputOutput,
+    driver: 'Parquet',
+    description: 'Columnar Apache Parquet with WKB geometries. Compressed row groups read quickly by analytics engines.',
+    useCase: 'Data lakes, DuckDB/BigQuery analytics, cloud storage'
+  },
+  {
+    value: 'arrow',
+    label: 'Arrow IPC',
+    downloadExt: '.arrow',
+    extensions: ['arrow', 'arrows', 'feather', 'ipc'],
+    capabilities: CAPABILITIES.inputOutput,
+    driver: 'Arrow',
+    description: 'Apache Arrow IPC (Feather) file with GeoArrow-compatible geometries. Zero-copy columnar exchange.',
+    useCase: 'Exchange with pandas/GeoPandas, Arrow-based tools'
+  },
   {
     value: 'dxf',
     label: 'DXF',
@@ -437,7 +457,12 @@ const SUPPORTED_FORMATS = [
   },
 ]
 
-export function SupportedFormats({ className }) {
+// Formats with a driver (one that not every GDAL build has) are only listed
+// when hasDriver(driver) says the running GDAL registered it
+const availableFormats = (hasDriver = () => false) =>
+  SUPPORTED_FORMATS.filter((format) => !format.driver || hasDriver(format.driver))
+
+export function SupportedFormats({ className, formats = availableFormats() }) {
   const [expandedFormat, setExpandedFormat] = useState(null)
 
   const wrapperClass = className ?? 'lg:col-span-3'
@@ -453,7 +478,7 @@ export function SupportedFormats({ className }) {
         <h3 className="text-sm font-semibold text-zinc-100 mb-3">Supported Formats</h3>
         <div className="relative">
           <div className="space-y-1 max-h-[60vh] overflow-y-auto pr-1">
-            {SUPPORTED_FORMATS.map((format) => (
+            {formats.map((format) => (
               <div key={format.value} className="border-b border-zinc-800/50 last:border-0">
                 <button
                   onClick={() => setExpandedFormat(expandedFormat === format.value ? null : format.value)}
@@ -499,4 +524,4 @@ export function SupportedFormats({ className }) {
   )
 }
 
-export { SUPPORTED_FORMATS }
+export { SUPPORTED_FORMATS, availableFormats }
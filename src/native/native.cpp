@@ -3,19 +3,50 @@
 #include <gdal_priv.h>
 #include <ogr_api.h>
 #include <ogrsf_frmts.h>
+#include <ogr_p.h>
 #include <ogr_spatialref.h>
 #include <cpl_vsi.h>
 #include <cpl_string.h>
 #include <cpl_error.h>
+#include <cpl_conv.h>
+#include <cpl_json.h>
 #include <gdalwarper.h>
 #include <gdal_utils.h>
+#if GDAL_VERSION_NUM >= GDAL_COMPUTE_VERSION(3, 8, 0)
+#include <ogr_recordbatch.h>
+#define GEOCONVERTER_HAS_ARROW_BATCHES 1    // GetArrowStream + WriteArrowBatch
+#endif
+#include <sys/stat.h>
+#ifdef __EMSCRIPTEN__
+#include <emscripten.h>
+#include <unistd.h>
+#elif defined(__GLIBC__)
+#include <malloc.h>
+#endif
 #include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <list>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <set>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <ctime>
+
+static void ensureInitialized();
 
 std::string Native::getGdalInfo() {
-    GDALAllRegister();
+    ensureInitialized();
 
     std::string info = "GDAL Version: ";
     info += GDALVersionInfo("VERSION_NUM");
@@ -26,15 +57,157 @@ std::string Native::getGdalInfo() {
     return info;
 }
 
+// ----------------- job arena -----------------
+// Bump allocator for a call's own transient buffers: the pump's batch lists,
+// ZIP headers, lowercased names and escaped JSON, translate argv and upsert
+// key lookups. A call opens it with CallArenaScope and it is reset when the
+// call returns, so a long-lived tab's heap does not collect the fragments of
+// millions of small allocations. OGR features and geometries stay on the heap
+// (GDAL allocates them itself), and nothing taken from the arena may outlive
+// the call. The arena is per thread: ArenaAllocator binds to the calling
+// thread's at construction and uses the heap when none is open, so pool tasks
+// never share it.
+
+static const size_t ARENA_BLOCK_SIZE = 256 * 1024;
+
+class JobArena {
+public:
+    struct Mark {
+        size_t blocks;
+        size_t used;
+    };
+
+    JobArena() = default;
+    JobArena(const JobArena&) = delete;
+    JobArena& operator=(const JobArena&) = delete;
+    ~JobArena() { release(); }
+
+    void* allocate(size_t size, size_t align) {
+        if (!blocks_.empty()) {
+            const size_t offset = (used_ + align - 1) & ~(align - 1);
+            if (offset + size <= blocks_.back().size) {
+                used_ = offset + size;
+                return blocks_.back().data + offset;
+            }
+        }
+        addBlock(std::max(ARENA_BLOCK_SIZE, size + align));
+        used_ = size;
+        return blocks_.back().data;
+    }
+
+    Mark mark() const { return {blocks_.size(), used_}; }
+
+    // forget everything allocated since m, keeping the first block
+    void rewind(const Mark& m) {
+        while (blocks_.size() > std::max<size_t>(m.blocks, 1)) {
+            VSIFree(blocks_.back().data);
+            blocks_.pop_back();
+        }
+        used_ = m.blocks ? m.used : 0;
+    }
+
+    // end of a call: one standard block stays for the next one
+    void reset() {
+        rewind({0, 0});
+        if (!blocks_.empty() && blocks_.front().size > ARENA_BLOCK_SIZE) release();
+    }
+
+    void release() {
+        for (const Block& b : blocks_) VSIFree(b.data);
+        blocks_.clear();
+        used_ = 0;
+    }
+
+private:
+    struct Block {
+        GByte* data;
+        size_t size;
+    };
+
+    void addBlock(size_t size) {
+        GByte* data = static_cast<GByte*>(VSIMalloc(size));
+        if (!data) throw std::bad_alloc();
+        blocks_.push_back({data, size});
+    }
+
+    std::vector<Block> blocks_;
+    size_t used_ = 0;
+};
+
+// the arena of the call running on this thread (null: none open)
+static thread_local JobArena* t_callArena = nullptr;
+
+// STL allocator over the current call's arena; deallocation waits for the reset
+template <typename T>
+struct ArenaAllocator {
+    typedef T value_type;
+
+    ArenaAllocator() : arena(t_callArena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) {
+        if (!arena) return static_cast<T*>(::operator new(n * sizeof(T)));
+        return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* p, size_t) {
+        if (!arena) ::operator delete(p);
+    }
+
+    // copies allocate on the copying thread, never from another thread's arena
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator(); }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+
+    JobArena* arena;
+};
+
+typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> JobString;
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// copy of a job string for values kept past the call (sessions, plans)
+static std::string heapString(const JobString& s) {
+    return std::string(s.data(), s.size());
+}
+
+// opens the thread's arena for one API call and resets it on return; calls
+// made from inside another share the outer one's
+struct CallArenaScope {
+    const bool outer = t_callArena == nullptr;
+    CallArenaScope() { if (outer) t_callArena = &threadArena(); }
+    ~CallArenaScope() {
+        if (!outer) return;
+        t_callArena = nullptr;
+        threadArena().reset();
+    }
+    static JobArena& threadArena() {
+        static thread_local JobArena arena;
+        return arena;
+    }
+};
+
+// rewinds the call's arena on exit, for the temporaries of one pump batch; only
+// containers created inside the frame may allocate while it is open
+struct ArenaFrame {
+    JobArena* const arena = t_callArena;
+    const JobArena::Mark mark = arena ? arena->mark() : JobArena::Mark{0, 0};
+    ~ArenaFrame() { if (arena) arena->rewind(mark); }
+};
+
 // ----------------- helpers -----------------
-static std::string toLower(std::string s) {
-    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c){ return std::tolower(c); });
-    return s;
+static JobString toLower(const std::string& s) {
+    JobString lower(s.begin(), s.end());
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c){ return std::tolower(c); });
+    return lower;
 }
 
 // Escape special characters for JSON string values
-static std::string escapeJsonString(const std::string& input) {
-    std::string output;
+static JobString escapeJsonString(const std::string& input) {
+    JobString output;
     output.reserve(input.size());
 
     for (char c : input) {
@@ -62,6 +235,17 @@ static std::string escapeJsonString(const std::string& input) {
     return output;
 }
 
+// a quoted SQL string literal, for the statements built in arena or heap strings
+template <typename String>
+static void appendSqlStringLiteral(String& out, std::string_view value) {
+    out += '\'';
+    for (char c : value) {
+        if (c == '\'') out += '\'';
+        out += c;
+    }
+    out += '\'';
+}
+
 static thread_local std::string g_lastError;
 static thread_local std::string g_lastInfo;
 
@@ -111,6 +295,8 @@ static std::string getDriverNameFromFormat(const std::string& format) {
     if (f == "csv")         return "CSV";
     if (f == "pmtiles")     return "PMTiles";
     if (f == "mbtiles")     return "MBTiles";
+    if (f == "geoparquet" || f == "parquet") return "Parquet";
+    if (f == "arrow")       return "Arrow";
     if (f == "dxf")         return "DXF";
     if (f == "dgn")         return "DGN";
     if (f == "geojsonseq")  return "GeoJSONSeq";
@@ -163,6 +349,8 @@ static std::string getExtensionFromFormat(const std::string& format) {
     if (f == "csv")         return ".csv";
     if (f == "pmtiles")     return ".pmtiles";
     if (f == "mbtiles")     return ".mbtiles";
+    if (f == "geoparquet" || f == "parquet") return ".parquet";
+    if (f == "arrow")       return ".arrow";   // Arrow IPC file format
     if (f == "dxf")         return ".dxf";
     if (f == "dgn")         return ".dgn";
     if (f == "geojsonseq")  return ".geojsonseq";
@@ -187,6 +375,214 @@ static std::string getExtensionFromFormat(const std::string& format) {
     return ".geojson";
 }
 
+// ----------------- thread pool -----------------
+// One pool per module, started by initialize() and kept for its lifetime, so
+// batches are handed to threads that already exist instead of spawning and
+// joining threads per batch. The WASM build has threads only with pthreads
+// (cppjs.config.js); elsewhere the pool is empty and everything runs inline.
+#if !defined(__EMSCRIPTEN__) || defined(__EMSCRIPTEN_PTHREADS__)
+#define GEOCONVERTER_HAS_THREADS 1
+#endif
+
+// threads working on one parallelFor, the calling thread included
+static const size_t MAX_POOL_THREADS = 4;
+
+class ThreadPool {
+public:
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    void start(size_t workers) {
+        for (size_t i = 0; i < workers; i++) workers_.emplace_back([this] { run(); });
+    }
+
+    // threads a parallelFor spreads over (1: no pool)
+    size_t threads() const { return workers_.size() + 1; }
+
+    // fn(0) .. fn(count - 1) on the pool and the calling thread, which helps
+    // instead of waiting, so a job also finishes before the workers are up.
+    // Tasks run under CPLQuietErrorHandler: they report failures in their
+    // results, or by throwing (the first exception is rethrown here).
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn) {
+        std::lock_guard<std::mutex> submit(submitMutex_);   // one job at a time
+        Job job(fn, count);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            generation_++;
+        }
+        wake_.notify_all();
+
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        work(job);
+        CPLPopErrorHandler();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [&] { return job.active == 0; });
+        job_ = nullptr;
+        if (job.error) std::rethrow_exception(job.error);
+    }
+
+private:
+    struct Job {
+        Job(const std::function<void(size_t)>& f, size_t n) : fn(f), count(n) {}
+        const std::function<void(size_t)>& fn;
+        const size_t count;
+        std::atomic<size_t> next{0};
+        size_t active = 0;              // workers inside work(), under mutex_
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    static void work(Job& job) {
+        for (size_t i = job.next++; i < job.count; i = job.next++) {
+            try {
+                job.fn(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.errorMutex);
+                if (!job.error) job.error = std::current_exception();
+                job.next = job.count;
+            }
+        }
+    }
+
+    void run() {
+        // GDAL error handlers are per thread; the caller's one is never reached from here
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        uint64_t seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+            wake_.wait(lock, [&] { return stopping_ || (job_ && generation_ != seen); });
+            if (stopping_) break;
+            seen = generation_;
+            Job* job = job_;
+            job->active++;
+            lock.unlock();
+            work(*job);
+            lock.lock();
+            if (--job->active == 0) done_.notify_all();
+        }
+        CPLPopErrorHandler();
+    }
+
+    std::vector<std::thread> workers_;
+    std::mutex submitMutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    Job* job_ = nullptr;
+    uint64_t generation_ = 0;
+    bool stopping_ = false;
+};
+
+static ThreadPool g_threadPool;
+
+static void startThreadPool() {
+#ifdef GEOCONVERTER_HAS_THREADS
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    g_threadPool.start(std::min(cores, MAX_POOL_THREADS) - 1);
+#endif
+}
+
+// ----------------- initialization -----------------
+// GDAL/PROJ setup happens once per module instead of on every call.
+static std::once_flag g_initOnce;
+static int g_registeredDrivers = 0;
+
+static void discoverProjData() {
+    // Set PROJ data path for WebAssembly/Emscripten environment
+    // Try common paths where cpp.js might mount the PROJ data
+    const char* projPaths[] = {
+        "/proj",
+        "/usr/share/proj",
+        "/data/proj",
+        "/opt/proj/share/proj",
+        nullptr
+    };
+
+    for (const char** path = projPaths; *path != nullptr; ++path) {
+        VSIStatBufL statBuf;
+        if (VSIStatL(*path, &statBuf) == 0) {
+            CPLSetConfigOption("PROJ_LIB", *path);
+            break;
+        }
+    }
+}
+
+// keep only the drivers named in a comma-separated list ("" keeps all).
+// Fewer drivers means fewer Identify() probes on every GDALOpenEx.
+static void keepOnlyDrivers(const std::string& drivers) {
+    std::vector<JobString> keep;
+    size_t start = 0;
+    while (start <= drivers.size()) {
+        size_t comma = drivers.find(',', start);
+        if (comma == std::string::npos) comma = drivers.size();
+        std::string name = drivers.substr(start, comma - start);
+        name.erase(0, name.find_first_not_of(" \t"));
+        name.erase(name.find_last_not_of(" \t") + 1);
+        if (!name.empty()) keep.push_back(toLower(name));
+        start = comma + 1;
+    }
+    if (keep.empty()) return;
+
+    for (int i = GDALGetDriverCount() - 1; i >= 0; i--) {
+        GDALDriverH drv = GDALGetDriver(i);
+        const JobString name = toLower(GDALGetDriverShortName(drv));
+        if (std::find(keep.begin(), keep.end(), name) == keep.end()) {
+            GDALDeregisterDriver(drv);
+            GDALDestroyDriver(drv);
+        }
+    }
+}
+
+static void initializeOnce(const std::string& drivers) {
+    std::call_once(g_initOnce, [&] {
+        GDALAllRegister();
+        keepOnlyDrivers(drivers);
+        discoverProjData();
+        g_registeredDrivers = GDALGetDriverCount();
+        startThreadPool();
+    });
+}
+
+static void ensureInitialized() {
+    initializeOnce("");
+}
+
+int Native::initialize(const std::string& drivers) {
+    initializeOnce(drivers);
+    return g_registeredDrivers;
+}
+
+bool Native::hasDriver(const std::string& name) {
+    ensureInitialized();
+    return GDALGetDriverByName(name.c_str()) != nullptr;
+}
+
+// CPL debug messages are opt-in per call (setDebugLogging) and only ever set
+// for the calling thread, so they never leak into later conversions.
+static thread_local bool g_debugLogging = false;
+
+void Native::setDebugLogging(bool enabled) {
+    g_debugLogging = enabled;
+}
+
+void Native::setConfigOption(const std::string& key, const std::string& value) {
+    CPLSetThreadLocalConfigOption(key.c_str(), value.empty() ? nullptr : value.c_str());
+}
+
+struct CallDebugScope {
+    const bool enabled = g_debugLogging;
+    CallDebugScope() { if (enabled) CPLSetThreadLocalConfigOption("CPL_DEBUG", "ON"); }
+    ~CallDebugScope() { if (enabled) CPLSetThreadLocalConfigOption("CPL_DEBUG", nullptr); }
+};
+
 // Simple error handler: capture both errors and warnings
 static void ErrHandler(CPLErr classType, int, const char* msg) {
     if (classType == CE_Failure || classType == CE_Fatal) {
@@ -196,6 +592,217 @@ static void ErrHandler(CPLErr classType, int, const char* msg) {
     }
 }
 
+// ----------------- progress and timings -----------------
+// Progress goes to Module.geoconverterProgress(fraction, phase) for the calls
+// that asked for it (setProgressReporting); a false return cancels the call
+// at the next report: every pump batch, ZIP write, and GDALVectorTranslate
+// step for sources that count their features cheaply.
+#ifdef __EMSCRIPTEN__
+EM_JS(int, geoconverterReportProgress, (double fraction, const char* phase), {
+    var report = Module.geoconverterProgress;
+    if (typeof report !== 'function') return 1;
+    return report(fraction, UTF8ToString(phase)) === false ? 0 : 1;
+});
+#else
+static int geoconverterReportProgress(double, const char*) { return 1; }
+#endif
+
+static const char* CANCELLED_MESSAGE = "Conversion cancelled";
+static const double PROGRESS_MIN_STEP = 0.01;
+static const std::chrono::milliseconds PROGRESS_MIN_INTERVAL(100);
+
+struct ProgressState {
+    bool enabled = false;
+    bool cancelled = false;
+    double base = 0;        // share of the call before the current stage
+    double span = 1;        // share of the call taken by the current stage
+    double lastFraction = -1;
+    std::chrono::steady_clock::time_point lastReport;
+};
+static thread_local ProgressState g_progress;
+
+void Native::setProgressReporting(bool enabled) {
+    g_progress.enabled = enabled;
+}
+
+// wall-clock time per phase of the last open/convert call on this thread (ms)
+struct CallTimings {
+    double materialize = 0;
+    double open = 0;
+    double count = 0;
+    double translate = 0;   // includes count and zip; getLastTimings reports it net
+    double zip = 0;
+    double copyOut = 0;
+};
+static thread_local CallTimings g_timings;
+
+// adds the lifetime of the scope to one phase of g_timings
+struct PhaseTimer {
+    explicit PhaseTimer(double& phase) : phase(phase), start(std::chrono::steady_clock::now()) {}
+    ~PhaseTimer() {
+        phase += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    double& phase;
+    const std::chrono::steady_clock::time_point start;
+};
+
+// start of an open/convert entry point: no stage, no cancellation, zero timings
+static void resetCallInstrumentation() {
+    const bool enabled = g_progress.enabled;
+    g_progress = ProgressState();
+    g_progress.enabled = enabled;
+    g_timings = CallTimings();
+}
+
+// report progress through the current stage (0..1, < 0 when unknown) and
+// return false once the caller has cancelled; reports are throttled
+static bool reportProgress(double stageFraction, const char* phase) {
+    ProgressState& p = g_progress;
+    if (!p.enabled || p.cancelled) return !p.cancelled;
+
+    const double fraction = stageFraction < 0 ? -1.0
+        : std::min(1.0, p.base + p.span * std::min(1.0, stageFraction));
+    const auto now = std::chrono::steady_clock::now();
+    if (std::fabs(fraction - p.lastFraction) < PROGRESS_MIN_STEP && now - p.lastReport < PROGRESS_MIN_INTERVAL) {
+        return true;
+    }
+    p.lastFraction = fraction;
+    p.lastReport = now;
+    if (!geoconverterReportProgress(fraction, phase)) p.cancelled = true;
+    return !p.cancelled;
+}
+
+static void throwIfCancelled(double stageFraction, const char* phase) {
+    if (!reportProgress(stageFraction, phase)) throw std::runtime_error(CANCELLED_MESSAGE);
+}
+
+// narrows progress to part index of count of the enclosing stage for the scope
+struct ProgressStage {
+    ProgressStage(size_t index, size_t count) : base(g_progress.base), span(g_progress.span) {
+        const double n = count > 0 ? static_cast<double>(count) : 1.0;
+        g_progress.base = base + span * (index / n);
+        g_progress.span = span / n;
+    }
+    ~ProgressStage() {
+        g_progress.base = base;
+        g_progress.span = span;
+    }
+    const double base;
+    const double span;
+};
+
+// ----------------- memory budget -----------------
+// Conversions track the heap (and their /vsimem job directory) at phase
+// boundaries and pump batches. With ConversionPlan::memoryBudget set they fail
+// with a clear error once the heap passes it, instead of aborting on a failed
+// allocation later, and switch to spill mode when the input looks too large:
+// the ZIP is built one member at a time and the input is released once open.
+static const double SPILL_INPUT_FACTOR = 3.0;  // heap per input byte expected while converting
+static const int TRANSLATE_MEMORY_SAMPLE_STEPS = 256;
+
+struct MemoryState {
+    size_t budget = 0;          // 0 = unlimited
+    bool spill = false;
+    size_t peakHeap = 0;
+    size_t peakVsimem = 0;
+    std::string jobDir;         // /vsimem directory of the current call
+    std::string exceeded;       // error once the budget was passed
+    int translateSteps = 0;
+};
+static thread_local MemoryState g_memory;
+
+// heap in use: the WASM break (memory never shrinks, so this is what runs out),
+// or the allocator's in-use bytes natively
+static size_t heapInUse() {
+#if defined(__EMSCRIPTEN__)
+    return reinterpret_cast<size_t>(sbrk(0));
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 mi = mallinfo2();
+    return mi.uordblks + mi.hblkhd;
+#else
+    return 0;
+#endif
+}
+
+static size_t vsimemBytes(const std::string& dir) {
+    size_t total = 0;
+    char** files = VSIReadDirRecursive(dir.c_str());
+    for (int i = 0; files && files[i]; i++) {
+        VSIStatBufL st;
+        const std::string path = dir + "/" + files[i];
+        if (VSIStatL(path.c_str(), &st) == 0 && !VSI_ISDIR(st.st_mode)) {
+            total += static_cast<size_t>(st.st_size);
+        }
+    }
+    CSLDestroy(files);
+    return total;
+}
+
+static std::string megabytes(size_t bytes) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.1f", bytes / (1024.0 * 1024.0));
+    return buf;
+}
+
+// budget and spill mode of a conversion over inputBytes of heap-resident input
+static void beginCallMemory(double budget, size_t inputBytes, const std::string& jobDir) {
+    g_memory = MemoryState();
+    g_memory.budget = budget > 0 ? static_cast<size_t>(budget) : 0;
+    g_memory.jobDir = jobDir;
+    const size_t heap = heapInUse();
+    g_memory.peakHeap = heap;
+    g_memory.spill = g_memory.budget > 0 &&
+                     heap + SPILL_INPUT_FACTOR * inputBytes > static_cast<double>(g_memory.budget);
+}
+
+// update the peaks; false (with g_memory.exceeded set) once the heap is over budget
+static bool sampleMemory(const char* phase, bool countFiles = false) {
+    MemoryState& m = g_memory;
+    const size_t heap = heapInUse();
+    m.peakHeap = std::max(m.peakHeap, heap);
+    if (countFiles && !m.jobDir.empty()) {
+        m.peakVsimem = std::max(m.peakVsimem, vsimemBytes(m.jobDir));
+    }
+    if (m.budget > 0 && heap > m.budget && m.exceeded.empty()) {
+        m.exceeded = std::string("Memory budget exceeded while ") + phase + ": " + megabytes(heap) +
+                     " MB in use, budget " + megabytes(m.budget) + " MB";
+    }
+    return m.exceeded.empty();
+}
+
+static void memoryCheckpoint(const char* phase, bool countFiles = false) {
+    if (!sampleMemory(phase, countFiles)) throw std::runtime_error(g_memory.exceeded);
+}
+
+// fail before an allocation of bytes that would take the heap over budget
+static void requireMemory(size_t bytes, const char* phase) {
+    const size_t heap = heapInUse();
+    if (g_memory.budget > 0 && heap + bytes > g_memory.budget) {
+        g_memory.exceeded = std::string("Memory budget exceeded while ") + phase + ": needs " +
+                            megabytes(bytes) + " MB more with " + megabytes(heap) +
+                            " MB in use, budget " + megabytes(g_memory.budget) + " MB";
+        throw std::runtime_error(g_memory.exceeded);
+    }
+}
+
+// the error a failed call reports when it was cancelled or ran out of budget
+static void overrideAbortError() {
+    if (g_progress.cancelled) {
+        g_lastError = CANCELLED_MESSAGE;
+    } else if (!g_memory.exceeded.empty()) {
+        g_lastError = g_memory.exceeded;
+    }
+}
+
+// GDALVectorTranslate progress callback; also enforces the memory budget
+static int CPL_STDCALL translateProgress(double complete, const char*, void*) {
+    if (g_memory.budget > 0 && ++g_memory.translateSteps % TRANSLATE_MEMORY_SAMPLE_STEPS == 0 &&
+        !sampleMemory("translating")) {
+        return FALSE;
+    }
+    return reportProgress(complete, "translate") ? TRUE : FALSE;
+}
+
 // find a .shp inside /vsizip//vsimem/xxx.zip (first match)
 static std::string pickShpInsideZip(const std::string& zipVsi) {
     char** files = VSIReadDirRecursive(zipVsi.c_str());
@@ -262,602 +869,5566 @@ static std::string pickGdbInsideZip(const std::string& zipVsi) {
     return gdbPath;
 }
 
-// recursively copy directory contents to ZIP
-static void copyDirToZip(const std::string& srcDir, const std::string& zipPath, const std::string& zipPrefix) {
-    char** fileList = VSIReadDirRecursive(srcDir.c_str());
-    if (!fileList) return;
+// check for a ZIP signature (PK\x03\x04 or PK\x05\x06), used to tell KMZ from KML
+static bool hasZipSignature(const GByte* data, size_t size) {
+    return size >= 4 && data[0] == 'P' && data[1] == 'K' &&
+           (data[2] == 0x03 || data[2] == 0x05);
+}
 
-    for (int i = 0; fileList[i] != nullptr; i++) {
-        std::string relPath = fileList[i];
-        std::string srcPath = srcDir + "/" + relPath;
-        std::string dstPath = "/vsizip/" + zipPath + "/" + zipPrefix + "/" + relPath;
+// extension the raw input file is exposed under (archives are opened through /vsizip/)
+static std::string inputFileExtension(const std::string& inFmt, bool zipSignature) {
+    if (inFmt == "shapefile" || inFmt == "mapinfo" || inFmt == "openfilegdb") return ".zip";
+    if (inFmt == "kml") return zipSignature ? ".kmz" : ".kml";
+    std::string inputExt = getExtensionFromFormat(inFmt);
+    if (inputExt == ".zip") inputExt = ".dat"; // non-shp should not be zip here
+    return inputExt;
+}
 
-        // Check if it's a file (not a directory)
-        VSIStatBufL statBuf;
-        if (VSIStatL(srcPath.c_str(), &statBuf) == 0 && !VSI_ISDIR(statBuf.st_mode)) {
-            vsi_l_offset nBytes = 0;
-            GByte* fileData = VSIGetMemFileBuffer(srcPath.c_str(), &nBytes, FALSE);
-            if (fileData && nBytes > 0) {
-                VSILFILE* fpOut = VSIFOpenL(dstPath.c_str(), "wb");
-                if (fpOut) {
-                    VSIFWriteL(fileData, 1, nBytes, fpOut);
-                    VSIFCloseL(fpOut);
-                }
-            }
-        }
+// path GDAL should open for a raw input file named with inputFileExtension()
+static std::string resolveInputPath(const std::string& filePath, const std::string& inFmt) {
+    std::string inputPath;
+    if (inFmt == "shapefile") {
+        inputPath = pickShpInsideZip("/vsizip/" + filePath);
+        if (inputPath.empty()) throw std::runtime_error("No .shp found in input ZIP");
+    } else if (inFmt == "kml" && toLower(filePath.substr(filePath.size() - 4)) == ".kmz") {
+        inputPath = pickKmlInsideZip("/vsizip/" + filePath);
+        if (inputPath.empty()) throw std::runtime_error("No .kml found in KMZ archive");
+    } else if (inFmt == "mapinfo") {
+        // MapInfo TAB format - handle as ZIP
+        inputPath = pickTabInsideZip("/vsizip/" + filePath);
+        if (inputPath.empty()) throw std::runtime_error("No .tab found in input ZIP");
+    } else if (inFmt == "openfilegdb") {
+        inputPath = pickGdbInsideZip("/vsizip/" + filePath);
+        if (inputPath.empty()) throw std::runtime_error("No .gdb folder found in input ZIP");
+    } else {
+        inputPath = filePath;
     }
-    CSLDestroy(fileList);
+    return inputPath;
 }
 
-// small wrapper for GDALVectorTranslate
-static GDALDataset* runVectorTranslate(GDALDataset* src, const std::string& dstPath, const std::vector<std::string>& argvVec) {
-    std::vector<char*> argv; argv.reserve(argvVec.size()+1);
-    for (auto& s : argvVec) argv.push_back(const_cast<char*>(s.c_str()));
-    argv.push_back(nullptr);
-    GDALVectorTranslateOptions* opts = GDALVectorTranslateOptionsNew(argv.data(), nullptr);
-    GDALDataset* out = (GDALDataset*)GDALVectorTranslate(dstPath.c_str(), nullptr, 1, (GDALDatasetH*)&src, opts, nullptr);
-    GDALVectorTranslateOptionsFree(opts);
-    return out;
+// expose the input bytes as a /vsimem file (no copy) and return the path GDAL should open;
+// memFile receives the /vsimem file to unlink once the dataset is closed. With adoptBuffer
+// the VSIMalloc'd bytes are owned by that file and freed when it is unlinked.
+static std::string materializeInput(const GByte* data, size_t size,
+                                    const std::string& inFmt,
+                                    const std::string& basePath,
+                                    std::string& memFile,
+                                    bool adoptBuffer = false)
+{
+    const std::string path = basePath + inputFileExtension(inFmt, hasZipSignature(data, size));
+    VSILFILE* fp = VSIFileFromMemBuffer(path.c_str(),
+                                        const_cast<GByte*>(data),
+                                        static_cast<vsi_l_offset>(size),
+                                        adoptBuffer ? TRUE : FALSE);
+    if (!fp) throw std::runtime_error("Failed to create input virtual file");
+    VSIFCloseL(fp);
+    memFile = path;
+
+    return resolveInputPath(path, inFmt);
 }
 
-// count features of certain OGR_GEOMETRY categories in a layer
-static GIntBig countGeomWhere(GDALDataset* ds, const std::string& layerName, const std::string& where) {
-    std::string sql = "SELECT COUNT(*) FROM \"" + layerName + "\"";
-    if (!where.empty()) sql += " WHERE " + where;
-    OGRLayer* lyr = ds->ExecuteSQL(sql.c_str(), nullptr, nullptr);
-    GIntBig cnt = 0;
-    if (lyr) {
-        OGRFeature* f = lyr->GetNextFeature();
-        if (f) {
-            // the COUNT(*) is at index 0
-            cnt = f->GetFieldAsInteger64(0);
-            OGRFeature::DestroyFeature(f);
-        }
-        ds->ReleaseResultSet(lyr);
+// fail with `error` unless the /vsimem file exists and holds some bytes
+static void requireMemFile(const std::string& path, const char* error) {
+    vsi_l_offset n = 0;
+    GByte* buf = VSIGetMemFileBuffer(path.c_str(), &n, FALSE);
+    if (!buf || n == 0) {
+        VSIUnlink(path.c_str());
+        throw std::runtime_error(error);
     }
-    return cnt;
 }
 
-// decide CRS args: transform or assign
-// User-provided CRS always takes priority over file's embedded CRS
-static void pushCrsArgs(std::vector<std::string>& args,
-                        GDALDataset* src,
-                        const std::string& sourceCrs,
-                        const std::string& targetCrs)
-{
-    const bool haveSrc = !sourceCrs.empty();
-    const bool haveDst = !targetCrs.empty();
+// every call works in its own /vsimem/job-<id>/ directory, which is removed
+// (with whatever is left in it) when the scope ends, on success or failure
+static std::mutex g_jobsMutex;
+static int g_nextJobId = 1;
 
-    // Case 1: User specified both source and target CRS
-    if (haveSrc && haveDst && sourceCrs != targetCrs) {
-        // Transform: override file's CRS with user's source CRS, then reproject to target
-        args.insert(args.end(), {"-s_srs", sourceCrs, "-t_srs", targetCrs});
-        return;
-    }
+struct JobScope {
+    std::string dir;
 
-    // Case 2: User specified only source CRS (no target)
-    if (haveSrc && !haveDst) {
-        // Assign/override: tell GDAL the data is in this CRS (user knows better than auto-detect)
-        args.insert(args.end(), {"-a_srs", sourceCrs});
-        return;
+    JobScope() {
+        std::lock_guard<std::mutex> lock(g_jobsMutex);
+        dir = "/vsimem/job-" + std::to_string(g_nextJobId++);
     }
+    ~JobScope() { VSIRmdirRecursive(dir.c_str()); }
+    JobScope(const JobScope&) = delete;
+    JobScope& operator=(const JobScope&) = delete;
 
-    // Case 3: User specified only target CRS (no source)
-    if (haveDst && !haveSrc) {
-        // Check if file has embedded CRS
-        OGRLayer* L0 = src->GetLayerCount() > 0 ? src->GetLayer(0) : nullptr;
-        OGRSpatialReference* srs = L0 ? L0->GetSpatialRef() : nullptr;
+    std::string path(const std::string& name) const { return dir + "/" + name; }
+};
 
-        if (srs == nullptr) {
-            // No CRS in file: assign the target CRS
-            args.insert(args.end(), {"-a_srs", targetCrs});
-        } else {
-            // File has CRS: transform from auto-detected to target
-            args.insert(args.end(), {"-t_srs", targetCrs});
-        }
-    }
+struct DatasetCloser {
+    void operator()(GDALDataset* ds) const { if (ds) GDALClose(ds); }
+};
+typedef std::unique_ptr<GDALDataset, DatasetCloser> DatasetPtr;
 
-    // Case 4: No user CRS specified - let GDAL auto-detect (do nothing)
+static GDALDataset* openVectorDataset(const std::string& path) {
+    GDALDataset* ds = (GDALDataset*)GDALOpenEx(
+        path.c_str(), GDAL_OF_VECTOR | GDAL_OF_READONLY, nullptr, nullptr, nullptr
+    );
+    if (!ds) throw std::runtime_error("Failed to open input dataset");
+    return ds;
 }
 
-static void pushDriverLCO(std::vector<std::string>& args, const std::string& driver, int geojsonPrecision, const std::string& csvGeometryMode) {
-    if (driver == "ESRI Shapefile") {
-        args.insert(args.end(), {"-lco", "ENCODING=UTF-8"});
-    } else if (driver == "GeoJSON" || driver == "TopoJSON") {
-        args.insert(args.end(), {"-lco", "WRITE_BBOX=YES"});
-        args.insert(args.end(), {"-lco", "COORDINATE_PRECISION=" + std::to_string(geojsonPrecision)});
-    } else if (driver == "GPKG") {
-        args.insert(args.end(), {"-lco", "SPATIAL_INDEX=YES"});
-    } else if (driver == "CSV") {
-        // CSV geometry mode: AS_WKT (default) or AS_XY
-        if (csvGeometryMode == "XY") {
-            args.insert(args.end(), {"-lco", "GEOMETRY=AS_XY"});
+// ----------------- streaming geojson -----------------
+// Large GeoJSON/GeoJSONSeq inputs are read by a streaming layer instead of the
+// stock driver: a structural scan (8 bytes at a time) cuts the document into one
+// feature object at a time, so memory is bounded by the read buffer plus the
+// largest feature. A first pass builds the schema and counts the features,
+// following the driver's rules (dates, lists, the layer name, string ids);
+// inputs whose schema those rules do not cover here are left to the driver.
+
+// inputs at least this large are streamed; smaller ones keep the GDAL driver.
+// The GEOCONVERTER_STREAMING_GEOJSON_MIN_SIZE config option overrides it (tests).
+static const vsi_l_offset STREAMING_GEOJSON_MIN_SIZE = 64 * 1024 * 1024;
+static const size_t STREAMING_READ_SIZE = 1024 * 1024;
+
+// bit 7 of each byte of w that equals c; the lowest set bit is always a true match
+static inline uint64_t swarMatch(uint64_t w, unsigned char c) {
+    const uint64_t x = w ^ (0x0101010101010101ULL * c);
+    return (x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL;
+}
+
+class GeoJsonFeatureScanner {
+public:
+    GeoJsonFeatureScanner(VSILFILE* fp, bool sequence) : fp_(fp), sequence_(sequence), buf_(STREAMING_READ_SIZE) {}
+
+    // next feature object as text; false at the end of the features or on a syntax error
+    bool next(std::string& text) {
+        if (state_ == DONE || state_ == FAILED) return false;
+        if (state_ == START) {
+            if (!sequence_ && !enterFeatures()) return false;
+            state_ = FEATURES;
+        }
+
+        skipSpace();
+        int c = get();
+        if (sequence_) {
+            if (c < 0) return finish();
         } else {
-            args.insert(args.end(), {"-lco", "GEOMETRY=AS_WKT"});
+            if (c == ',' && seenFeature_) {
+                skipSpace();
+                c = get();
+            } else if (c == ']') {
+                // members may follow the features (e.g. "crs" written last)
+                return readMembers() && finish();
+            }
         }
+        if (c != '{') return fail();
+
+        text.assign(1, '{');
+        if (!captureNested(text)) return fail();
+        seenFeature_ = true;
+        return true;
     }
-}
 
-// where clauses for geometry families (including 3D variants for GPX and other formats)
-static const char* WHERE_POINT       = "OGR_GEOMETRY IN ('POINT', 'POINT Z', 'POINT M', 'POINT ZM', 'POINT25D')";
-static const char* WHERE_MULTIPOINT  = "OGR_GEOMETRY IN ('MULTIPOINT', 'MULTIPOINT Z', 'MULTIPOINT M', 'MULTIPOINT ZM', 'MULTIPOINT25D')";
-static const char* WHERE_LINES       = "OGR_GEOMETRY IN ('LINESTRING', 'LINESTRING Z', 'LINESTRING M', 'LINESTRING ZM', 'LINESTRING25D', 'MULTILINESTRING', 'MULTILINESTRING Z', 'MULTILINESTRING M', 'MULTILINESTRING ZM', 'MULTILINESTRING25D')";
-static const char* WHERE_POLYS       = "OGR_GEOMETRY IN ('POLYGON', 'POLYGON Z', 'POLYGON M', 'POLYGON ZM', 'POLYGON25D', 'MULTIPOLYGON', 'MULTIPOLYGON Z', 'MULTIPOLYGON M', 'MULTIPOLYGON ZM', 'MULTIPOLYGON25D')";
+    bool failed() const { return state_ == FAILED; }
+    const std::string& crsText() const { return crs_; }
+    const std::string& nameText() const { return name_; }
 
-// optional single-family where for non-SHP outputs (user-provided filter)
-static std::string whereFromFilter(const std::string& filter) {
-    auto f = toLower(filter);
-    if (f == "point" || f == "points") return WHERE_POINT;
-    if (f == "multipoint" || f == "multi-point") return WHERE_MULTIPOINT;
-    if (f == "line" || f == "lines" || f == "linestring") return WHERE_LINES;
-    if (f == "polygon" || f == "polygons") return WHERE_POLYS;
-    return std::string();
-}
+private:
+    enum State { START, FEATURES, DONE, FAILED };
 
-static bool transformExtentToWgs84(const OGREnvelope& extent,
-                                   const std::string& sourceCrs,
-                                   double& minX,
-                                   double& minY,
-                                   double& maxX,
-                                   double& maxY,
-                                   std::string& debugInfo)
-{
-    if (sourceCrs.empty()) {
-        debugInfo += "Source CRS is empty; ";
-        return false;
+    bool fill() {
+        if (eof_) return false;
+        const size_t n = VSIFReadL(buf_.data(), 1, buf_.size(), fp_);
+        pos_ = 0;
+        end_ = n;
+        if (n < buf_.size()) eof_ = true;
+        return n > 0;
+    }
+    int get() {
+        if (pos_ == end_ && !fill()) return -1;
+        return static_cast<unsigned char>(buf_[pos_++]);
+    }
+    int peek() {
+        if (pos_ == end_ && !fill()) return -1;
+        return static_cast<unsigned char>(buf_[pos_]);
+    }
+    void skipSpace() {
+        for (int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == 0x1E; c = peek()) pos_++;
+    }
+    bool finish() { state_ = DONE; return false; }
+    bool fail() { state_ = FAILED; return false; }
+
+    // first byte at or after pos_ that is a quote or backslash (inString) or a
+    // quote or bracket (otherwise); end_ when there is none in the buffer.
+    // Words are loaded little-endian (WASM), so the lowest match is the first byte.
+    size_t scanStructural(size_t i, bool inString) const {
+        for (; i + 8 <= end_; i += 8) {
+            uint64_t w;
+            memcpy(&w, buf_.data() + i, 8);
+            const uint64_t m = inString
+                ? swarMatch(w, '"') | swarMatch(w, '\\')
+                : swarMatch(w, '"') | swarMatch(w, '{') | swarMatch(w, '}') | swarMatch(w, '[') | swarMatch(w, ']');
+            if (m) return i + (__builtin_ctzll(m) >> 3);
+        }
+        for (; i < end_; i++) {
+            const char c = buf_[i];
+            if (c == '"' || (inString ? c == '\\' : (c == '{' || c == '}' || c == '[' || c == ']'))) return i;
+        }
+        return end_;
     }
 
-    debugInfo += "Using source CRS: " + sourceCrs + "; ";
+    // copy the rest of an object/array whose opening bracket is already in text
+    bool captureNested(std::string& text) {
+        int depth = 1;
+        bool inString = false;
+        while (true) {
+            if (pos_ == end_ && !fill()) return false;
+            const size_t stop = scanStructural(pos_, inString);
+            text.append(buf_.data() + pos_, stop - pos_);
+            pos_ = stop;
+            if (pos_ == end_) continue;
+
+            const char c = buf_[pos_++];
+            text += c;
+            if (inString) {
+                if (c == '"') {
+                    inString = false;
+                } else {
+                    const int escaped = get();   // the byte after a backslash
+                    if (escaped < 0) return false;
+                    text += static_cast<char>(escaped);
+                }
+            } else if (c == '"') {
+                inString = true;
+            } else if (c == '{' || c == '[') {
+                depth++;
+            } else if (--depth == 0) {
+                return true;
+            }
+        }
+    }
 
-    // Quick check: if the CRS string indicates WGS84/EPSG:4326, skip transformation
-    std::string lowerCrs = toLower(sourceCrs);
-    if (lowerCrs == "epsg:4326" ||
-        lowerCrs == "wgs84" ||
-        lowerCrs == "wgs 84" ||
-        lowerCrs.find("wgs84") != std::string::npos ||
-        lowerCrs.find("wgs 84") != std::string::npos) {
-        debugInfo += "Already WGS84 (detected from CRS string), skipping; ";
-        return false;
+    // a top-level value (string, object, array or literal) as text
+    bool captureValue(std::string& text) {
+        skipSpace();
+        const int c = get();
+        if (c < 0) return false;
+        text.assign(1, static_cast<char>(c));
+        if (c == '{' || c == '[') return captureNested(text);
+        if (c == '"') {
+            for (int d = get(); ; d = get()) {
+                if (d < 0) return false;
+                text += static_cast<char>(d);
+                if (d == '\\') {
+                    const int escaped = get();
+                    if (escaped < 0) return false;
+                    text += static_cast<char>(escaped);
+                } else if (d == '"') {
+                    return true;
+                }
+            }
+        }
+        for (int d = peek(); d >= 0 && d != ',' && d != '}' && d != ']' && !isspace(d); d = peek()) {
+            text += static_cast<char>(d);
+            pos_++;
+        }
+        return true;
     }
 
-    OGRSpatialReference srcSrs;
-    OGRErr err = srcSrs.SetFromUserInput(sourceCrs.c_str());
-    if (err != OGRERR_NONE) {
-        debugInfo += "SetFromUserInput failed (error " + std::to_string(err) + "); ";
-        return false;
+    // one member of the top-level object; sets key to "" at the closing brace
+    bool readMember(std::string& key) {
+        skipSpace();
+        int c = get();
+        if (c == ',') {
+            skipSpace();
+            c = get();
+        }
+        if (c == '}') {
+            key.clear();
+            return true;
+        }
+        if (c != '"') return false;
+
+        pos_--;
+        if (!captureValue(key) || key.size() < 2) return false;
+        key = key.substr(1, key.size() - 2);
+        skipSpace();
+        return get() == ':';
     }
-    srcSrs.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
 
-    OGRSpatialReference wgs84;
-    wgs84.SetWellKnownGeogCS("WGS84");
-    wgs84.SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+    // skip to the "features" array of a FeatureCollection, keeping "crs"
+    bool enterFeatures() {
+        skipSpace();
+        if (peek() == 0xEF) {   // UTF-8 BOM
+            get(); get(); get();
+            skipSpace();
+        }
+        if (get() != '{') return fail();
+
+        std::string key, value;
+        while (readMember(key)) {
+            if (key.empty()) return finish();   // no features
+            if (key == "features") {
+                skipSpace();
+                return get() == '[' ? true : fail();
+            }
+            if (!captureValue(value)) break;
+            if (key == "crs") crs_ = value;
+            if (key == "name") name_ = value;
+            if (key == "type" && value != "\"FeatureCollection\"") break;
+        }
+        return fail();
+    }
 
-    if (srcSrs.IsSame(&wgs84)) {
-        debugInfo += "Already WGS84, skipping; ";
-        return false;
+    bool readMembers() {
+        std::string key, value;
+        while (readMember(key)) {
+            if (key.empty()) return true;
+            if (!captureValue(value)) break;
+            if (key == "crs") crs_ = value;
+            if (key == "name") name_ = value;
+        }
+        return fail();
     }
 
-    struct SamplePoint {
-        double x;
-        double y;
-    };
-
-    const int steps = 8;
-    std::vector<SamplePoint> points;
-    points.reserve((steps + 1) * 4);
-    auto addEdge = [&](double x0, double y0, double x1, double y1) {
-        for (int i = 0; i <= steps; ++i) {
-            double t = static_cast<double>(i) / steps;
-            points.push_back({x0 + (x1 - x0) * t, y0 + (y1 - y0) * t});
-        }
-    };
+    VSILFILE* fp_;
+    bool sequence_;
+    std::vector<char> buf_;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+    bool eof_ = false;
+    State state_ = START;
+    bool seenFeature_ = false;
+    std::string crs_;
+    std::string name_;      // the collection's "name" member, as JSON text
+};
+
+// field types as the GeoJSON driver infers them (ogrgeojsonreader.cpp):
+// ISO dates and times become Date/DateTime/Time, homogeneous arrays lists,
+// other arrays and objects JSON strings
+struct StreamField {
+    std::string name;
+    OGRFieldType type = OFTString;
+    OGRFieldSubType subType = OFSTNone;
+    bool typed = false;
+};
+
+static bool isListFieldType(OGRFieldType t) {
+    return t == OFTIntegerList || t == OFTInteger64List || t == OFTRealList || t == OFTStringList;
+}
 
-    addEdge(extent.MinX, extent.MinY, extent.MaxX, extent.MinY); // bottom
-    addEdge(extent.MaxX, extent.MinY, extent.MaxX, extent.MaxY); // right
-    addEdge(extent.MaxX, extent.MaxY, extent.MinX, extent.MaxY); // top
-    addEdge(extent.MinX, extent.MaxY, extent.MinX, extent.MinY); // left
+static bool isTemporalFieldType(OGRFieldType t) {
+    return t == OFTDate || t == OFTTime || t == OFTDateTime;
+}
 
-    std::unique_ptr<OGRCoordinateTransformation, decltype(&OCTDestroyCoordinateTransformation)> transform(
-        OGRCreateCoordinateTransformation(&srcSrs, &wgs84),
-        OCTDestroyCoordinateTransformation
-    );
+static OGRFieldType streamStringType(const std::string& s) {
+    OGRField parsed;
+    CPLPushErrorHandler(CPLQuietErrorHandler);
+    const int isDate = OGRParseDate(s.c_str(), &parsed, 0);
+    CPLPopErrorHandler();
+    CPLErrorReset();
+    if (!isDate) return OFTString;
+    const bool hasDate = s.find_first_of("-/") != std::string::npos;
+    const bool hasTime = s.find(':') != std::string::npos;
+    if (hasDate && hasTime) return OFTDateTime;
+    return hasDate ? OFTDate : OFTTime;
+}
 
-    if (!transform) {
-        debugInfo += "OGRCreateCoordinateTransformation failed; ";
-        return false;
+static OGRFieldType streamArrayType(const CPLJSONArray& arr, OGRFieldSubType& subType) {
+    subType = OFSTNone;
+    if (arr.Size() == 0) {
+        subType = OFSTJSON;
+        return OFTString;
     }
-
-    for (size_t i = 0; i < points.size(); ++i) {
-        double x = points[i].x;
-        double y = points[i].y;
-        if (!transform->Transform(1, &x, &y)) {
-            debugInfo += "OGR transform failed at point " + std::to_string(i) + "; ";
-            return false;
+    OGRFieldType type = OFTIntegerList;
+    for (int i = 0; i < arr.Size(); i++) {
+        const CPLJSONObject v = arr[i];
+        switch (v.GetType()) {
+            case CPLJSONObject::Type::String:
+                if (i == 0 || type == OFTStringList) {
+                    type = OFTStringList;
+                    continue;
+                }
+                break;
+            case CPLJSONObject::Type::Double:
+                if (subType == OFSTNone && (i == 0 || type != OFTStringList)) {
+                    type = OFTRealList;
+                    continue;
+                }
+                break;
+            case CPLJSONObject::Type::Integer:
+            case CPLJSONObject::Type::Long:
+                if (subType == OFSTNone && type != OFTStringList) {
+                    const GIntBig n = v.ToLong();
+                    if (type == OFTIntegerList && n != static_cast<int>(n)) type = OFTInteger64List;
+                    continue;
+                }
+                break;
+            case CPLJSONObject::Type::Boolean:
+                if (i == 0 || (type == OFTIntegerList && subType == OFSTBoolean)) {
+                    subType = OFSTBoolean;
+                    continue;
+                }
+                break;
+            default:
+                break;
         }
-        points[i].x = x;
-        points[i].y = y;
+        subType = OFSTJSON;   // mixed, nested or null members
+        return OFTString;
+    }
+    return type;
+}
+
+// type of one JSON value; false for null, which says nothing about the type
+static bool streamValueType(const CPLJSONObject& v, OGRFieldType& type, OGRFieldSubType& subType) {
+    subType = OFSTNone;
+    switch (v.GetType()) {
+        case CPLJSONObject::Type::Boolean: type = OFTInteger; subType = OFSTBoolean; return true;
+        case CPLJSONObject::Type::Integer: type = OFTInteger; return true;
+        case CPLJSONObject::Type::Long:    type = OFTInteger64; return true;
+        case CPLJSONObject::Type::Double:  type = OFTReal; return true;
+        case CPLJSONObject::Type::String:  type = streamStringType(v.ToString()); return true;
+        case CPLJSONObject::Type::Array:   type = streamArrayType(v.ToArray(), subType); return true;
+        case CPLJSONObject::Type::Object:  type = OFTString; subType = OFSTJSON; return true;
+        default: return false;
     }
+}
 
-    auto minMaxX = std::minmax_element(points.begin(), points.end(),
-        [](const SamplePoint& a, const SamplePoint& b) { return a.x < b.x; });
-    auto minMaxY = std::minmax_element(points.begin(), points.end(),
-        [](const SamplePoint& a, const SamplePoint& b) { return a.y < b.y; });
-    minX = minMaxX.first->x;
-    maxX = minMaxX.second->x;
-    minY = minMaxY.first->y;
-    maxY = minMaxY.second->y;
+// widen a field type for a new JSON value; false where the driver's rules for
+// the combination are not reproduced here (the input is left to the driver)
+static bool mergeStreamFieldType(StreamField& f, const CPLJSONObject& v) {
+    OGRFieldType type;
+    OGRFieldSubType subType;
+    if (!streamValueType(v, type, subType)) return true;
+
+    if (!f.typed) {
+        f.type = type;
+        f.subType = subType;
+        f.typed = true;
+        return true;
+    }
+    if (f.type == type) {
+        if (f.subType == subType) return true;
+        if (f.subType == OFSTJSON || subType == OFSTJSON) return false;
+        f.subType = OFSTNone;
+        return true;
+    }
+    if (f.subType == OFSTJSON || subType == OFSTJSON) return false;
+
+    const bool list = isListFieldType(f.type);
+    if (list || isListFieldType(type)) {
+        if (!list || !isListFieldType(type) || f.type == OFTStringList || type == OFTStringList) return false;
+        f.type = (f.type == OFTRealList || type == OFTRealList) ? OFTRealList : OFTInteger64List;
+        f.subType = OFSTNone;
+        return true;
+    }
 
-    debugInfo += "OGR reprojection successful; ";
+    const bool numeric = (f.type == OFTInteger || f.type == OFTInteger64 || f.type == OFTReal);
+    const bool newNumeric = (type == OFTInteger || type == OFTInteger64 || type == OFTReal);
+    if (numeric && newNumeric) {
+        f.type = (f.type == OFTReal || type == OFTReal) ? OFTReal : OFTInteger64;
+    } else if ((f.type == OFTDate && type == OFTDateTime) || (f.type == OFTDateTime && type == OFTDate)) {
+        f.type = OFTDateTime;
+    } else {
+        f.type = OFTString;
+    }
+    f.subType = OFSTNone;
     return true;
 }
 
-// ----------------- main API -----------------
-std::string Native::getVectorInfo(
-    const std::vector<uint8_t>& inputData,
-    const std::string& inputFormat,
-    const std::string& sourceCrs
-) {
-    GDALAllRegister();
-    resetLastError();
+// envelope of the positions under a GeoJSON coordinates array
+static void mergeGeoJsonPositions(const CPLJSONObject& coords, OGREnvelope& env) {
+    if (coords.GetType() != CPLJSONObject::Type::Array) return;
+    const CPLJSONArray arr = coords.ToArray();
+    if (arr.Size() >= 2 && arr[0].GetType() != CPLJSONObject::Type::Array) {
+        env.Merge(arr[0].ToDouble(), arr[1].ToDouble());
+        return;
+    }
+    for (int i = 0; i < arr.Size(); i++) mergeGeoJsonPositions(arr[i], env);
+}
 
-    // Set PROJ data path for WebAssembly/Emscripten environment
-    // Try common paths where cpp.js might mount the PROJ data
-    const char* projPaths[] = {
-        "/proj",
-        "/usr/share/proj",
-        "/data/proj",
-        "/opt/proj/share/proj",
-        nullptr
-    };
+// envelope of a GeoJSON geometry object, without building the geometry
+static void mergeGeoJsonEnvelope(const CPLJSONObject& geom, OGREnvelope& env) {
+    const CPLJSONArray members = geom.GetArray("geometries");
+    if (members.IsValid()) {
+        for (int i = 0; i < members.Size(); i++) mergeGeoJsonEnvelope(members[i], env);
+        return;
+    }
+    mergeGeoJsonPositions(geom.GetObj("coordinates"), env);
+}
 
-    for (const char** path = projPaths; *path != nullptr; ++path) {
-        VSIStatBufL statBuf;
-        if (VSIStatL(*path, &statBuf) == 0) {
-            CPLSetConfigOption("PROJ_LIB", *path);
-            break;
-        }
+class GeoJsonStreamLayer : public OGRLayer {
+public:
+    // name is used unless the collection has a "name" member, as with the driver
+    GeoJsonStreamLayer(VSILFILE* fp, bool sequence, const std::string& name)
+        : fp_(fp), sequence_(sequence), name_(name) {
+        scanner_.reset(new GeoJsonFeatureScanner(fp_, sequence_));
     }
 
-    // Enable debug output
-    CPLSetConfigOption("CPL_DEBUG", "ON");
+    ~GeoJsonStreamLayer() override {
+        if (defn_) defn_->Release();
+        if (srs_) srs_->Release();
+        VSIFCloseL(fp_);
+    }
 
-    CPLPushErrorHandler(ErrHandler);
+    // first pass: schema, geometry type, CRS and feature count; false when the
+    // input is not a feature collection/sequence or its schema would differ
+    // from the driver's (the caller falls back to GDAL)
+    bool scanSchema() {
+        // the schema scratch lives in the call's arena; text stays a std::string
+        // for CPLJSONDocument
+        ArenaVector<StreamField> fields;
+        std::map<std::string, size_t, std::less<std::string>,
+                 ArenaAllocator<std::pair<const std::string, size_t>>> fieldIndex;
+        OGRwkbGeometryType geomType = wkbNone;
+        bool firstGeometry = true;
+        // the driver adds the "id" field where the first feature with an id is
+        size_t idPos = std::string::npos;
+
+        std::string text;
+        CPLJSONDocument doc;
+        while (scanner_->next(text)) {
+            if (!doc.LoadMemory(text)) return false;
+            const CPLJSONObject root = doc.GetRoot();
+            if (root.GetString("type") != "Feature") return false;
+
+            const CPLJSONObject id = root.GetObj("id");
+            if (id.IsValid()) {
+                if (idPos == std::string::npos) idPos = fields.size();
+                if (id.GetType() != CPLJSONObject::Type::Integer && id.GetType() != CPLJSONObject::Type::Long) {
+                    stringIds_ = true;
+                }
+            }
 
-    std::string result = "{}";
-    VSILFILE* fpIn = nullptr;
+            for (const CPLJSONObject& v : root.GetObj("properties").GetChildren()) {
+                auto it = fieldIndex.find(v.GetName());
+                if (it == fieldIndex.end()) {
+                    it = fieldIndex.emplace(v.GetName(), fields.size()).first;
+                    fields.push_back(StreamField());
+                    fields.back().name = v.GetName();
+                }
+                if (!mergeStreamFieldType(fields[it->second], v)) return false;
+            }
 
-    try {
-        // Materialize input in /vsimem
-        std::string inputPath;
-        const std::string inFmt = toLower(inputFormat);
-
-        if (inFmt == "shapefile") {
-            const std::string zipPath = "/vsimem/preview_input.zip";
-            fpIn = VSIFileFromMemBuffer(zipPath.c_str(),
-                                        const_cast<GByte*>(inputData.data()),
-                                        static_cast<vsi_l_offset>(inputData.size()),
-                                        FALSE);
-            if (!fpIn) throw std::runtime_error("Failed to create input ZIP file");
-            VSIFCloseL(fpIn); fpIn = nullptr;
-
-            const std::string zipVsi = "/vsizip/" + zipPath;
-            inputPath = pickShpInsideZip(zipVsi);
-            if (inputPath.empty()) throw std::runtime_error("No .shp found in input ZIP");
-        } else if (inFmt == "kml") {
-            // Check if input is a KMZ (zipped KML) by looking for ZIP signature
-            bool isKmz = false;
-            if (inputData.size() >= 4) {
-                // Check for ZIP magic number (PK\x03\x04 or PK\x05\x06)
-                isKmz = (inputData[0] == 'P' && inputData[1] == 'K' &&
-                        (inputData[2] == 0x03 || inputData[2] == 0x05));
-            }
-
-            if (isKmz) {
-                const std::string zipPath = "/vsimem/preview_input.kmz";
-                fpIn = VSIFileFromMemBuffer(zipPath.c_str(),
-                                            const_cast<GByte*>(inputData.data()),
-                                            static_cast<vsi_l_offset>(inputData.size()),
-                                            FALSE);
-                if (!fpIn) throw std::runtime_error("Failed to create input KMZ file");
-                VSIFCloseL(fpIn); fpIn = nullptr;
-
-                const std::string zipVsi = "/vsizip/" + zipPath;
-                inputPath = pickKmlInsideZip(zipVsi);
-                if (inputPath.empty()) throw std::runtime_error("No .kml found in KMZ archive");
+            const CPLJSONObject geom = root.GetObj("geometry");
+            if (geom.IsValid() && geom.GetType() == CPLJSONObject::Type::Object) {
+                const OGRwkbGeometryType t = OGRFromOGCGeomType(geom.GetString("type").c_str());
+                geomType = firstGeometry ? t : (geomType == t ? t : wkbUnknown);
+                firstGeometry = false;
+            }
+            featureCount_++;
+        }
+        if (scanner_->failed()) return false;
+
+        // string ids share one String "id" field with properties.id (which
+        // wins where both are set), at the properties' position if it came first
+        if (stringIds_) {
+            auto it = fieldIndex.find("id");
+            if (it != fieldIndex.end() && fields[it->second].typed && fields[it->second].type != OFTString) {
+                return false;
+            }
+            if (it != fieldIndex.end() && it->second < idPos) {
+                idPos = it->second;
             } else {
-                // Regular KML file
-                inputPath = "/vsimem/preview_input.kml";
-                fpIn = VSIFileFromMemBuffer(inputPath.c_str(),
-                                            const_cast<GByte*>(inputData.data()),
-                                            static_cast<vsi_l_offset>(inputData.size()),
-                                            FALSE);
-                if (!fpIn) throw std::runtime_error("Failed to create input KML file");
-                VSIFCloseL(fpIn); fpIn = nullptr;
-            }
-        } else if (inFmt == "mapinfo") {
-            // MapInfo TAB format - handle as ZIP
-            const std::string zipPath = "/vsimem/preview_input.zip";
-            fpIn = VSIFileFromMemBuffer(zipPath.c_str(),
-                                        const_cast<GByte*>(inputData.data()),
-                                        static_cast<vsi_l_offset>(inputData.size()),
-                                        FALSE);
-            if (!fpIn) throw std::runtime_error("Failed to create input ZIP file");
-            VSIFCloseL(fpIn); fpIn = nullptr;
-
-            const std::string zipVsi = "/vsizip/" + zipPath;
-            inputPath = pickTabInsideZip(zipVsi);
-            if (inputPath.empty()) throw std::runtime_error("No .tab found in input ZIP");
-        } else if (inFmt == "openfilegdb") {
-            const std::string zipPath = "/vsimem/preview_input.zip";
-            fpIn = VSIFileFromMemBuffer(zipPath.c_str(),
-                                        const_cast<GByte*>(inputData.data()),
-                                        static_cast<vsi_l_offset>(inputData.size()),
-                                        FALSE);
-            if (!fpIn) throw std::runtime_error("Failed to create input ZIP file");
-            VSIFCloseL(fpIn); fpIn = nullptr;
-
-            const std::string zipVsi = "/vsizip/" + zipPath;
-            inputPath = pickGdbInsideZip(zipVsi);
-            if (inputPath.empty()) throw std::runtime_error("No .gdb folder found in input ZIP");
-        } else {
-            std::string inputExt = getExtensionFromFormat(inFmt);
-            if (inputExt == ".zip") inputExt = ".dat";
-            inputPath = "/vsimem/preview_input" + inputExt;
-            fpIn = VSIFileFromMemBuffer(inputPath.c_str(),
-                                        const_cast<GByte*>(inputData.data()),
-                                        static_cast<vsi_l_offset>(inputData.size()),
-                                        FALSE);
-            if (!fpIn) throw std::runtime_error("Failed to create input virtual file");
-            VSIFCloseL(fpIn); fpIn = nullptr;
+                if (it != fieldIndex.end()) fields.erase(fields.begin() + it->second);
+                fields.insert(fields.begin() + idPos, StreamField());
+                fields[idPos].name = "id";
+            }
+            fields[idPos].type = OFTString;
+            fields[idPos].subType = OFSTNone;
+            idField_ = static_cast<int>(idPos);
         }
 
-        // Open dataset
-        GDALDataset* poDS = (GDALDataset*)GDALOpenEx(
-            inputPath.c_str(), GDAL_OF_VECTOR | GDAL_OF_READONLY, nullptr, nullptr, nullptr
-        );
-        if (!poDS) throw std::runtime_error("Failed to open input dataset");
-
-        // Extract metadata using native GDAL API
-        std::string json = "{";
-
-        // Layer count
-        int layerCount = poDS->GetLayerCount();
-        json += "\"layers\":" + std::to_string(layerCount) + ",";
-
-        // Feature count from first layer
-        GIntBig featureCount = 0;
-        std::string geometryType = "Unknown";
-        std::string crs = "Unknown";
-        std::string properties = "[]";
-
-        if (layerCount > 0) {
-            OGRLayer* poLayer = poDS->GetLayer(0);
-            if (poLayer) {
-                // Feature count
-                featureCount = poLayer->GetFeatureCount();
-                json += "\"featureCount\":" + std::to_string(featureCount) + ",";
-
-                // Geometry type from layer definition
-                OGRwkbGeometryType geomType = poLayer->GetGeomType();
-                geometryType = OGRGeometryTypeToName(geomType);
-                json += "\"geometryType\":\"" + escapeJsonString(geometryType) + "\",";
-
-                // CRS/SRS - use user-provided sourceCrs if available, otherwise detect
-                OGRSpatialReference* srs = poLayer->GetSpatialRef();
-                std::unique_ptr<OGRSpatialReference> userSrs;
-
-                std::string debugInfo = "";
-
-                // Debug: Check PROJ_LIB setting
-                const char* projLib = CPLGetConfigOption("PROJ_LIB", nullptr);
-                if (projLib) {
-                    debugInfo += "PROJ_LIB=" + std::string(projLib) + "; ";
-                } else {
-                    debugInfo += "PROJ_LIB not set; ";
-                }
+        // the driver names the layer after the collection's "name" member
+        std::string layerName = name_;
+        if (!sequence_ && !scanner_->nameText().empty() && doc.LoadMemory(scanner_->nameText()) &&
+            doc.GetRoot().GetType() == CPLJSONObject::Type::String) {
+            layerName = doc.GetRoot().ToString();
+        }
+        defn_ = new OGRFeatureDefn(layerName.c_str());
+        defn_->Reference();
+        SetDescription(layerName.c_str());
+        for (const StreamField& f : fields) {
+            OGRFieldDefn fld(f.name.c_str(), f.type);
+            fld.SetSubType(f.subType);
+            defn_->AddFieldDefn(&fld);
+        }
+        for (int i = 0; i < defn_->GetFieldCount(); i++) {
+            fieldIndex_[defn_->GetFieldDefn(i)->GetNameRef()] = i;
+        }
+        defn_->SetGeomType(firstGeometry ? wkbUnknown : geomType);
+
+        // GeoJSON defaults to WGS84 longitude/latitude
+        srs_ = new OGRSpatialReference();
+        srs_->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+        std::string crsName;
+        if (!scanner_->crsText().empty() && doc.LoadMemory(scanner_->crsText())) {
+            crsName = doc.GetRoot().GetString("properties/name");
+        }
+        if (crsName.empty() || srs_->SetFromUserInput(crsName.c_str()) != OGRERR_NONE) {
+            srs_->SetWellKnownGeogCS("WGS84");
+        }
+        if (defn_->GetGeomFieldCount() > 0) defn_->GetGeomFieldDefn(0)->SetSpatialRef(srs_);
 
-                // If user provided a source CRS, use it for reprojection
-                if (!sourceCrs.empty()) {
-                    debugInfo += "User provided sourceCrs: " + sourceCrs + "; ";
-                    userSrs = std::make_unique<OGRSpatialReference>();
-
-                    OGRErr err = OGRERR_FAILURE;
-
-                    // Try to parse EPSG code and use importFromEPSG
-                    if (sourceCrs.find("EPSG:") == 0 || sourceCrs.find("epsg:") == 0) {
-                        try {
-                            int epsgCode = std::stoi(sourceCrs.substr(5));
-                            debugInfo += "Trying importFromEPSG(" + std::to_string(epsgCode) + "); ";
-                            err = userSrs->importFromEPSG(epsgCode);
-                            if (err != OGRERR_NONE) {
-                                debugInfo += "importFromEPSG failed (error " + std::to_string(err) + "); ";
-                            }
-                        } catch (...) {
-                            debugInfo += "Failed to parse EPSG code; ";
-                        }
-                    }
+        ResetReading();
+        return true;
+    }
 
-                    // If importFromEPSG failed or wasn't tried, try SetFromUserInput
-                    if (err != OGRERR_NONE) {
-                        debugInfo += "Trying SetFromUserInput; ";
-                        err = userSrs->SetFromUserInput(sourceCrs.c_str());
-                        if (err != OGRERR_NONE) {
-                            debugInfo += "SetFromUserInput failed (error " + std::to_string(err) + "); ";
-                        }
-                    }
+    void ResetReading() override {
+        VSIFSeekL(fp_, 0, SEEK_SET);
+        scanner_.reset(new GeoJsonFeatureScanner(fp_, sequence_));
+        nextFid_ = 0;
+    }
 
-                    if (err == OGRERR_NONE) {
-                        userSrs->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
-                        srs = userSrs.get();
-                        crs = sourceCrs; // Display what user selected
-                        debugInfo += "Successfully set user CRS; ";
-                    } else {
-                        debugInfo += "GDAL CRS methods failed, but will try PROJ for transform; ";
-                        // Don't reset - we'll still use sourceCrs for PROJ transformation
-                        // even though GDAL couldn't create an OGRSpatialReference from it
-                        crs = sourceCrs; // Display what user selected
-                        userSrs.reset();
-                    }
-                } else {
-                    debugInfo += "No sourceCrs provided; ";
-                }
+    OGRFeature* GetNextFeature() override {
+        while (scanner_->next(text_)) {
+            OGRFeature* f = parseFeature();
+            if (!f) continue;
+            if ((m_poFilterGeom == nullptr || FilterGeometry(f->GetGeometryRef())) &&
+                (m_poAttrQuery == nullptr || m_poAttrQuery->Evaluate(f))) {
+                return f;
+            }
+            delete f;
+        }
+        if (scanner_->failed()) {
+            CPLError(CE_Failure, CPLE_AppDefined, "GeoJSON syntax error after feature " CPL_FRMT_GIB, nextFid_);
+        }
+        return nullptr;
+    }
+
+    OGRFeatureDefn* GetLayerDefn() override { return defn_; }
+
+    GIntBig GetFeatureCount(int force) override {
+        if (m_poFilterGeom == nullptr && m_poAttrQuery == nullptr) return featureCount_;
+        return OGRLayer::GetFeatureCount(force);
+    }
+
+    int TestCapability(const char* cap) override {
+        if (EQUAL(cap, OLCFastFeatureCount)) return m_poFilterGeom == nullptr && m_poAttrQuery == nullptr;
+        return EQUAL(cap, OLCStringsAsUTF8);
+    }
+
+private:
+    OGRFeature* parseFeature() {
+        if (!doc_.LoadMemory(text_)) return nullptr;
+        const CPLJSONObject root = doc_.GetRoot();
+        const CPLJSONObject geom = root.GetObj("geometry");
+        const bool hasGeometry = geom.IsValid() && geom.GetType() == CPLJSONObject::Type::Object;
+
+        // there is no index: features outside a spatial filter are rejected on
+        // their coordinate envelope before any field or geometry is built
+        if (m_poFilterGeom != nullptr) {
+            OGREnvelope env;
+            if (hasGeometry) mergeGeoJsonEnvelope(geom, env);
+            if (!env.IsInit() || !env.Intersects(m_sFilterEnvelope)) {
+                nextFid_++;
+                return nullptr;
+            }
+        }
 
-                // If no user CRS was provided at all, use layer's CRS
-                if (sourceCrs.empty() && srs) {
-                    const char* authName = srs->GetAuthorityName(nullptr);
-                    const char* authCode = srs->GetAuthorityCode(nullptr);
-                    if (authName && authCode) {
-                        crs = std::string(authName) + ":" + std::string(authCode);
-                        debugInfo += "Using layer CRS: " + crs + "; ";
+        OGRFeature* f = new OGRFeature(defn_);
+        const CPLJSONObject id = root.GetObj("id");
+        if (stringIds_) {
+            if (id.IsValid()) f->SetField(idField_, id.GetType() == CPLJSONObject::Type::String
+                                                          ? id.ToString().c_str()
+                                                          : id.Format(CPLJSONObject::PrettyFormat::Plain).c_str());
+            f->SetFID(nextFid_);
+        } else {
+            f->SetFID(id.IsValid() ? id.ToLong() : nextFid_);
+        }
+        nextFid_++;
+
+        for (const CPLJSONObject& v : root.GetObj("properties").GetChildren()) {
+            auto it = fieldIndex_.find(v.GetName());
+            if (it == fieldIndex_.end()) continue;
+            const int i = it->second;
+            switch (v.GetType()) {
+                case CPLJSONObject::Type::Null:
+                    f->SetFieldNull(i);
+                    break;
+                case CPLJSONObject::Type::Boolean:
+                    if (defn_->GetFieldDefn(i)->GetType() == OFTString) f->SetField(i, v.ToBool() ? "true" : "false");
+                    else f->SetField(i, v.ToBool() ? 1 : 0);
+                    break;
+                case CPLJSONObject::Type::Integer:
+                case CPLJSONObject::Type::Long:
+                case CPLJSONObject::Type::Double:
+                    if (defn_->GetFieldDefn(i)->GetType() == OFTString) {
+                        f->SetField(i, v.Format(CPLJSONObject::PrettyFormat::Plain).c_str());
+                    } else if (defn_->GetFieldDefn(i)->GetType() == OFTReal) {
+                        f->SetField(i, v.ToDouble());
                     } else {
-                        char* wkt = nullptr;
-                        srs->exportToWkt(&wkt);
-                        if (wkt) {
-                            crs = std::string(wkt).substr(0, 50); // Truncate for brevity
-                            debugInfo += "Using layer CRS from WKT; ";
-                            CPLFree(wkt);
-                        }
+                        f->SetField(i, static_cast<GIntBig>(v.ToLong()));
                     }
-                }
-                json += "\"crs\":\"" + escapeJsonString(crs) + "\",";
-                json += "\"debugCrs\":\"" + escapeJsonString(debugInfo) + "\",";
-
-                // Bounding box (extent)
-                OGREnvelope extent;
-                if (poLayer->GetExtent(&extent, TRUE) == OGRERR_NONE) {
-                    // Store original bbox for debugging
-                    json += "\"bboxOriginal\":[";
-                    json += std::to_string(extent.MinX) + ",";
-                    json += std::to_string(extent.MinY) + ",";
-                    json += std::to_string(extent.MaxX) + ",";
-                    json += std::to_string(extent.MaxY);
-                    json += "],";
-
-                    double bboxMinX = extent.MinX;
-                    double bboxMinY = extent.MinY;
-                    double bboxMaxX = extent.MaxX;
-                    double bboxMaxY = extent.MaxY;
-
-                    // Determine which CRS to use for transformation
-                    // Prefer user-provided sourceCrs, otherwise use layer's CRS
-                    std::string transformSourceCrs = sourceCrs.empty() ? crs : sourceCrs;
-
-                    std::string transformDebug = "";
-                    const bool bboxReprojected = transformExtentToWgs84(
-                        extent,
-                        transformSourceCrs,
-                        bboxMinX,
-                        bboxMinY,
-                        bboxMaxX,
-                        bboxMaxY,
-                        transformDebug
-                    );
-
-                    if (bboxReprojected) {
-                        json += "\"bboxReprojected\":true,";
-                    } else {
-                        json += "\"bboxReprojected\":false,";
+                    break;
+                case CPLJSONObject::Type::String:
+                    f->SetField(i, v.ToString().c_str());
+                    break;
+                case CPLJSONObject::Type::Array:
+                    if (isListFieldType(defn_->GetFieldDefn(i)->GetType())) {
+                        setListField(f, i, v.ToArray());
+                        break;
                     }
+                    f->SetField(i, v.Format(CPLJSONObject::PrettyFormat::Plain).c_str());
+                    break;
+                default:
+                    f->SetField(i, v.Format(CPLJSONObject::PrettyFormat::Plain).c_str());
+            }
+        }
 
-                    json += "\"debugTransform\":\"" + escapeJsonString(transformDebug) + "\",";
+        if (hasGeometry) {
+            if (OGRGeometry* g = OGRGeometryFactory::createFromGeoJson(geom)) {
+                g->assignSpatialReference(srs_);
+                f->SetGeometryDirectly(g);
+            }
+        }
+        return f;
+    }
 
-                    json += "\"bbox\":[";
-                    json += std::to_string(bboxMinX) + ",";
-                    json += std::to_string(bboxMinY) + ",";
-                    json += std::to_string(bboxMaxX) + ",";
-                    json += std::to_string(bboxMaxY);
-                    json += "],";
-                }
+    void setListField(OGRFeature* f, int i, const CPLJSONArray& arr) {
+        const int n = arr.Size();
+        switch (defn_->GetFieldDefn(i)->GetType()) {
+            case OFTIntegerList: {
+                std::vector<int> values(n);
+                for (int k = 0; k < n; k++) values[k] = arr[k].GetType() == CPLJSONObject::Type::Boolean
+                                                            ? (arr[k].ToBool() ? 1 : 0) : arr[k].ToInteger();
+                f->SetField(i, n, values.data());
+                break;
+            }
+            case OFTInteger64List: {
+                std::vector<GIntBig> values(n);
+                for (int k = 0; k < n; k++) values[k] = arr[k].ToLong();
+                f->SetField(i, n, values.data());
+                break;
+            }
+            case OFTRealList: {
+                std::vector<double> values(n);
+                for (int k = 0; k < n; k++) values[k] = arr[k].ToDouble();
+                f->SetField(i, n, values.data());
+                break;
+            }
+            default: {
+                CPLStringList values;
+                for (int k = 0; k < n; k++) values.AddString(arr[k].ToString().c_str());
+                f->SetField(i, values.List());
+            }
+        }
+    }
 
-                // Properties from first feature
-                poLayer->ResetReading();
-                OGRFeature* poFeature = poLayer->GetNextFeature();
-                if (poFeature) {
-                    properties = "[";
-                    OGRFeatureDefn* poFDefn = poLayer->GetLayerDefn();
-                    int fieldCount = poFDefn->GetFieldCount();
-
-                    for (int i = 0; i < fieldCount; i++) {
-                        OGRFieldDefn* poFieldDefn = poFDefn->GetFieldDefn(i);
-                        std::string fieldName = poFieldDefn->GetNameRef();
-                        OGRFieldType fieldType = poFieldDefn->GetType();
-
-                        // Get field value
-                        std::string fieldValue = "null";
-                        std::string fieldTypeName = "String";
-
-                        if (!poFeature->IsFieldNull(i) && poFeature->IsFieldSet(i)) {
-                            switch (fieldType) {
-                                case OFTInteger:
-                                    fieldValue = std::to_string(poFeature->GetFieldAsInteger(i));
-                                    fieldTypeName = "Integer";
-                                    break;
-                                case OFTInteger64:
-                                    fieldValue = std::to_string(poFeature->GetFieldAsInteger64(i));
-                                    fieldTypeName = "Integer";
-                                    break;
-                                case OFTReal:
-                                    fieldValue = std::to_string(poFeature->GetFieldAsDouble(i));
-                                    fieldTypeName = "Float";
-                                    break;
-                                case OFTString:
-                                    fieldValue = "\"" + std::string(poFeature->GetFieldAsString(i)) + "\"";
-                                    fieldTypeName = "String";
-                                    break;
-                                case OFTDate:
-                                case OFTDateTime:
-                                    fieldValue = "\"" + std::string(poFeature->GetFieldAsString(i)) + "\"";
-                                    fieldTypeName = "Date";
-                                    break;
-                                default:
-                                    fieldValue = "\"" + std::string(poFeature->GetFieldAsString(i)) + "\"";
-                                    fieldTypeName = "String";
-                                    break;
-                            }
-                        }
-
-                        if (i > 0) properties += ",";
-                        properties += "{";
-                        properties += "\"name\":\"" + fieldName + "\",";
-                        properties += "\"value\":" + fieldValue + ",";
-                        properties += "\"type\":\"" + fieldTypeName + "\"";
-                        properties += "}";
-                    }
-                    properties += "]";
+    VSILFILE* fp_;
+    bool sequence_;
+    std::string name_;
+    OGRFeatureDefn* defn_ = nullptr;
+    OGRSpatialReference* srs_ = nullptr;
+    std::unique_ptr<GeoJsonFeatureScanner> scanner_;
+    std::map<std::string, int> fieldIndex_;
+    bool stringIds_ = false;
+    int idField_ = 0;            // the "id" field string ids go to
+    GIntBig featureCount_ = 0;
+    GIntBig nextFid_ = 0;
+    std::string text_;          // reused feature buffer
+    CPLJSONDocument doc_;
+};
+
+class GeoJsonStreamDataset : public GDALDataset {
+public:
+    explicit GeoJsonStreamDataset(GeoJsonStreamLayer* layer) : layer_(layer) {}
+    int GetLayerCount() override { return 1; }
+    OGRLayer* GetLayer(int i) override { return i == 0 ? layer_.get() : nullptr; }
+
+private:
+    std::unique_ptr<GeoJsonStreamLayer> layer_;
+};
+
+// streaming dataset for a large GeoJSON/GeoJSONSeq input, or nullptr to use GDAL
+static GDALDataset* openStreamingGeoJson(const std::string& path, const std::string& inFmt) {
+    if (inFmt != "geojson" && inFmt != "geojsonseq") return nullptr;
+
+    VSIStatBufL st;
+    const char* minSize = CPLGetConfigOption("GEOCONVERTER_STREAMING_GEOJSON_MIN_SIZE", nullptr);
+    const vsi_l_offset threshold = minSize ? static_cast<vsi_l_offset>(CPLAtoGIntBig(minSize)) : STREAMING_GEOJSON_MIN_SIZE;
+    if (VSIStatL(path.c_str(), &st) != 0 || static_cast<vsi_l_offset>(st.st_size) < threshold) {
+        return nullptr;
+    }
+    VSILFILE* fp = VSIFOpenL(path.c_str(), "rb");
+    if (!fp) return nullptr;
+
+    const std::string name = CPLGetBasename(path.c_str());
+    std::unique_ptr<GeoJsonStreamLayer> layer(new GeoJsonStreamLayer(fp, inFmt == "geojsonseq", name));
+    if (!layer->scanSchema()) {
+        CPLDebug("GEOCONVERTER", "%s: not a streamable feature collection, using the GeoJSON driver", path.c_str());
+        return nullptr;
+    }
 
-                    OGRFeature::DestroyFeature(poFeature);
-                }
+    GeoJsonStreamDataset* ds = new GeoJsonStreamDataset(layer.release());
+    ds->SetDescription(path.c_str());
+    return ds;
+}
+
+static GDALDataset* openInputDataset(const std::string& path, const std::string& inFmt) {
+    if (GDALDataset* ds = openStreamingGeoJson(path, inFmt)) return ds;
+    return openVectorDataset(path);
+}
+
+// ----------------- zip writer -----------------
+// Builds ZIP archives straight from /vsimem buffers: each member is read in
+// place (VSIGetMemFileBuffer), optionally deflated, and the archive is
+// assembled once into a buffer that /vsimem adopts. No /vsizip/ round trip.
+struct ZipMember {
+    std::string name;       // path inside the archive
+    std::string source;     // /vsimem file holding data
+    const GByte* data;      // borrowed from /vsimem
+    size_t size;
+    uint32_t crc = 0;
+    GByte* deflated = nullptr;  // raw deflate stream (VSIMalloc'ed), null = stored
+    size_t deflatedSize = 0;
+};
+
+static uint32_t zipCrc32(const GByte* data, size_t size) {
+    static uint32_t table[256];
+    static std::once_flag once;
+    std::call_once(once, [] {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    });
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// crc + deflate one member; keeps it stored when deflate does not pay off
+static void prepareZipMember(ZipMember& m, bool deflate) {
+    m.crc = zipCrc32(m.data, m.size);
+    if (!deflate || m.size < 64) return;
+
+    size_t outSize = 0;
+    GByte* z = static_cast<GByte*>(CPLZLibDeflate(m.data, m.size, 6, nullptr, 0, &outSize));
+    // CPLZLibDeflate emits a zlib stream: drop the 2-byte header and 4-byte adler32
+    if (z && outSize > 6 && outSize - 6 < m.size) {
+        memmove(z, z + 2, outSize - 6);
+        m.deflated = z;
+        m.deflatedSize = outSize - 6;
+    } else {
+        VSIFree(z);
+    }
+}
+
+static void prepareZipMembers(std::vector<ZipMember>& members, bool deflate) {
+    // members are independent, so deflate them side by side on the pool
+    if (deflate && members.size() > 1 && g_threadPool.threads() > 1) {
+        g_threadPool.parallelFor(members.size(), [&](size_t i) { prepareZipMember(members[i], deflate); });
+        return;
+    }
+    for (auto& m : members) prepareZipMember(m, deflate);
+}
+
+// little-endian appends, to the arena header buffers and the binary pages alike
+template <typename Buffer>
+static void putLE16(Buffer& out, uint32_t v) {
+    out.push_back(static_cast<GByte>(v));
+    out.push_back(static_cast<GByte>(v >> 8));
+}
+
+template <typename Buffer>
+static void putLE32(Buffer& out, uint32_t v) {
+    putLE16(out, v & 0xFFFF);
+    putLE16(out, v >> 16);
+}
+
+// local header (sig 0x04034b50) and central entry (sig 0x02014b50) share this layout
+static void putZipEntryHeader(ArenaVector<GByte>& out, const ZipMember& m, bool central,
+                              uint16_t dosTime, uint16_t dosDate, uint32_t localOffset) {
+    putLE32(out, central ? 0x02014b50u : 0x04034b50u);
+    if (central) putLE16(out, 20);            // version made by
+    putLE16(out, 20);                         // version needed
+    putLE16(out, 0x0800);                     // UTF-8 names
+    putLE16(out, m.deflated ? 8 : 0);         // deflate or store
+    putLE16(out, dosTime);
+    putLE16(out, dosDate);
+    putLE32(out, m.crc);
+    putLE32(out, static_cast<uint32_t>(m.deflated ? m.deflatedSize : m.size));
+    putLE32(out, static_cast<uint32_t>(m.size));
+    putLE16(out, static_cast<uint32_t>(m.name.size()));
+    putLE16(out, 0);                          // extra field length
+    if (central) {
+        putLE16(out, 0);                      // comment length
+        putLE16(out, 0);                      // disk number
+        putLE16(out, 0);                      // internal attributes
+        putLE32(out, 0);                      // external attributes
+        putLE32(out, localOffset);
+    }
+    out.insert(out.end(), m.name.begin(), m.name.end());
+}
+
+static void putZipEnd(ArenaVector<GByte>& eocd, size_t count, size_t centralSize, uint64_t centralOffset) {
+    putLE32(eocd, 0x06054b50u);
+    putLE16(eocd, 0);
+    putLE16(eocd, 0);
+    putLE16(eocd, static_cast<uint32_t>(count));
+    putLE16(eocd, static_cast<uint32_t>(count));
+    putLE32(eocd, static_cast<uint32_t>(centralSize));
+    putLE32(eocd, static_cast<uint32_t>(centralOffset));
+    putLE16(eocd, 0);
+}
+
+static void adoptZipArchive(const std::string& zipPath, GByte* archive, size_t size) {
+    VSILFILE* fp = VSIFileFromMemBuffer(zipPath.c_str(), archive, size, TRUE);
+    if (!fp) {
+        VSIFree(archive);
+        throw std::runtime_error("Failed to create ZIP file");
+    }
+    VSIFCloseL(fp);
+}
+
+// spill mode: members are deflated one at a time straight into an archive
+// sized for storing them all, and each source file is dropped once copied, so
+// the sources, their deflated copies and the archive are never all held at once
+static void writeZipFileSequential(std::vector<ZipMember>& members, const std::string& zipPath,
+                                   bool deflate, uint16_t dosTime, uint16_t dosDate) {
+    size_t bound = 22;   // end of central directory
+    for (const ZipMember& m : members) bound += 30 + 46 + 2 * m.name.size() + m.size;
+    requireMemory(bound, "zipping");
+
+    GByte* archive = static_cast<GByte*>(VSIMalloc(bound));
+    if (!archive) {
+        throw std::runtime_error("Out of memory while creating ZIP");
+    }
+
+    ArenaVector<GByte> central;
+    uint64_t offset = 0;
+    try {
+        for (ZipMember& m : members) {
+            if (offset > 0xFFFFFFFFu || m.size > 0xFFFFFFFFu) {
+                throw std::runtime_error("ZIP output larger than 4 GB is not supported");
             }
+            prepareZipMember(m, deflate);
+
+            ArenaVector<GByte> local;
+            putZipEntryHeader(local, m, false, dosTime, dosDate, 0);
+            putZipEntryHeader(central, m, true, dosTime, dosDate, static_cast<uint32_t>(offset));
+            memcpy(archive + offset, local.data(), local.size());
+            offset += local.size();
+
+            const GByte* payload = m.deflated ? m.deflated : m.data;
+            const size_t payloadSize = m.deflated ? m.deflatedSize : m.size;
+            if (payloadSize) memcpy(archive + offset, payload, payloadSize);
+            offset += payloadSize;
+
+            VSIFree(m.deflated);
+            m.deflated = nullptr;
+            m.data = nullptr;
+            if (!m.source.empty()) VSIUnlink(m.source.c_str());
         }
+        if (offset > 0xFFFFFFFFu) {
+            throw std::runtime_error("ZIP output larger than 4 GB is not supported");
+        }
+    } catch (...) {
+        VSIFree(archive);
+        throw;
+    }
 
-        json += "\"properties\":" + properties;
-        json += "}";
+    ArenaVector<GByte> eocd;
+    putZipEnd(eocd, members.size(), central.size(), offset);
+    memcpy(archive + offset, central.data(), central.size());
+    memcpy(archive + offset + central.size(), eocd.data(), eocd.size());
 
-        result = json;
+    const size_t total = static_cast<size_t>(offset) + central.size() + eocd.size();
+    GByte* shrunk = static_cast<GByte*>(VSIRealloc(archive, total));
+    adoptZipArchive(zipPath, shrunk ? shrunk : archive, total);
+}
 
-        // Cleanup
-        GDALClose(poDS);
-        if (inFmt == "shapefile" || inFmt == "openfilegdb") {
-            VSIUnlink("/vsimem/preview_input.zip");
-        } else {
-            VSIUnlink(inputPath.c_str());
+// write members as a ZIP at zipPath (a /vsimem file owning the archive buffer)
+static void writeZipFile(std::vector<ZipMember>& members, const std::string& zipPath, bool deflate) {
+    PhaseTimer timer(g_timings.zip);
+    throwIfCancelled(-1, "zip");
+    memoryCheckpoint("zipping", true);
+
+    struct DeflatedFree {
+        std::vector<ZipMember>& m;
+        ~DeflatedFree() { for (auto& x : m) VSIFree(x.deflated); }
+    } freeDeflated{members};
+
+    if (members.size() > 0xFFFF) {
+        throw std::runtime_error("Too many files for a ZIP archive");
+    }
+
+    const time_t now = time(nullptr);
+    struct tm lt;   // localtime_r: localtime's static buffer is shared by every thread
+    const bool hasTime = localtime_r(&now, &lt) != nullptr;
+    const uint16_t dosTime = hasTime ? static_cast<uint16_t>((lt.tm_hour << 11) | (lt.tm_min << 5) | (lt.tm_sec / 2)) : 0;
+    const uint16_t dosDate = hasTime ? static_cast<uint16_t>(((lt.tm_year - 80) << 9) | ((lt.tm_mon + 1) << 5) | lt.tm_mday) : 0x21;
+
+    if (g_memory.spill) {
+        writeZipFileSequential(members, zipPath, deflate, dosTime, dosDate);
+        return;
+    }
+    prepareZipMembers(members, deflate);
+
+    // headers are small; build them first, then lay out the archive in one buffer
+    ArenaVector<ArenaVector<GByte>> localHeaders(members.size());
+    ArenaVector<GByte> central;
+    uint64_t offset = 0;
+    for (size_t i = 0; i < members.size(); i++) {
+        const ZipMember& m = members[i];
+        if (offset > 0xFFFFFFFFu || m.size > 0xFFFFFFFFu) {
+            throw std::runtime_error("ZIP output larger than 4 GB is not supported");
         }
+        putZipEntryHeader(localHeaders[i], m, false, dosTime, dosDate, 0);
+        putZipEntryHeader(central, m, true, dosTime, dosDate, static_cast<uint32_t>(offset));
+        offset += localHeaders[i].size() + (m.deflated ? m.deflatedSize : m.size);
+    }
+    if (offset > 0xFFFFFFFFu) {
+        throw std::runtime_error("ZIP output larger than 4 GB is not supported");
+    }
 
-    } catch (const std::exception& ex) {
-        ensureLastErrorMessage();
-        if (g_lastError.empty() && ex.what()) {
-            g_lastError = ex.what();
+    ArenaVector<GByte> eocd;
+    putZipEnd(eocd, members.size(), central.size(), offset);
+
+    const size_t total = static_cast<size_t>(offset) + central.size() + eocd.size();
+    requireMemory(total, "zipping");
+    GByte* archive = static_cast<GByte*>(VSIMalloc(total));
+    if (!archive) {
+        throw std::runtime_error("Out of memory while creating ZIP");
+    }
+    GByte* p = archive;
+    for (size_t i = 0; i < members.size(); i++) {
+        const ZipMember& m = members[i];
+        memcpy(p, localHeaders[i].data(), localHeaders[i].size());
+        p += localHeaders[i].size();
+        const GByte* payload = m.deflated ? m.deflated : m.data;
+        const size_t payloadSize = m.deflated ? m.deflatedSize : m.size;
+        if (payloadSize) memcpy(p, payload, payloadSize);
+        p += payloadSize;
+    }
+    memcpy(p, central.data(), central.size());
+    p += central.size();
+    memcpy(p, eocd.data(), eocd.size());
+
+    adoptZipArchive(zipPath, archive, total);
+}
+
+// add the regular files of a /vsimem directory (recursively) as members named prefix + relative path
+static void collectZipMembers(const std::string& srcDir, const std::string& prefix,
+                              std::vector<ZipMember>& members) {
+    char** fileList = VSIReadDirRecursive(srcDir.c_str());
+    for (int i = 0; fileList && fileList[i]; i++) {
+        const std::string relPath = fileList[i];
+        const std::string srcPath = srcDir + "/" + relPath;
+
+        VSIStatBufL statBuf;
+        if (VSIStatL(srcPath.c_str(), &statBuf) != 0 || VSI_ISDIR(statBuf.st_mode)) continue;
+
+        vsi_l_offset nBytes = 0;
+        GByte* fileData = VSIGetMemFileBuffer(srcPath.c_str(), &nBytes, FALSE);
+        if (!fileData || nBytes == 0) continue;
+
+        ZipMember m;
+        m.name = prefix + relPath;
+        m.source = srcPath;
+        m.data = fileData;
+        m.size = static_cast<size_t>(nBytes);
+        members.push_back(m);
+    }
+    CSLDestroy(fileList);
+}
+
+// recursively copy directory contents to ZIP
+static void copyDirToZip(const std::string& srcDir, const std::string& zipPath,
+                         const std::string& zipPrefix, bool deflate) {
+    std::vector<ZipMember> members;
+    collectZipMembers(srcDir, zipPrefix + "/", members);
+    if (!members.empty()) writeZipFile(members, zipPath, deflate);
+}
+
+// with a progress callback ogr2ogr counts every layer first, so it only gets
+// one when that is cheap
+static bool countsFast(GDALDataset* src) {
+    for (int i = 0; i < src->GetLayerCount(); i++) {
+        OGRLayer* L = src->GetLayer(i);
+        if (L && !L->TestCapability(OLCFastFeatureCount)) return false;
+    }
+    return true;
+}
+
+// small wrapper for GDALVectorTranslate
+// GDALVectorTranslate argv, built in the call's arena
+typedef ArenaVector<JobString> ArgList;
+
+static void pushArgs(ArgList& args, std::initializer_list<std::string_view> values) {
+    for (std::string_view v : values) args.emplace_back(v.data(), v.size());
+}
+
+static GDALDataset* runVectorTranslate(GDALDataset* src, const std::string& dstPath, const ArgList& argvVec) {
+    ArenaVector<char*> argv; argv.reserve(argvVec.size()+1);
+    for (auto& s : argvVec) argv.push_back(const_cast<char*>(s.c_str()));
+    argv.push_back(nullptr);
+    GDALVectorTranslateOptions* opts = GDALVectorTranslateOptionsNew(argv.data(), nullptr);
+    // a memory budget needs the callback even when the count costs a pass
+    if (opts && ((g_progress.enabled && countsFast(src)) || g_memory.budget > 0)) {
+        GDALVectorTranslateOptionsSetProgress(opts, translateProgress, nullptr);
+    }
+    GDALDataset* out = (GDALDataset*)GDALVectorTranslate(dstPath.c_str(), nullptr, 1, (GDALDatasetH*)&src, opts, nullptr);
+    GDALVectorTranslateOptionsFree(opts);
+    return out;
+}
+
+// decide CRS args: transform or assign
+// User-provided CRS always takes priority over file's embedded CRS
+static void pushCrsArgs(ArgList& args,
+                        GDALDataset* src,
+                        const std::string& sourceCrs,
+                        const std::string& targetCrs)
+{
+    const bool haveSrc = !sourceCrs.empty();
+    const bool haveDst = !targetCrs.empty();
+
+    // Case 1: User specified both source and target CRS
+    if (haveSrc && haveDst && sourceCrs != targetCrs) {
+        // Transform: override file's CRS with user's source CRS, then reproject to target
+        pushArgs(args, {"-s_srs", sourceCrs, "-t_srs", targetCrs});
+        return;
+    }
+
+    // Case 2: User specified only source CRS (no target)
+    if (haveSrc && !haveDst) {
+        // Assign/override: tell GDAL the data is in this CRS (user knows better than auto-detect)
+        pushArgs(args, {"-a_srs", sourceCrs});
+        return;
+    }
+
+    // Case 3: User specified only target CRS (no source)
+    if (haveDst && !haveSrc) {
+        // Check if file has embedded CRS
+        OGRLayer* L0 = src->GetLayerCount() > 0 ? src->GetLayer(0) : nullptr;
+        OGRSpatialReference* srs = L0 ? L0->GetSpatialRef() : nullptr;
+
+        if (srs == nullptr) {
+            // No CRS in file: assign the target CRS
+            pushArgs(args, {"-a_srs", targetCrs});
+        } else {
+            // File has CRS: transform from auto-detected to target
+            pushArgs(args, {"-t_srs", targetCrs});
+        }
+    }
+
+    // Case 4: No user CRS specified - let GDAL auto-detect (do nothing)
+}
+
+// layer creation options per output driver, as name/value pairs
+static std::vector<std::pair<std::string, std::string>> driverLayerOptions(
+    const std::string& driver, const ConversionPlan& plan)
+{
+    if (driver == "ESRI Shapefile") {
+        return {{"ENCODING", "UTF-8"}};
+    } else if (driver == "GeoJSON" || driver == "TopoJSON") {
+        return {{"WRITE_BBOX", "YES"},
+                {"COORDINATE_PRECISION", std::to_string(plan.geojsonPrecision)}};
+    } else if (driver == "GPKG") {
+        return {{"SPATIAL_INDEX", "YES"}};
+    } else if (driver == "FlatGeobuf") {
+        // the writer Hilbert-sorts the features for its packed R-tree
+        return {{"SPATIAL_INDEX", "YES"}};
+    } else if (driver == "CSV") {
+        // CSV geometry mode: AS_WKT (default) or AS_XY
+        return {{"GEOMETRY", plan.csvGeometryMode == "XY" ? "AS_XY" : "AS_WKT"}};
+    } else if (driver == "Parquet" || driver == "Arrow") {
+        std::vector<std::pair<std::string, std::string>> options;
+        if (!plan.columnarCompression.empty()) {
+            std::string codec = plan.columnarCompression;
+            std::transform(codec.begin(), codec.end(), codec.begin(), ::toupper);
+            options.push_back({"COMPRESSION", codec});
+        }
+        if (plan.rowGroupSize > 0) {
+            options.push_back({driver == "Parquet" ? "ROW_GROUP_SIZE" : "BATCH_SIZE", std::to_string(plan.rowGroupSize)});
+        }
+        return options;
+    }
+    return {};
+}
+
+static void pushDriverLCO(ArgList& args, const std::string& driver, const ConversionPlan& plan) {
+    for (const auto& lco : driverLayerOptions(driver, plan)) {
+        pushArgs(args, {"-lco", lco.first + "=" + lco.second});
+    }
+}
+
+// drivers that write Mapbox Vector Tiles: tiled natively (writeVectorTiles),
+// or by GDAL's MVT writer with engine "driver" or "translate"
+static bool writesVectorTiles(const std::string& driver) {
+    return driver == "PMTiles" || driver == "MBTiles";
+}
+
+static const int MAX_TILE_ZOOM = 22;
+// GDAL's MVT writer defaults, which the native tiler keeps
+static const int DEFAULT_TILE_MIN_ZOOM = 0;
+static const int DEFAULT_TILE_MAX_ZOOM = 5;
+
+static void checkTileZoomRange(const ConversionPlan& plan) {
+    const int minZoom = plan.tileMinZoom;
+    const int maxZoom = plan.tileMaxZoom;
+    if (minZoom > MAX_TILE_ZOOM || maxZoom > MAX_TILE_ZOOM || (minZoom >= 0 && maxZoom >= 0 && minZoom > maxZoom)) {
+        throw std::runtime_error("Invalid tile zoom range " + std::to_string(minZoom) + "-" + std::to_string(maxZoom) +
+                                 " (zoom levels are 0-" + std::to_string(MAX_TILE_ZOOM) + ")");
+    }
+}
+
+// dataset creation options per output driver, as name/value pairs
+static std::vector<std::pair<std::string, std::string>> driverDatasetOptions(
+    const std::string& driver, const ConversionPlan& plan)
+{
+    std::vector<std::pair<std::string, std::string>> options;
+    if (!writesVectorTiles(driver)) return options;
+
+    checkTileZoomRange(plan);
+    const int minZoom = plan.tileMinZoom;
+    const int maxZoom = plan.tileMaxZoom;
+    if (minZoom >= 0) options.push_back({"MINZOOM", std::to_string(minZoom)});
+    if (maxZoom >= 0) options.push_back({"MAXZOOM", std::to_string(maxZoom)});
+    if (plan.tileSimplification > 0) {
+        options.push_back({"SIMPLIFICATION", CPLSPrintf("%.17g", plan.tileSimplification)});
+    }
+    if (plan.tileSimplificationMaxZoom >= 0) {
+        options.push_back({"SIMPLIFICATION_MAX_ZOOM", CPLSPrintf("%.17g", plan.tileSimplificationMaxZoom)});
+    }
+    return options;
+}
+
+// where clauses for geometry families (including 3D variants for GPX and other formats)
+static const char* WHERE_POINT       = "OGR_GEOMETRY IN ('POINT', 'POINT Z', 'POINT M', 'POINT ZM', 'POINT25D')";
+static const char* WHERE_MULTIPOINT  = "OGR_GEOMETRY IN ('MULTIPOINT', 'MULTIPOINT Z', 'MULTIPOINT M', 'MULTIPOINT ZM', 'MULTIPOINT25D')";
+static const char* WHERE_LINES       = "OGR_GEOMETRY IN ('LINESTRING', 'LINESTRING Z', 'LINESTRING M', 'LINESTRING ZM', 'LINESTRING25D', 'MULTILINESTRING', 'MULTILINESTRING Z', 'MULTILINESTRING M', 'MULTILINESTRING ZM', 'MULTILINESTRING25D')";
+static const char* WHERE_POLYS       = "OGR_GEOMETRY IN ('POLYGON', 'POLYGON Z', 'POLYGON M', 'POLYGON ZM', 'POLYGON25D', 'MULTIPOLYGON', 'MULTIPOLYGON Z', 'MULTIPOLYGON M', 'MULTIPOLYGON ZM', 'MULTIPOLYGON25D')";
+
+// optional single-family where for non-SHP outputs (user-provided filter)
+static std::string whereFromFilter(const std::string& filter) {
+    auto f = toLower(filter);
+    if (f == "point" || f == "points") return WHERE_POINT;
+    if (f == "multipoint" || f == "multi-point") return WHERE_MULTIPOINT;
+    if (f == "line" || f == "lines" || f == "linestring") return WHERE_LINES;
+    if (f == "polygon" || f == "polygons") return WHERE_POLYS;
+    return std::string();
+}
+
+// the plan's geometry type filter and user WHERE clause as one attribute filter
+static std::string planWhere(const ConversionPlan& plan) {
+    const std::string geometryWhere = whereFromFilter(plan.geometryTypeFilter);
+    if (geometryWhere.empty()) return plan.whereClause;
+    if (plan.whereClause.empty()) return geometryWhere;
+    return "(" + geometryWhere + ") AND (" + plan.whereClause + ")";
+}
+
+// the plan's spatial filter ("minx,miny,maxx,maxy", commas or blanks); false when it has none
+static bool planSpatialFilter(const ConversionPlan& plan, OGREnvelope& bbox) {
+    if (plan.spatialFilter.empty()) return false;
+
+    double v[4];
+    int n = 0;
+    char** values = CSLTokenizeStringComplex(plan.spatialFilter.c_str(), " ,", FALSE, FALSE);
+    for (; values && values[n]; n++) {
+        char* end = nullptr;
+        if (n < 4) v[n] = CPLStrtod(values[n], &end);
+        if (n >= 4 || end == values[n] || *end != '\0') {
+            n = -1;
+            break;
+        }
+    }
+    CSLDestroy(values);
+    if (n != 4 || v[0] > v[2] || v[1] > v[3]) {
+        throw std::runtime_error("Invalid spatial filter (expected minx,miny,maxx,maxy): " + plan.spatialFilter);
+    }
+    bbox.MinX = v[0];
+    bbox.MinY = v[1];
+    bbox.MaxX = v[2];
+    bbox.MaxY = v[3];
+    return true;
+}
+
+// GDALVectorTranslate arguments for a plan (input layers and output path aside)
+static ArgList translateArgs(GDALDataset* src, const std::string& driver,
+                             const std::string& layerName, const ConversionPlan& plan) {
+    ArgList args;
+    pushArgs(args, {"-f", driver, "-dim", plan.keepZ ? "XYZ" : "XY"});
+
+    if (plan.explodeCollections) args.push_back("-explodecollections");
+    if (plan.skipFailures) args.push_back("-skipfailures");
+    if (plan.makeValid) args.push_back("-makevalid");
+    if (plan.preserveFid) args.push_back("-preserve_fid");
+    if (plan.simplifyTolerance > 0) {
+        pushArgs(args, {"-simplify", std::to_string(plan.simplifyTolerance)});
+    }
+
+    pushDriverLCO(args, driver, plan);
+    for (const auto& dsco : driverDatasetOptions(driver, plan)) {
+        pushArgs(args, {"-dsco", dsco.first + "=" + dsco.second});
+    }
+    pushCrsArgs(args, src, plan.sourceCrs, plan.targetCrs);
+
+    if (!layerName.empty()) {
+        pushArgs(args, {"-nln", layerName});
+    }
+
+    // a second -where would replace the first, so the filters are combined
+    const std::string where = planWhere(plan);
+    if (!where.empty()) {
+        pushArgs(args, {"-where", where});
+    }
+
+    if (!plan.selectFields.empty()) {
+        pushArgs(args, {"-select", plan.selectFields});
+    }
+
+    // ogr2ogr reprojects a -spat_srs box into the source CRS (the -s_srs override included)
+    OGREnvelope bbox;
+    if (planSpatialFilter(plan, bbox)) {
+        pushArgs(args, {"-spat", CPLSPrintf("%.17g", bbox.MinX), CPLSPrintf("%.17g", bbox.MinY),
+                                 CPLSPrintf("%.17g", bbox.MaxX), CPLSPrintf("%.17g", bbox.MaxY)});
+        if (plan.spatialFilterTargetCrs && !plan.targetCrs.empty()) {
+            pushArgs(args, {"-spat_srs", plan.targetCrs});
+        }
+    }
+    return args;
+}
+
+// ----------------- crs cache -----------------
+// Parsed SRS objects and coordinate transformations are kept in small LRU
+// caches, so repeated previews/conversions in the same CRS skip PROJ setup.
+struct SrsReleaser {
+    void operator()(OGRSpatialReference* srs) const { if (srs) srs->Release(); }
+};
+typedef std::unique_ptr<OGRSpatialReference, SrsReleaser> SrsPtr;
+typedef std::shared_ptr<const OGRSpatialReference> SharedSrs;
+typedef std::unique_ptr<OGRCoordinateTransformation, decltype(&OCTDestroyCoordinateTransformation)> TransformPtr;
+
+static const size_t CRS_CACHE_SIZE = 32;
+
+// most recently used entries at the front
+template <typename T>
+struct LruCache {
+    std::list<std::pair<std::string, T>> entries;
+
+    T* find(const std::string& key) {
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->first == key) {
+                entries.splice(entries.begin(), entries, it);
+                return &entries.front().second;
+            }
+        }
+        return nullptr;
+    }
+
+    void put(const std::string& key, T value) {
+        entries.emplace_front(key, std::move(value));
+        if (entries.size() > CRS_CACHE_SIZE) entries.pop_back();
+    }
+};
+
+static std::mutex g_crsCacheMutex;
+static LruCache<SharedSrs> g_srsCache;
+static LruCache<std::shared_ptr<OGRCoordinateTransformation>> g_transformCache;
+
+static SharedSrs shareSrs(OGRSpatialReference* srs) {
+    return SharedSrs(srs, [](const OGRSpatialReference* p) {
+        const_cast<OGRSpatialReference*>(p)->Release();
+    });
+}
+
+// parsed, GIS-axis-order SRS for a user CRS string ("EPSG:n", WKT, PROJ, ...); null when invalid
+static SharedSrs cachedUserSrs(const std::string& crs) {
+    std::lock_guard<std::mutex> lock(g_crsCacheMutex);
+    if (SharedSrs* hit = g_srsCache.find(crs)) return *hit;
+
+    SrsPtr srs(new OGRSpatialReference());
+    OGRErr err = OGRERR_FAILURE;
+    if (crs.compare(0, 5, "EPSG:") == 0 || crs.compare(0, 5, "epsg:") == 0) {
+        try {
+            err = srs->importFromEPSG(std::stoi(crs.substr(5)));
+        } catch (...) {
+            err = OGRERR_FAILURE;
+        }
+    }
+    if (err != OGRERR_NONE) err = srs->SetFromUserInput(crs.c_str());
+    if (err != OGRERR_NONE) return SharedSrs();
+
+    srs->SetAxisMappingStrategy(OAMS_TRADITIONAL_GIS_ORDER);
+    SharedSrs shared = shareSrs(srs.release());
+    g_srsCache.put(crs, shared);
+    return shared;
+}
+
+static SharedSrs parseUserCrs(const std::string& crs) {
+    SharedSrs srs = cachedUserSrs(crs);
+    if (!srs) throw std::runtime_error("Failed to parse CRS: " + crs);
+    return srs;
+}
+
+// cache key for an SRS that did not come from a user string (e.g. a layer's own CRS)
+static std::string srsCacheKey(const OGRSpatialReference* srs) {
+    char* wkt = nullptr;
+    srs->exportToWkt(&wkt);
+    std::string key = std::string("wkt:") + (wkt ? wkt : "");
+    CPLFree(wkt);
+    return key;
+}
+
+// transformation src -> dst. The cached instance is never handed out: callers get a
+// Clone(), which copies the PROJ pipeline without searching the database again and
+// is safe to use on their own thread.
+static TransformPtr cachedTransform(const OGRSpatialReference* src, const std::string& srcKey,
+                                    const OGRSpatialReference* dst, const std::string& dstKey) {
+    const std::string key = srcKey + "\n->\n" + dstKey;
+    std::lock_guard<std::mutex> lock(g_crsCacheMutex);
+
+    std::shared_ptr<OGRCoordinateTransformation>* hit = g_transformCache.find(key);
+    if (!hit) {
+        OGRCoordinateTransformation* ct = OGRCreateCoordinateTransformation(src, dst);
+        if (!ct) return TransformPtr(nullptr, OCTDestroyCoordinateTransformation);
+        g_transformCache.put(key, std::shared_ptr<OGRCoordinateTransformation>(ct, OCTDestroyCoordinateTransformation));
+        hit = &g_transformCache.entries.front().second;
+    }
+    return TransformPtr((*hit)->Clone(), OCTDestroyCoordinateTransformation);
+}
+
+// ----------------- batch reprojection -----------------
+// Coordinates of many geometries are gathered into contiguous x/y/z arrays and
+// reprojected with one Transform() call per batch (or a closed-form kernel for
+// EPSG:4326 <-> EPSG:3857), then written back into the geometries.
+enum ReprojectionKernel { KERNEL_NONE, KERNEL_4326_TO_3857, KERNEL_3857_TO_4326 };
+
+struct ReprojectionBatch {
+    OGRCoordinateTransformation* transform = nullptr;
+    ReprojectionKernel kernel = KERNEL_NONE;
+    std::vector<double> xs, ys, zs;
+    std::vector<int> success;
+};
+
+static int epsgCodeOf(const OGRSpatialReference* srs) {
+    if (!srs || srs->GetAxisMappingStrategy() != OAMS_TRADITIONAL_GIS_ORDER) return 0;
+    const char* auth = srs->GetAuthorityName(nullptr);
+    const char* code = srs->GetAuthorityCode(nullptr);
+    if (!auth || !code || strcmp(auth, "EPSG") != 0) return 0;
+    return atoi(code);
+}
+
+static void initReprojectionBatch(ReprojectionBatch& batch, OGRCoordinateTransformation* ct) {
+    batch.transform = ct;
+    batch.kernel = KERNEL_NONE;
+    const int src = epsgCodeOf(ct->GetSourceCS());
+    const int dst = epsgCodeOf(ct->GetTargetCS());
+    if (src == 4326 && dst == 3857) batch.kernel = KERNEL_4326_TO_3857;
+    if (src == 3857 && dst == 4326) batch.kernel = KERNEL_3857_TO_4326;
+}
+
+// spherical (web) mercator on the WGS84 semi-major axis, as PROJ defines EPSG:3857
+static const double WEB_MERCATOR_R = 6378137.0;
+static const double DEG_TO_RAD = M_PI / 180.0;
+
+static void runKernel4326To3857(double* xs, double* ys, int* ok, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ok[i] = std::fabs(ys[i]) < 90.0;
+        xs[i] = xs[i] * DEG_TO_RAD * WEB_MERCATOR_R;
+        ys[i] = ok[i] ? WEB_MERCATOR_R * std::log(std::tan(M_PI / 4 + ys[i] * DEG_TO_RAD / 2)) : 0;
+    }
+}
+
+static void runKernel3857To4326(double* xs, double* ys, int* ok, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        double lon = xs[i] / WEB_MERCATOR_R / DEG_TO_RAD;
+        if (std::fabs(lon) > 180.0) lon = std::remainder(lon, 360.0);
+        xs[i] = lon;
+        ys[i] = (M_PI / 2 - 2 * std::atan(std::exp(-ys[i] / WEB_MERCATOR_R))) / DEG_TO_RAD;
+        ok[i] = 1;
+    }
+}
+
+// walk the vertex arrays of geom; false for geometry types that are not handled here
+template <typename SimpleCurveFn, typename PointFn>
+static bool forEachVertexArray(OGRGeometry* geom, SimpleCurveFn onCurve, PointFn onPoint) {
+    const OGRwkbGeometryType type = wkbFlatten(geom->getGeometryType());
+    if (type == wkbPoint) {
+        onPoint(geom->toPoint());
+        return true;
+    }
+    if (type == wkbLineString || type == wkbCircularString) {
+        onCurve(geom->toSimpleCurve());
+        return true;
+    }
+    if (type == wkbCompoundCurve) {
+        OGRCompoundCurve* cc = geom->toCompoundCurve();
+        for (int i = 0; i < cc->getNumCurves(); i++) {
+            if (!forEachVertexArray(cc->getCurve(i), onCurve, onPoint)) return false;
+        }
+        return true;
+    }
+    if (OGR_GT_IsSubClassOf(type, wkbCurvePolygon)) {
+        OGRCurvePolygon* poly = geom->toCurvePolygon();
+        if (poly->getExteriorRingCurve() &&
+            !forEachVertexArray(poly->getExteriorRingCurve(), onCurve, onPoint)) return false;
+        for (int i = 0; i < poly->getNumInteriorRings(); i++) {
+            if (!forEachVertexArray(poly->getInteriorRingCurve(i), onCurve, onPoint)) return false;
+        }
+        return true;
+    }
+    if (OGR_GT_IsSubClassOf(type, wkbGeometryCollection)) {
+        OGRGeometryCollection* coll = geom->toGeometryCollection();
+        for (int i = 0; i < coll->getNumGeometries(); i++) {
+            if (!forEachVertexArray(coll->getGeometryRef(i), onCurve, onPoint)) return false;
+        }
+        return true;
+    }
+    return false; // polyhedral surfaces, TINs: transformed one by one
+}
+
+// reproject geoms in place; ok[i] is false when geometry i could not be transformed
+static void reprojectGeometries(ReprojectionBatch& batch, const std::vector<OGRGeometry*>& geoms,
+                                std::vector<bool>& ok) {
+    ok.assign(geoms.size(), true);
+    std::vector<bool> batched(geoms.size(), false);
+    std::vector<size_t> starts(geoms.size() + 1, 0);
+    batch.xs.clear();
+    batch.ys.clear();
+    batch.zs.clear();
+
+    // gather: one contiguous run of vertices per geometry
+    for (size_t g = 0; g < geoms.size(); g++) {
+        starts[g] = batch.xs.size();
+        if (geoms[g] && !geoms[g]->IsEmpty()) {
+            batched[g] = forEachVertexArray(geoms[g],
+                [&](OGRSimpleCurve* c) {
+                    const size_t off = batch.xs.size();
+                    const int n = c->getNumPoints();
+                    batch.xs.resize(off + n);
+                    batch.ys.resize(off + n);
+                    batch.zs.resize(off + n);
+                    if (n > 0) {
+                        c->getPoints(&batch.xs[off], sizeof(double), &batch.ys[off], sizeof(double),
+                                     &batch.zs[off], sizeof(double));
+                    }
+                },
+                [&](OGRPoint* p) {
+                    batch.xs.push_back(p->getX());
+                    batch.ys.push_back(p->getY());
+                    batch.zs.push_back(p->getZ());
+                });
+            if (!batched[g]) {
+                batch.xs.resize(starts[g]);
+                batch.ys.resize(starts[g]);
+                batch.zs.resize(starts[g]);
+            }
+        }
+    }
+    starts[geoms.size()] = batch.xs.size();
+
+    // transform the whole batch at once
+    const size_t n = batch.xs.size();
+    batch.success.assign(n, 1);
+    if (n > 0) {
+        if (batch.kernel == KERNEL_4326_TO_3857) {
+            runKernel4326To3857(batch.xs.data(), batch.ys.data(), batch.success.data(), n);
+        } else if (batch.kernel == KERNEL_3857_TO_4326) {
+            runKernel3857To4326(batch.xs.data(), batch.ys.data(), batch.success.data(), n);
+        } else {
+            batch.transform->Transform(n, batch.xs.data(), batch.ys.data(), batch.zs.data(),
+                                       batch.success.data());
+        }
+    }
+
+    // scatter back (2D geometries stay 2D)
+    const OGRSpatialReference* targetSrs = batch.transform->GetTargetCS();
+    for (size_t g = 0; g < geoms.size(); g++) {
+        if (!geoms[g]) continue;
+        if (!batched[g]) {
+            ok[g] = geoms[g]->IsEmpty() || geoms[g]->transform(batch.transform) == OGRERR_NONE;
+            continue;
+        }
+        for (size_t i = starts[g]; i < starts[g + 1]; i++) {
+            if (!batch.success[i]) ok[g] = false;
+        }
+        if (!ok[g]) continue;
+
+        size_t pos = starts[g];
+        const bool is3D = geoms[g]->Is3D();
+        forEachVertexArray(geoms[g],
+            [&](OGRSimpleCurve* c) {
+                const int count = c->getNumPoints();
+                if (count > 0) {
+                    c->setPoints(count, &batch.xs[pos], &batch.ys[pos], is3D ? &batch.zs[pos] : nullptr);
+                }
+                pos += count;
+            },
+            [&](OGRPoint* p) {
+                p->setX(batch.xs[pos]);
+                p->setY(batch.ys[pos]);
+                if (is3D) p->setZ(batch.zs[pos]);
+                pos++;
+            });
+        geoms[g]->assignSpatialReference(targetSrs);
+    }
+}
+
+// ----------------- native feature writing -----------------
+
+struct FeatureDeleter {
+    void operator()(OGRFeature* f) const { OGRFeature::DestroyFeature(f); }
+};
+typedef std::unique_ptr<OGRFeature, FeatureDeleter> FeaturePtr;
+
+struct GeometryDeleter {
+    void operator()(OGRGeometry* g) const { OGRGeometryFactory::destroyGeometry(g); }
+};
+typedef std::unique_ptr<OGRGeometry, GeometryDeleter> GeometryPtr;
+
+// native counterpart of pushCrsArgs for code paths that write features themselves:
+// the SRS the output layer is created with, plus the transformation when reprojecting
+struct LayerCrsPlan {
+    SharedSrs ownedSrs;
+    const OGRSpatialReference* outSrs = nullptr;
+    TransformPtr transform{nullptr, OCTDestroyCoordinateTransformation};
+};
+
+static void planLayerCrs(OGRLayer* layer,
+                         const std::string& sourceCrs,
+                         const std::string& targetCrs,
+                         LayerCrsPlan& plan)
+{
+    const bool haveSrc = !sourceCrs.empty();
+    const bool haveDst = !targetCrs.empty();
+    const OGRSpatialReference* layerSrs = layer->GetSpatialRef();
+    plan.outSrs = layerSrs;
+
+    if (haveSrc && haveDst && sourceCrs != targetCrs) {
+        // Transform: the user's source CRS overrides the file's CRS
+        SharedSrs srcSrs = parseUserCrs(sourceCrs);
+        plan.ownedSrs = parseUserCrs(targetCrs);
+        plan.transform = cachedTransform(srcSrs.get(), sourceCrs, plan.ownedSrs.get(), targetCrs);
+        if (!plan.transform) throw std::runtime_error("Unable to compute transformation to " + targetCrs);
+    } else if (haveSrc && !haveDst) {
+        // Assign/override
+        plan.ownedSrs = parseUserCrs(sourceCrs);
+    } else if (haveDst && !haveSrc) {
+        plan.ownedSrs = parseUserCrs(targetCrs);
+        if (layerSrs) {
+            plan.transform = cachedTransform(layerSrs, srsCacheKey(layerSrs), plan.ownedSrs.get(), targetCrs);
+            if (!plan.transform) throw std::runtime_error("Unable to compute transformation to " + targetCrs);
+        }
+    }
+
+    if (plan.ownedSrs) plan.outSrs = plan.ownedSrs.get();
+}
+
+// the plan's spatial filter in the layer's own coordinates (what the layer filter
+// takes); a target CRS box is reprojected into the source CRS planLayerCrs uses
+static bool layerSpatialFilter(OGRLayer* layer, const ConversionPlan& plan, OGREnvelope& bbox) {
+    if (!planSpatialFilter(plan, bbox)) return false;
+    if (!plan.spatialFilterTargetCrs || plan.targetCrs.empty() || plan.sourceCrs == plan.targetCrs) return true;
+
+    SharedSrs userSrs;
+    const OGRSpatialReference* srcSrs = layer->GetSpatialRef();
+    std::string srcKey;
+    if (!plan.sourceCrs.empty()) {
+        userSrs = parseUserCrs(plan.sourceCrs);
+        srcSrs = userSrs.get();
+        srcKey = plan.sourceCrs;
+    } else if (srcSrs) {
+        srcKey = srsCacheKey(srcSrs);
+    } else {
+        return true;    // the data is assigned the target CRS: nothing to reproject
+    }
+
+    SharedSrs dstSrs = parseUserCrs(plan.targetCrs);
+    TransformPtr toSource = cachedTransform(dstSrs.get(), plan.targetCrs, srcSrs, srcKey);
+    OGREnvelope out;
+    if (!toSource || !toSource->TransformBounds(bbox.MinX, bbox.MinY, bbox.MaxX, bbox.MaxY,
+                                                &out.MinX, &out.MinY, &out.MaxX, &out.MaxY, 21)) {
+        throw std::runtime_error("Unable to reproject the spatial filter from " + plan.targetCrs);
+    }
+    bbox = out;
+    return true;
+}
+
+// per-geometry options, applied in the order ogr2ogr uses
+struct GeometryOptions {
+    bool makeValid = false;
+    bool keepZ = false;
+    double simplifyTolerance = 0;
+    OGRCoordinateTransformation* transform = nullptr;
+};
+
+// steps before reprojection; takes ownership of geom, nullptr when an operation failed
+static OGRGeometry* prepareGeometrySource(OGRGeometry* geom, const GeometryOptions& opts) {
+    GeometryPtr g(geom);
+    if (opts.makeValid) {
+        g.reset(g->MakeValid());
+        if (!g) return nullptr;
+    }
+    if (opts.simplifyTolerance > 0) {
+        // tolerance is in source units, so simplify before reprojecting
+        g.reset(g->SimplifyPreserveTopology(opts.simplifyTolerance));
+        if (!g) return nullptr;
+    }
+    return g.release();
+}
+
+// steps after reprojection
+static void finishGeometry(OGRGeometry* g, const GeometryOptions& opts) {
+    g->setMeasured(FALSE);
+    g->set3D(opts.keepZ ? TRUE : FALSE);
+}
+
+// create the given source fields (in that order) on the destination layer;
+// map[i] is the destination index of source field i, or -1
+static std::vector<int> createFieldsLike(OGRFeatureDefn* srcDefn, OGRLayer* dstLayer,
+                                         const std::vector<int>& srcFields) {
+    std::vector<int> fieldMap(srcDefn->GetFieldCount(), -1);
+    OGRFeatureDefn* dstDefn = dstLayer->GetLayerDefn();
+    const JobString fidColumn = toLower(dstLayer->GetFIDColumn());
+    for (int i : srcFields) {
+        OGRFieldDefn* fld = srcDefn->GetFieldDefn(i);
+        // a field named like the destination FID column (e.g. GPKG "fid") would clash with it
+        if (!fidColumn.empty() && toLower(fld->GetNameRef()) == fidColumn) continue;
+        const int before = dstDefn->GetFieldCount();
+        if (dstLayer->CreateField(fld, TRUE) == OGRERR_NONE &&
+            dstDefn->GetFieldCount() > before) {
+            fieldMap[i] = before;
+        }
+    }
+    return fieldMap;
+}
+
+// source field indexes for an ogr2ogr-style -select list ("" selects every field)
+static std::vector<int> selectedFields(OGRFeatureDefn* srcDefn, const std::string& selectFields) {
+    std::vector<int> fields;
+    if (selectFields.empty()) {
+        for (int i = 0; i < srcDefn->GetFieldCount(); i++) fields.push_back(i);
+        return fields;
+    }
+
+    char** names = CSLTokenizeStringComplex(selectFields.c_str(), " ,", FALSE, FALSE);
+    for (int i = 0; names && names[i]; i++) {
+        const int idx = srcDefn->GetFieldIndex(names[i]);
+        if (idx < 0) {
+            const std::string name = names[i];
+            CSLDestroy(names);
+            throw std::runtime_error("Field '" + name + "' not found in source layer");
+        }
+        fields.push_back(idx);
+    }
+    CSLDestroy(names);
+    return fields;
+}
+
+// ----------------- geojson writer -----------------
+// Fast path for GeoJSON output: features are formatted straight into one growing
+// buffer (adopted by /vsimem at the end) with to_chars number formatting, and no
+// per-feature allocation. The output follows the GDAL driver with WRITE_BBOX=YES
+// and COORDINATE_PRECISION, except that the collection bbox comes after "features".
+
+// a VSIMalloc'ed buffer that grows geometrically and becomes a /vsimem file
+struct OutputArena {
+    GByte* data = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    OutputArena() = default;
+    OutputArena(const OutputArena&) = delete;
+    OutputArena& operator=(const OutputArena&) = delete;
+    ~OutputArena() { VSIFree(data); }
+
+    char* reserve(size_t extra) {
+        if (size + extra > capacity) {
+            const size_t newCapacity = std::max<size_t>({capacity * 2, size + extra, 1 << 16});
+            GByte* grown = static_cast<GByte*>(VSIRealloc(data, newCapacity));
+            if (!grown) throw std::runtime_error("Out of memory while writing output");
+            data = grown;
+            capacity = newCapacity;
+        }
+        return reinterpret_cast<char*>(data + size);
+    }
+    void append(const char* s, size_t n) {
+        memcpy(reserve(n), s, n);
+        size += n;
+    }
+    void append(const char* s) { append(s, strlen(s)); }
+    void append(const std::string& s) { append(s.data(), s.size()); }
+
+    // hand the buffer to /vsimem without copying it
+    void adoptAs(const std::string& path) {
+        VSILFILE* fp = VSIFileFromMemBuffer(path.c_str(), data, size, TRUE);
+        if (!fp) throw std::runtime_error("Failed to create " + path);
+        VSIFCloseL(fp);
+        data = nullptr;
+        size = capacity = 0;
+    }
+};
+
+// coordinates: fixed precision with trailing zeros trimmed (keeping one), like
+// the driver's COORDINATE_PRECISION; a negative precision writes shortest round-trip
+static void appendCoordinate(OutputArena& out, double v, int precision) {
+    if (!std::isfinite(v)) {
+        out.append("null", 4);
+        return;
+    }
+    char* buf = out.reserve(64);
+    std::to_chars_result r;
+    if (precision >= 0 && std::fabs(v) < 1e15) {
+        r = std::to_chars(buf, buf + 64, v, std::chars_format::fixed, std::min(precision, 17));
+        if (precision > 0) {
+            while (r.ptr[-1] == '0' && r.ptr[-2] != '.') r.ptr--;
+        }
+    } else {
+        r = std::to_chars(buf, buf + 64, v);
+    }
+    out.size += r.ptr - buf;
+}
+
+// real attributes: 15 significant digits, always with a decimal point or exponent
+static void appendReal(OutputArena& out, double v) {
+    char* buf = out.reserve(32);
+    std::to_chars_result r = std::to_chars(buf, buf + 32, v, std::chars_format::general, 15);
+    size_t n = r.ptr - buf;
+    if (!memchr(buf, '.', n) && !memchr(buf, 'e', n)) {
+        buf[n++] = '.';
+        buf[n++] = '0';
+    }
+    out.size += n;
+}
+
+static void appendInteger(OutputArena& out, GIntBig v) {
+    char* buf = out.reserve(24);
+    out.size += std::to_chars(buf, buf + 24, static_cast<long long>(v)).ptr - buf;
+}
+
+static void appendJsonString(OutputArena& out, const char* s) {
+    static const char* hex = "0123456789abcdef";
+    out.append("\"", 1);
+    for (const char* run = s; ; s++) {
+        const unsigned char c = static_cast<unsigned char>(*s);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.append(run, s - run);
+        if (c == 0) break;
+        switch (c) {
+            case '"':  out.append("\\\"", 2); break;
+            case '\\': out.append("\\\\", 2); break;
+            case '\b': out.append("\\b", 2); break;
+            case '\f': out.append("\\f", 2); break;
+            case '\n': out.append("\\n", 2); break;
+            case '\r': out.append("\\r", 2); break;
+            case '\t': out.append("\\t", 2); break;
+            default: {
+                const char esc[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+                out.append(esc, 6);
+            }
+        }
+        run = s + 1;
+    }
+    out.append("\"", 1);
+}
+
+struct GeoJsonWriter {
+    OutputArena out;
+    OGRFeatureDefn* srcDefn = nullptr;
+    std::vector<int> fields;    // source field indexes, in output order
+    int precision = 7;
+    bool hasZ = false;          // any 3D geometry written: the collection bbox gets Z
+    OGREnvelope3D extent;
+    bool haveExtent = false;
+    GIntBig featureCount = 0;
+
+    void begin(const std::string& name, const OGRSpatialReference* srs) {
+        out.append("{\n\"type\": \"FeatureCollection\",\n\"name\": ");
+        appendJsonString(out, name.c_str());
+        out.append(",\n");
+
+        const char* auth = srs ? srs->GetAuthorityName(nullptr) : nullptr;
+        const char* code = srs ? srs->GetAuthorityCode(nullptr) : nullptr;
+        if (auth && code) {
+            const std::string urn = (EQUAL(auth, "EPSG") && EQUAL(code, "4326"))
+                ? std::string("urn:ogc:def:crs:OGC:1.3:CRS84")
+                : std::string("urn:ogc:def:crs:") + auth + "::" + code;
+            out.append("\"crs\": { \"type\": \"name\", \"properties\": { \"name\": ");
+            appendJsonString(out, urn.c_str());
+            out.append(" } },\n");
+        }
+        out.append("\"features\": [\n");
+    }
+
+    void position(double x, double y, double z, bool withZ) {
+        out.append("[ ", 2);
+        appendCoordinate(out, x, precision);
+        out.append(", ", 2);
+        appendCoordinate(out, y, precision);
+        if (withZ) {
+            out.append(", ", 2);
+            appendCoordinate(out, z, precision);
+        }
+        out.append(" ]", 2);
+    }
+
+    void positions(const OGRSimpleCurve* c, bool withZ) {
+        out.append("[ ", 2);
+        for (int i = 0; i < c->getNumPoints(); i++) {
+            if (i) out.append(", ", 2);
+            position(c->getX(i), c->getY(i), c->getZ(i), withZ);
+        }
+        out.append(" ]", 2);
+    }
+
+    void rings(const OGRPolygon* p, bool withZ) {
+        out.append("[ ", 2);
+        if (const OGRLinearRing* ext = p->getExteriorRing()) {
+            positions(ext, withZ);
+            for (int i = 0; i < p->getNumInteriorRings(); i++) {
+                out.append(", ", 2);
+                positions(p->getInteriorRing(i), withZ);
+            }
+        }
+        out.append(" ]", 2);
+    }
+
+    // "coordinates" of a Point/LineString/Polygon or of the members of a Multi*
+    void coordinates(const OGRGeometry* g, bool withZ) {
+        switch (wkbFlatten(g->getGeometryType())) {
+            case wkbPoint:
+                if (g->IsEmpty()) out.append("[ ]", 3);
+                else position(g->toPoint()->getX(), g->toPoint()->getY(), g->toPoint()->getZ(), withZ);
+                break;
+            case wkbLineString:
+                positions(g->toSimpleCurve(), withZ);
+                break;
+            case wkbPolygon:
+                rings(g->toPolygon(), withZ);
+                break;
+            default: {
+                const OGRGeometryCollection* coll = g->toGeometryCollection();
+                out.append("[ ", 2);
+                for (int i = 0; i < coll->getNumGeometries(); i++) {
+                    if (i) out.append(", ", 2);
+                    coordinates(coll->getGeometryRef(i), withZ);
+                }
+                out.append(" ]", 2);
+            }
+        }
+    }
+
+    void geometry(const OGRGeometry* g) {
+        const OGRwkbGeometryType type = wkbFlatten(g->getGeometryType());
+        const bool withZ = g->Is3D() != 0;
+        switch (type) {
+            case wkbPoint:
+            case wkbLineString:
+            case wkbPolygon:
+            case wkbMultiPoint:
+            case wkbMultiLineString:
+            case wkbMultiPolygon:
+                out.append("{ \"type\": \"");
+                out.append(OGRToOGCGeomType(type));
+                out.append("\", \"coordinates\": ");
+                coordinates(g, withZ);
+                out.append(" }", 2);
+                break;
+            case wkbGeometryCollection: {
+                const OGRGeometryCollection* coll = g->toGeometryCollection();
+                out.append("{ \"type\": \"GeometryCollection\", \"geometries\": [ ");
+                for (int i = 0; i < coll->getNumGeometries(); i++) {
+                    if (i) out.append(", ", 2);
+                    geometry(coll->getGeometryRef(i));
+                }
+                out.append(" ] }", 4);
+                break;
+            }
+            default: {
+                // curves are written linearized, TINs/polyhedral surfaces as (multi)polygons
+                GeometryPtr simple(g->hasCurveGeometry()
+                    ? g->getLinearGeometry()
+                    : OGRGeometryFactory::forceTo(g->clone(), OGR_GT_IsSubClassOf(type, wkbPolyhedralSurface)
+                                                                  ? wkbMultiPolygon : wkbPolygon));
+                if (simple && wkbFlatten(simple->getGeometryType()) != type) geometry(simple.get());
+                else out.append("null", 4);
+            }
+        }
+    }
+
+    void bbox(const OGREnvelope3D& env, bool withZ) {
+        out.append("[ ", 2);
+        const double values[6] = { env.MinX, env.MinY, env.MinZ, env.MaxX, env.MaxY, env.MaxZ };
+        bool first = true;
+        for (int i = 0; i < 6; i++) {
+            if (!withZ && (i == 2 || i == 5)) continue;
+            if (!first) out.append(", ", 2);
+            appendCoordinate(out, values[i], precision);
+            first = false;
+        }
+        out.append(" ]", 2);
+    }
+
+    void properties(const OGRFeature* f) {
+        out.append("\"properties\": { ");
+        bool first = true;
+        for (int i : fields) {
+            if (!f->IsFieldSet(i)) continue;
+            const OGRFieldDefn* fld = srcDefn->GetFieldDefn(i);
+            const bool isNull = f->IsFieldNull(i) != 0;
+            const double real = (!isNull && fld->GetType() == OFTReal) ? f->GetFieldAsDouble(i) : 0;
+            if (!std::isfinite(real)) continue;   // the driver drops non-finite values too
+
+            if (!first) out.append(", ", 2);
+            first = false;
+            appendJsonString(out, fld->GetNameRef());
+            out.append(": ", 2);
+
+            if (isNull) {
+                out.append("null", 4);
+            } else if (fld->GetType() == OFTReal) {
+                appendReal(out, real);
+            } else if (fld->GetType() == OFTString) {
+                appendJsonString(out, f->GetFieldAsString(i));
+            } else if (fld->GetSubType() == OFSTBoolean) {
+                out.append(f->GetFieldAsInteger(i) ? "true" : "false");
+            } else {
+                appendInteger(out, f->GetFieldAsInteger64(i));
+            }
+        }
+        out.append(" }", 2);
+    }
+
+    bool writeFeature(const OGRFeature* f, const OGRGeometry* g, bool writeId) {
+        out.append(featureCount++ ? ",\n{ \"type\": \"Feature\", " : "{ \"type\": \"Feature\", ");
+        if (writeId && f->GetFID() != OGRNullFID) {
+            out.append("\"id\": ");
+            appendInteger(out, f->GetFID());
+            out.append(", ", 2);
+        }
+        properties(f);
+
+        if (g && !g->IsEmpty()) {
+            OGREnvelope3D env;
+            g->getEnvelope(&env);
+            out.append(", \"bbox\": ");
+            bbox(env, g->Is3D() != 0);
+            if (g->Is3D()) hasZ = true;
+            if (haveExtent) {
+                extent.Merge(env);
+            } else {
+                extent = env;
+                haveExtent = true;
+            }
+        }
+
+        out.append(", \"geometry\": ");
+        if (g) geometry(g);
+        else out.append("null", 4);
+        out.append(" }", 2);
+        return true;
+    }
+
+    void finish(const std::string& path) {
+        out.append(featureCount ? "\n]" : "]");
+        if (haveExtent) {
+            out.append(",\n\"bbox\": ");
+            bbox(extent, hasZ);
+        }
+        out.append("\n}\n");
+        out.adoptAs(path);
+    }
+};
+
+// the fast writer covers plain scalar attributes; anything else keeps the driver
+static bool geoJsonWriterSupports(OGRFeatureDefn* defn, const std::vector<int>& fields) {
+    for (int i : fields) {
+        const OGRFieldDefn* fld = defn->GetFieldDefn(i);
+        switch (fld->GetType()) {
+            case OFTInteger:
+            case OFTInteger64:
+            case OFTReal:
+                break;
+            case OFTString:
+                if (fld->GetSubType() == OFSTJSON) return false;
+                break;
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+// ----------------- vector tiles -----------------
+// Native tiler for PMTiles and MBTiles. The pump hands every feature over in Web
+// Mercator; it is stored once in tile-world coordinates (0..1, y down) and filed
+// under the deepest quadtree node that holds its bbox, in one sorted index. The
+// tiles of each zoom level take their candidates from that index and are clipped,
+// simplified and encoded as Mapbox Vector Tiles on the thread pool, a window at
+// a time, then streamed to the output in tile id order. Extent, buffer and the
+// simplification options follow GDAL's MVT writer.
+
+static const double MVT_EXTENT = 4096;
+static const double MVT_BUFFER = 80;
+static const double WEB_MERCATOR_HALF = 20037508.342789244;
+// tiles encoded per window (written in order before the next one starts), and per pool task
+static const size_t TILE_WINDOW = 256;
+static const size_t TILE_CHUNK = 8;
+
+// protobuf wire format
+static void putVarint(std::vector<GByte>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<GByte>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<GByte>(v));
+}
+
+static void putVarintField(std::vector<GByte>& out, int field, uint64_t v) {
+    putVarint(out, static_cast<uint64_t>(field) << 3);
+    putVarint(out, v);
+}
+
+static void putBytesField(std::vector<GByte>& out, int field, const void* data, size_t size) {
+    putVarint(out, (static_cast<uint64_t>(field) << 3) | 2);
+    putVarint(out, size);
+    const GByte* bytes = static_cast<const GByte*>(data);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+// packed repeated uint32 field; scratch holds the encoded values
+static void putPackedField(std::vector<GByte>& out, int field, const std::vector<uint32_t>& values,
+                           std::vector<GByte>& scratch) {
+    scratch.clear();
+    for (uint32_t v : values) putVarint(scratch, v);
+    putBytesField(out, field, scratch.data(), scratch.size());
+}
+
+static uint32_t zigzag32(int32_t v) {
+    return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+// a gzip member, which is how PMTiles and MBTiles store tiles and PMTiles its directories
+static void gzipInto(const GByte* data, size_t size, std::vector<GByte>& out) {
+    size_t zSize = 0;
+    GByte* z = static_cast<GByte*>(CPLZLibDeflate(data, size, 6, nullptr, 0, &zSize));
+    if (!z || zSize < 6) {
+        VSIFree(z);
+        throw std::runtime_error("Failed to compress a vector tile");
+    }
+    static const GByte header[10] = { 0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 0xff };
+    out.assign(header, header + 10);
+    // CPLZLibDeflate emits a zlib stream: drop the 2-byte header and 4-byte adler32
+    out.insert(out.end(), z + 2, z + zSize - 4);
+    VSIFree(z);
+    putLE32(out, zipCrc32(data, size));
+    putLE32(out, static_cast<uint32_t>(size));
+}
+
+// PMTiles tile id: tiles of lower zooms first, then along the Hilbert curve
+static uint64_t pmtilesTileId(int z, uint32_t x, uint32_t y) {
+    const uint64_t n = uint64_t(1) << z;
+    uint64_t id = ((n * n) - 1) / 3;
+    uint64_t tx = x, ty = y;
+    for (uint64_t s = n / 2; s > 0; s /= 2) {
+        const uint64_t rx = (tx & s) ? 1 : 0;
+        const uint64_t ry = (ty & s) ? 1 : 0;
+        id += s * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                tx = n - 1 - tx;
+                ty = n - 1 - ty;
+            }
+            std::swap(tx, ty);
+        }
+    }
+    return id;
+}
+
+// quadtree node keys: the node's path padded to MAX_TILE_ZOOM levels, then its
+// zoom in the low 5 bits, so the nodes below a node sort right after it
+static const int NODE_ZOOM_BITS = 5;
+
+static uint64_t mortonCode(uint32_t x, uint32_t y) {
+    uint64_t code = 0;
+    for (int i = 0; i < MAX_TILE_ZOOM; i++) {
+        code |= static_cast<uint64_t>((x >> i) & 1) << (2 * i);
+        code |= static_cast<uint64_t>((y >> i) & 1) << (2 * i + 1);
+    }
+    return code;
+}
+
+static uint64_t nodeKey(int z, uint32_t x, uint32_t y) {
+    return (mortonCode(x, y) << (2 * (MAX_TILE_ZOOM - z) + NODE_ZOOM_BITS)) | static_cast<uint64_t>(z);
+}
+
+static int bitLength(uint32_t v) {
+    int n = 0;
+    for (; v; v >>= 1) n++;
+    return n;
+}
+
+// tile column or row of a world coordinate at zoom z, clamped to the grid
+static uint32_t tileCoordinate(double w, int z) {
+    const double n = std::ldexp(1.0, z);
+    return static_cast<uint32_t>(std::min(std::max(std::floor(w * n), 0.0), n - 1));
+}
+
+// Liang-Barsky: clip segment a-b to the square [lo, hi]; false when it misses,
+// endInside tells whether b was kept
+static bool clipSegment(double* a, double* b, double lo, double hi, bool& endInside) {
+    const double dx = b[0] - a[0];
+    const double dy = b[1] - a[1];
+    const double p[4] = { -dx, dx, -dy, dy };
+    const double q[4] = { a[0] - lo, hi - a[0], a[1] - lo, hi - a[1] };
+    double t0 = 0, t1 = 1;
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            if (q[i] < 0) return false;
+            continue;
+        }
+        const double r = q[i] / p[i];
+        if (p[i] < 0) {
+            if (r > t1) return false;
+            t0 = std::max(t0, r);
+        } else {
+            if (r < t0) return false;
+            t1 = std::min(t1, r);
+        }
+    }
+    const double ax = a[0], ay = a[1];
+    if (t1 < 1) {
+        b[0] = ax + t1 * dx;
+        b[1] = ay + t1 * dy;
+    }
+    if (t0 > 0) {
+        a[0] = ax + t0 * dx;
+        a[1] = ay + t0 * dy;
+    }
+    endInside = t1 >= 1;
+    return true;
+}
+
+// one Sutherland-Hodgman step: keep the ring (xy pairs) on one side of axis == bound
+static void clipRingEdge(const std::vector<double>& in, std::vector<double>& out, int axis, double bound, bool keepAbove) {
+    out.clear();
+    const size_t n = in.size() / 2;
+    for (size_t i = 0; i < n; i++) {
+        const double* a = &in[2 * ((i + n - 1) % n)];
+        const double* b = &in[2 * i];
+        const bool aIn = keepAbove ? a[axis] >= bound : a[axis] <= bound;
+        const bool bIn = keepAbove ? b[axis] >= bound : b[axis] <= bound;
+        if (aIn != bIn) {
+            const double t = (bound - a[axis]) / (b[axis] - a[axis]);
+            double cut[2] = { a[0] + t * (b[0] - a[0]), a[1] + t * (b[1] - a[1]) };
+            cut[axis] = bound;
+            out.push_back(cut[0]);
+            out.push_back(cut[1]);
+        }
+        if (bIn) {
+            out.push_back(b[0]);
+            out.push_back(b[1]);
+        }
+    }
+}
+
+// Douglas-Peucker on xy pairs, keeping both ends; tolerance in their units
+static void simplifyPoints(std::vector<double>& xy, double tolerance, std::vector<GByte>& keep,
+                           std::vector<std::pair<size_t, size_t>>& stack) {
+    const size_t n = xy.size() / 2;
+    if (tolerance <= 0 || n < 3) return;
+    keep.assign(n, 0);
+    keep[0] = keep[n - 1] = 1;
+    const double tolerance2 = tolerance * tolerance;
+    stack.assign(1, {0, n - 1});
+    while (!stack.empty()) {
+        const size_t first = stack.back().first;
+        const size_t last = stack.back().second;
+        stack.pop_back();
+        const double ax = xy[2 * first], ay = xy[2 * first + 1];
+        const double dx = xy[2 * last] - ax, dy = xy[2 * last + 1] - ay;
+        const double len2 = dx * dx + dy * dy;
+        double worst = -1;
+        size_t worstAt = first;
+        for (size_t i = first + 1; i < last; i++) {
+            double px = xy[2 * i] - ax, py = xy[2 * i + 1] - ay;
+            if (len2 > 0) {
+                const double t = std::min(1.0, std::max(0.0, (px * dx + py * dy) / len2));
+                px -= t * dx;
+                py -= t * dy;
+            }
+            const double d2 = px * px + py * py;
+            if (d2 > worst) {
+                worst = d2;
+                worstAt = i;
+            }
+        }
+        if (worst > tolerance2) {
+            keep[worstAt] = 1;
+            if (worstAt - first > 1) stack.push_back({first, worstAt});
+            if (last - worstAt > 1) stack.push_back({worstAt, last});
+        }
+    }
+    size_t out = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (!keep[i]) continue;
+        xy[2 * out] = xy[2 * i];
+        xy[2 * out + 1] = xy[2 * i + 1];
+        out++;
+    }
+    xy.resize(2 * out);
+}
+
+// tile coordinates rounded to the grid, without repeated points
+static void quantizePoints(const std::vector<double>& xy, std::vector<int32_t>& out) {
+    out.clear();
+    for (size_t i = 0; i + 1 < xy.size(); i += 2) {
+        const int32_t x = static_cast<int32_t>(std::floor(xy[i] + 0.5));
+        const int32_t y = static_cast<int32_t>(std::floor(xy[i + 1] + 0.5));
+        if (out.size() >= 2 && out[out.size() - 2] == x && out.back() == y) continue;
+        out.push_back(x);
+        out.push_back(y);
+    }
+}
+
+// twice the signed area by the surveyor's formula (positive: clockwise with y down)
+static int64_t ringArea2(const std::vector<int32_t>& ring) {
+    const size_t n = ring.size() / 2;
+    int64_t area = 0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        area += static_cast<int64_t>(ring[2 * j]) * ring[2 * i + 1] - static_cast<int64_t>(ring[2 * i]) * ring[2 * j + 1];
+    }
+    return area;
+}
+
+// MVT geometry commands of one feature; the cursor carries over between parts
+struct CommandEncoder {
+    std::vector<uint32_t>& out;
+    int32_t cx = 0;
+    int32_t cy = 0;
+
+    explicit CommandEncoder(std::vector<uint32_t>& commands) : out(commands) { out.clear(); }
+
+    void command(uint32_t id, size_t count) { out.push_back(id | static_cast<uint32_t>(count << 3)); }
+    void point(int32_t x, int32_t y) {
+        out.push_back(zigzag32(x - cx));
+        out.push_back(zigzag32(y - cy));
+        cx = x;
+        cy = y;
+    }
+    // MoveTo the first point, LineTo the others
+    void path(const std::vector<int32_t>& xy) {
+        const size_t n = xy.size() / 2;
+        command(1, 1);
+        point(xy[0], xy[1]);
+        command(2, n - 1);
+        for (size_t i = 1; i < n; i++) point(xy[2 * i], xy[2 * i + 1]);
+    }
+};
+
+// a part of a stored feature: points of a (multi)point, a line, or a polygon ring
+struct TilePart {
+    size_t begin;               // first point in TileSet::xy (pairs)
+    uint32_t count;
+    bool exterior;              // rings: exterior ring (the holes follow it)
+};
+
+struct TileFeature {
+    uint8_t type;               // MVT geometry type: 1 point, 2 line string, 3 polygon
+    uint32_t layer;
+    bool hasId;
+    uint64_t id;                // the source FID
+    size_t tagBegin;            // first key/value pair in TileSet::tags
+    uint32_t tagCount;
+    size_t partBegin;
+    uint32_t partCount;
+    double minX, minY, maxX, maxY;  // bbox in world coordinates
+};
+
+// per source layer: its MVT keys and the values of all its features, each stored once
+struct TileLayer {
+    std::string name;
+    OGRFeatureDefn* defn = nullptr;
+    std::vector<int> fields;                    // source field of each key
+    std::map<std::string, uint32_t> valueIndex; // encoded Value message -> index
+    std::vector<const std::string*> values;     // keys of valueIndex by index
+};
+
+// a tile of the current zoom level
+struct TileAddress {
+    uint64_t id;                // PMTiles tile id, the output order
+    uint32_t x;
+    uint32_t y;
+};
+
+struct EncodedTile {
+    std::vector<GByte> data;    // gzipped MVT, empty when nothing is left in the tile
+    bool touched = false;       // some feature reaches into it: its children are tiled too
+};
+
+// per pool task buffers, reused for every tile
+struct TileScratch {
+    std::vector<uint32_t> candidates;
+    std::vector<double> xy;
+    std::vector<double> clipped;
+    std::vector<int32_t> quantized;
+    std::vector<GByte> keep;
+    std::vector<std::pair<size_t, size_t>> stack;
+    std::vector<uint32_t> commands;
+    std::vector<uint32_t> tags;
+    std::vector<int> keyMap;    // layer key -> tile key, -1 when unused
+    std::vector<int> keys;      // tile keys (layer keys) in order
+    std::map<uint32_t, uint32_t> valueMap;
+    std::vector<uint32_t> values;
+    std::vector<GByte> feature;
+    std::vector<GByte> packed;
+    std::vector<GByte> layer;
+    std::vector<GByte> tile;
+};
+
+// where the encoded tiles go (PmtilesWriter, MbtilesWriter)
+struct TileOutput {
+    virtual ~TileOutput() {}
+    virtual void writeTile(int z, uint32_t x, uint32_t y, uint64_t tileId, const std::vector<GByte>& data) = 0;
+};
+
+struct TileSet {
+    int minZoom = DEFAULT_TILE_MIN_ZOOM;
+    int maxZoom = DEFAULT_TILE_MAX_ZOOM;
+    double simplification = 0;              // tile units, below maxZoom
+    double simplificationMaxZoom = -1;      // at maxZoom, -1: simplification
+
+    std::vector<TileLayer> layers;
+    std::vector<TileFeature> features;
+    std::vector<TilePart> parts;
+    std::vector<double> xy;
+    std::vector<uint32_t> tags;
+    std::vector<std::pair<uint64_t, uint32_t>> index;   // node key, feature
+    OGREnvelope extent;                     // world coordinates of every feature
+    std::vector<GByte> valueScratch;
+    GIntBig tileCount = 0;
+
+    size_t addLayer(const std::string& name, OGRFeatureDefn* defn, const std::vector<int>& fields) {
+        TileLayer layer;
+        layer.name = name;
+        layer.defn = defn;
+        layer.fields = fields;
+        layers.push_back(std::move(layer));
+        return layers.size() - 1;
+    }
+
+    // metadata type of a key, as TileJSON vector_layers lists them
+    static const char* fieldKind(const OGRFieldDefn* fld) {
+        switch (fld->GetType()) {
+            case OFTInteger:
+            case OFTInteger64:
+                return fld->GetSubType() == OFSTBoolean ? "Boolean" : "Number";
+            case OFTReal:
+                return "Number";
+            default:
+                return "String";
+        }
+    }
+
+    // the MVT Value message of field i of f; false for null and non-finite values
+    static bool encodeValue(const OGRFeature* f, int i, const OGRFieldDefn* fld, std::vector<GByte>& out) {
+        out.clear();
+        if (!f->IsFieldSetAndNotNull(i)) return false;
+        switch (fld->GetType()) {
+            case OFTInteger:
+            case OFTInteger64: {
+                const GIntBig v = f->GetFieldAsInteger64(i);
+                if (fld->GetSubType() == OFSTBoolean) putVarintField(out, 7, v != 0);
+                else if (v >= 0) putVarintField(out, 5, static_cast<uint64_t>(v));
+                else putVarintField(out, 6, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+                return true;
+            }
+            case OFTReal: {
+                const double v = f->GetFieldAsDouble(i);
+                if (!std::isfinite(v)) return false;
+                uint64_t bits;
+                memcpy(&bits, &v, sizeof(bits));
+                out.push_back((3 << 3) | 1);
+                putLE32(out, static_cast<uint32_t>(bits));
+                putLE32(out, static_cast<uint32_t>(bits >> 32));
+                return true;
+            }
+            default: {
+                const char* s = f->GetFieldAsString(i);
+                putBytesField(out, 1, s, strlen(s));
+                return true;
+            }
+        }
+    }
+
+    void appendPoint(double x, double y) {
+        if (!std::isfinite(x) || !std::isfinite(y)) return;
+        const double wx = x / (2 * WEB_MERCATOR_HALF) + 0.5;
+        const double wy = std::min(1.0, std::max(0.0, 0.5 - y / (2 * WEB_MERCATOR_HALF)));
+        xy.push_back(wx);
+        xy.push_back(wy);
+    }
+
+    void appendCurve(const OGRSimpleCurve* c, bool ring, bool exterior) {
+        const size_t begin = xy.size();
+        // rings are stored open
+        const int n = c->getNumPoints() - (ring && c->getNumPoints() > 1 ? 1 : 0);
+        for (int i = 0; i < n; i++) appendPoint(c->getX(i), c->getY(i));
+        const size_t count = (xy.size() - begin) / 2;
+        if (count < (ring ? 3u : 2u)) {
+            xy.resize(begin);
+            return;
+        }
+        parts.push_back({begin / 2, static_cast<uint32_t>(count), exterior});
+    }
+
+    // the parts of g of one MVT geometry type (1, 2, 3)
+    void appendParts(const OGRGeometry* g, uint8_t type) {
+        const OGRwkbGeometryType gt = wkbFlatten(g->getGeometryType());
+        switch (gt) {
+            case wkbPoint:
+                if (type != 1 || g->IsEmpty()) break;
+                appendPoint(g->toPoint()->getX(), g->toPoint()->getY());
+                break;
+            case wkbLineString:
+                if (type == 2) appendCurve(g->toSimpleCurve(), false, false);
+                break;
+            case wkbPolygon: {
+                if (type != 3 || g->IsEmpty()) break;
+                const OGRPolygon* p = g->toPolygon();
+                const size_t before = parts.size();
+                appendCurve(p->getExteriorRing(), true, true);
+                if (parts.size() == before) break;     // no holes without their exterior ring
+                for (int i = 0; i < p->getNumInteriorRings(); i++) appendCurve(p->getInteriorRing(i), true, false);
+                break;
+            }
+            case wkbMultiPoint:
+            case wkbMultiLineString:
+            case wkbMultiPolygon:
+            case wkbGeometryCollection: {
+                const OGRGeometryCollection* coll = g->toGeometryCollection();
+                for (int i = 0; i < coll->getNumGeometries(); i++) appendParts(coll->getGeometryRef(i), type);
+                break;
+            }
+            default: {
+                // curves are tiled linearized, TINs/polyhedral surfaces as (multi)polygons
+                GeometryPtr simple(g->hasCurveGeometry()
+                    ? g->getLinearGeometry()
+                    : OGRGeometryFactory::forceTo(g->clone(), OGR_GT_IsSubClassOf(gt, wkbPolyhedralSurface)
+                                                                  ? wkbMultiPolygon : wkbPolygon));
+                if (simple && wkbFlatten(simple->getGeometryType()) != gt) appendParts(simple.get(), type);
+            }
+        }
+    }
+
+    // store one feature of layer; geometry collections become one feature per
+    // geometry type, features without geometry are dropped (MVT has none)
+    bool add(size_t layer, const OGRFeature* src, const OGRGeometry* g) {
+        if (!g || g->IsEmpty()) return true;
+        TileLayer& L = layers[layer];
+
+        const size_t tagBegin = tags.size();
+        std::vector<GByte>& value = valueScratch;
+        for (size_t k = 0; k < L.fields.size(); k++) {
+            const int i = L.fields[k];
+            if (!encodeValue(src, i, L.defn->GetFieldDefn(i), value)) continue;
+            auto it = L.valueIndex.emplace(std::string(value.begin(), value.end()),
+                                           static_cast<uint32_t>(L.values.size())).first;
+            if (it->second == L.values.size()) L.values.push_back(&it->first);
+            tags.push_back(static_cast<uint32_t>(k));
+            tags.push_back(it->second);
+        }
+
+        bool stored = false;
+        for (uint8_t type = 1; type <= 3; type++) {
+            const size_t xyBegin = xy.size();
+            const size_t partBegin = parts.size();
+            appendParts(g, type);
+            // points are one part of all the points
+            if (type == 1 && xy.size() > xyBegin) {
+                parts.push_back({xyBegin / 2, static_cast<uint32_t>((xy.size() - xyBegin) / 2), false});
+            }
+            if (parts.size() == partBegin) continue;
+            if (features.size() >= UINT32_MAX) throw std::runtime_error("Too many features for vector tiles");
+
+            TileFeature f;
+            f.type = type;
+            f.layer = static_cast<uint32_t>(layer);
+            f.hasId = src->GetFID() >= 0;
+            f.id = f.hasId ? static_cast<uint64_t>(src->GetFID()) : 0;
+            f.tagBegin = tagBegin;
+            f.tagCount = static_cast<uint32_t>((tags.size() - tagBegin) / 2);
+            f.partBegin = partBegin;
+            f.partCount = static_cast<uint32_t>(parts.size() - partBegin);
+            f.minX = f.minY = 1;
+            f.maxX = f.maxY = 0;
+            for (size_t i = xyBegin; i < xy.size(); i += 2) {
+                f.minX = std::min(f.minX, xy[i]);
+                f.maxX = std::max(f.maxX, xy[i]);
+                f.minY = std::min(f.minY, xy[i + 1]);
+                f.maxY = std::max(f.maxY, xy[i + 1]);
+            }
+            extent.Merge(f.minX, f.minY);
+            extent.Merge(f.maxX, f.maxY);
+            features.push_back(f);
+            stored = true;
+        }
+        if (!stored) tags.resize(tagBegin);
+        return true;
+    }
+
+    // the partition pass: every feature under the deepest node that holds its bbox
+    void buildIndex() {
+        requireMemory(features.size() * sizeof(index[0]), "indexing vector tiles");
+        index.reserve(features.size());
+        for (size_t i = 0; i < features.size(); i++) {
+            const TileFeature& f = features[i];
+            const uint32_t x0 = tileCoordinate(f.minX, maxZoom);
+            const uint32_t y0 = tileCoordinate(f.minY, maxZoom);
+            const int up = std::max(bitLength(x0 ^ tileCoordinate(f.maxX, maxZoom)),
+                                    bitLength(y0 ^ tileCoordinate(f.maxY, maxZoom)));
+            index.push_back({nodeKey(maxZoom - up, x0 >> up, y0 >> up), static_cast<uint32_t>(i)});
+        }
+        std::sort(index.begin(), index.end());
+    }
+
+    // features whose buffered bbox meets tile z/x/y, in source order
+    void candidates(int z, uint32_t x, uint32_t y, std::vector<uint32_t>& out) const {
+        out.clear();
+        const double size = std::ldexp(1.0, -z);
+        const double buffer = size * (MVT_BUFFER / MVT_EXTENT);
+        const double minX = x * size - buffer, maxX = (x + 1) * size + buffer;
+        const double minY = y * size - buffer, maxY = (y + 1) * size + buffer;
+        auto consider = [&](uint32_t i) {
+            const TileFeature& f = features[i];
+            if (f.maxX >= minX && f.minX <= maxX && f.maxY >= minY && f.minY <= maxY) out.push_back(i);
+        };
+
+        // the buffer reaches into the 8 neighbours only: features under them, or above them
+        const uint32_t last = (uint32_t(1) << z) - 1;
+        const uint32_t x0 = x > 0 ? x - 1 : 0, x1 = std::min(x + 1, last);
+        const uint32_t y0 = y > 0 ? y - 1 : 0, y1 = std::min(y + 1, last);
+        const uint64_t span = uint64_t(1) << (2 * (MAX_TILE_ZOOM - z) + NODE_ZOOM_BITS);
+        for (uint32_t nx = x0; nx <= x1; nx++) {
+            for (uint32_t ny = y0; ny <= y1; ny++) {
+                const uint64_t begin = nodeKey(z, nx, ny) & ~uint64_t((1 << NODE_ZOOM_BITS) - 1);
+                auto it = std::lower_bound(index.begin(), index.end(), std::make_pair(begin, uint32_t(0)));
+                for (; it != index.end() && it->first < begin + span; ++it) {
+                    // nodes above with the same padded path sort in the range too
+                    if (static_cast<int>(it->first & ((1 << NODE_ZOOM_BITS) - 1)) >= z) consider(it->second);
+                }
+            }
+        }
+        for (int az = 0; az < z; az++) {
+            const int shift = z - az;
+            for (uint32_t ax = x0 >> shift; ax <= (x1 >> shift); ax++) {
+                for (uint32_t ay = y0 >> shift; ay <= (y1 >> shift); ay++) {
+                    const uint64_t key = nodeKey(az, ax, ay);
+                    auto it = std::lower_bound(index.begin(), index.end(), std::make_pair(key, uint32_t(0)));
+                    for (; it != index.end() && it->first == key; ++it) consider(it->second);
+                }
+            }
+        }
+        std::sort(out.begin(), out.end());
+    }
+
+    // part points in tile coordinates (extent units, y down)
+    void loadPart(const TilePart& part, double scale, double originX, double originY, std::vector<double>& out) const {
+        out.resize(2 * static_cast<size_t>(part.count));
+        const double* p = &xy[2 * part.begin];
+        for (size_t i = 0; i < out.size(); i += 2) {
+            out[i] = p[i] * scale - originX;
+            out[i + 1] = p[i + 1] * scale - originY;
+        }
+    }
+
+    // MVT commands of f in the tile into s.commands; false when nothing of it is left
+    bool encodeGeometry(const TileFeature& f, double scale, double originX, double originY, double tolerance,
+                        TileScratch& s, bool& touched) const {
+        const double lo = -MVT_BUFFER, hi = MVT_EXTENT + MVT_BUFFER;
+        CommandEncoder enc(s.commands);
+        bool keepHoles = false;
+        for (uint32_t k = 0; k < f.partCount; k++) {
+            const TilePart& part = parts[f.partBegin + k];
+            loadPart(part, scale, originX, originY, s.xy);
+
+            if (f.type == 1) {
+                s.clipped.clear();
+                for (size_t i = 0; i < s.xy.size(); i += 2) {
+                    if (s.xy[i] < lo || s.xy[i] > hi || s.xy[i + 1] < lo || s.xy[i + 1] > hi) continue;
+                    s.clipped.push_back(s.xy[i]);
+                    s.clipped.push_back(s.xy[i + 1]);
+                }
+                if (s.clipped.empty()) continue;
+                touched = true;
+                s.quantized.clear();
+                for (size_t i = 0; i < s.clipped.size(); i++) {
+                    s.quantized.push_back(static_cast<int32_t>(std::floor(s.clipped[i] + 0.5)));
+                }
+                enc.command(1, s.quantized.size() / 2);
+                for (size_t i = 0; i < s.quantized.size(); i += 2) enc.point(s.quantized[i], s.quantized[i + 1]);
+            } else if (f.type == 2) {
+                // the pieces of the line inside the buffered tile, one after the other
+                bool open = false;
+                auto flush = [&]() {
+                    simplifyPoints(s.clipped, tolerance, s.keep, s.stack);
+                    quantizePoints(s.clipped, s.quantized);
+                    if (s.quantized.size() >= 4) enc.path(s.quantized);
+                };
+                for (size_t i = 0; i + 3 < s.xy.size(); i += 2) {
+                    double a[2] = { s.xy[i], s.xy[i + 1] };
+                    double b[2] = { s.xy[i + 2], s.xy[i + 3] };
+                    bool endInside = false;
+                    if (!clipSegment(a, b, lo, hi, endInside)) {
+                        if (open) flush();
+                        open = false;
+                        continue;
+                    }
+                    touched = true;
+                    // an open piece ended inside, where this segment starts
+                    if (!open) {
+                        s.clipped.assign(a, a + 2);
+                    }
+                    s.clipped.push_back(b[0]);
+                    s.clipped.push_back(b[1]);
+                    open = endInside;
+                    if (!open) flush();
+                }
+                if (open) flush();
+            } else {
+                if (!part.exterior && !keepHoles) continue;
+                if (part.exterior) keepHoles = false;
+                clipRingEdge(s.xy, s.clipped, 0, lo, true);
+                clipRingEdge(s.clipped, s.xy, 0, hi, false);
+                clipRingEdge(s.xy, s.clipped, 1, lo, true);
+                clipRingEdge(s.clipped, s.xy, 1, hi, false);
+                if (s.xy.size() < 6) continue;
+                touched = true;
+                // simplified as a closed line
+                s.xy.push_back(s.xy[0]);
+                s.xy.push_back(s.xy[1]);
+                simplifyPoints(s.xy, tolerance, s.keep, s.stack);
+                quantizePoints(s.xy, s.quantized);
+                if (s.quantized.size() >= 4 && s.quantized[0] == s.quantized[s.quantized.size() - 2] &&
+                    s.quantized[1] == s.quantized.back()) {
+                    s.quantized.resize(s.quantized.size() - 2);
+                }
+                if (s.quantized.size() < 6) continue;
+                const int64_t area = ringArea2(s.quantized);
+                if (area == 0) continue;
+                // exterior rings clockwise on screen (positive area), holes the other way
+                if ((area > 0) != part.exterior) {
+                    for (size_t i = 0, j = s.quantized.size() - 2; i < j; i += 2, j -= 2) {
+                        std::swap(s.quantized[i], s.quantized[j]);
+                        std::swap(s.quantized[i + 1], s.quantized[j + 1]);
+                    }
+                }
+                if (part.exterior) keepHoles = true;
+                enc.path(s.quantized);
+                enc.command(7, 1);
+            }
+        }
+        return !s.commands.empty();
+    }
+
+    // the layer message of the candidates [begin, end) (all of one layer) into s.tile
+    void encodeLayer(int z, const TileAddress& t, size_t begin, size_t end, TileScratch& s, bool& touched) const {
+        const TileLayer& L = layers[features[s.candidates[begin]].layer];
+        const double scale = std::ldexp(MVT_EXTENT, z);
+        const double tolerance = (z == maxZoom && simplificationMaxZoom >= 0) ? simplificationMaxZoom : simplification;
+        s.layer.clear();
+        s.keyMap.assign(L.fields.size(), -1);
+        s.keys.clear();
+        s.valueMap.clear();
+        s.values.clear();
+
+        for (size_t c = begin; c < end; c++) {
+            const TileFeature& f = features[s.candidates[c]];
+            if (!encodeGeometry(f, scale, t.x * MVT_EXTENT, t.y * MVT_EXTENT, tolerance, s, touched)) continue;
+
+            s.tags.clear();
+            for (uint32_t k = 0; k < f.tagCount; k++) {
+                const uint32_t key = tags[f.tagBegin + 2 * k];
+                const uint32_t value = tags[f.tagBegin + 2 * k + 1];
+                if (s.keyMap[key] < 0) {
+                    s.keyMap[key] = static_cast<int>(s.keys.size());
+                    s.keys.push_back(static_cast<int>(key));
+                }
+                auto it = s.valueMap.emplace(value, static_cast<uint32_t>(s.values.size())).first;
+                if (it->second == s.values.size()) s.values.push_back(value);
+                s.tags.push_back(static_cast<uint32_t>(s.keyMap[key]));
+                s.tags.push_back(it->second);
+            }
+
+            s.feature.clear();
+            if (f.hasId) putVarintField(s.feature, 1, f.id);
+            if (!s.tags.empty()) putPackedField(s.feature, 2, s.tags, s.packed);
+            putVarintField(s.feature, 3, f.type);
+            putPackedField(s.feature, 4, s.commands, s.packed);
+            putBytesField(s.layer, 2, s.feature.data(), s.feature.size());
+        }
+        if (s.layer.empty()) return;
+
+        std::vector<GByte>& out = s.feature;
+        out.clear();
+        putVarintField(out, 15, 2);
+        putBytesField(out, 1, L.name.data(), L.name.size());
+        out.insert(out.end(), s.layer.begin(), s.layer.end());
+        for (int key : s.keys) {
+            const char* name = L.defn->GetFieldDefn(L.fields[key])->GetNameRef();
+            putBytesField(out, 3, name, strlen(name));
+        }
+        for (uint32_t value : s.values) putBytesField(out, 4, L.values[value]->data(), L.values[value]->size());
+        putVarintField(out, 5, static_cast<uint64_t>(MVT_EXTENT));
+        putBytesField(s.tile, 3, out.data(), out.size());
+    }
+
+    // runs on the pool: must not touch the call's progress or arena
+    void encodeTile(int z, const TileAddress& t, TileScratch& s, EncodedTile& out) const {
+        out.data.clear();
+        out.touched = false;
+        candidates(z, t.x, t.y, s.candidates);
+        s.tile.clear();
+        for (size_t begin = 0; begin < s.candidates.size();) {
+            size_t end = begin + 1;
+            const uint32_t layer = features[s.candidates[begin]].layer;
+            while (end < s.candidates.size() && features[s.candidates[end]].layer == layer) end++;
+            encodeLayer(z, t, begin, end, s, out.touched);
+            begin = end;
+        }
+        if (!s.tile.empty()) gzipInto(s.tile.data(), s.tile.size(), out.data);
+    }
+
+    // tiles of minZoom that the buffered features reach
+    std::vector<TileAddress> firstLevel() const {
+        const double buffer = std::ldexp(MVT_BUFFER / MVT_EXTENT, -minZoom);
+        size_t count = 0;
+        for (const TileFeature& f : features) {
+            count += static_cast<size_t>(tileCoordinate(f.maxX + buffer, minZoom) - tileCoordinate(f.minX - buffer, minZoom) + 1) *
+                     (tileCoordinate(f.maxY + buffer, minZoom) - tileCoordinate(f.minY - buffer, minZoom) + 1);
+        }
+        requireMemory(count * sizeof(TileAddress), "tiling");
+        std::vector<TileAddress> tiles;
+        tiles.reserve(count);
+        for (const TileFeature& f : features) {
+            for (uint32_t x = tileCoordinate(f.minX - buffer, minZoom); x <= tileCoordinate(f.maxX + buffer, minZoom); x++) {
+                for (uint32_t y = tileCoordinate(f.minY - buffer, minZoom); y <= tileCoordinate(f.maxY + buffer, minZoom); y++) {
+                    tiles.push_back({pmtilesTileId(minZoom, x, y), x, y});
+                }
+            }
+        }
+        return tiles;
+    }
+
+    // every zoom level, a window of tiles at a time: encoded on the pool, written in order
+    void encode(TileOutput& output) {
+        buildIndex();
+        std::vector<TileAddress> tiles = firstLevel();
+        std::vector<EncodedTile> window(std::min(TILE_WINDOW, tiles.size()));
+        std::vector<TileScratch> scratch((TILE_WINDOW + TILE_CHUNK - 1) / TILE_CHUNK);
+        const int levels = maxZoom - minZoom + 1;
+
+        for (int z = minZoom; z <= maxZoom && !tiles.empty(); z++) {
+            auto byId = [](const TileAddress& a, const TileAddress& b) { return a.id < b.id; };
+            std::sort(tiles.begin(), tiles.end(), byId);
+            tiles.erase(std::unique(tiles.begin(), tiles.end(), [](const TileAddress& a, const TileAddress& b) {
+                return a.id == b.id;
+            }), tiles.end());
+
+            std::vector<TileAddress> next;
+            for (size_t first = 0; first < tiles.size(); first += TILE_WINDOW) {
+                const size_t n = std::min(TILE_WINDOW, tiles.size() - first);
+                const size_t chunks = (n + TILE_CHUNK - 1) / TILE_CHUNK;
+                window.resize(n);
+                auto encodeChunk = [&](size_t c) {
+                    for (size_t i = c * TILE_CHUNK; i < std::min(n, (c + 1) * TILE_CHUNK); i++) {
+                        encodeTile(z, tiles[first + i], scratch[c], window[i]);
+                    }
+                };
+                if (chunks > 1 && g_threadPool.threads() > 1) {
+                    g_threadPool.parallelFor(chunks, encodeChunk);
+                } else {
+                    for (size_t c = 0; c < chunks; c++) encodeChunk(c);
+                }
+
+                size_t touched = 0;
+                for (size_t i = 0; i < n; i++) touched += window[i].touched ? 1 : 0;
+                if (z < maxZoom) requireMemory(4 * touched * sizeof(TileAddress), "tiling");
+                for (size_t i = 0; i < n; i++) {
+                    const TileAddress& t = tiles[first + i];
+                    if (!window[i].data.empty()) {
+                        output.writeTile(z, t.x, t.y, t.id, window[i].data);
+                        tileCount++;
+                    }
+                    if (!window[i].touched || z == maxZoom) continue;
+                    for (uint32_t k = 0; k < 4; k++) {
+                        const uint32_t cx = 2 * t.x + (k & 1), cy = 2 * t.y + (k >> 1);
+                        next.push_back({pmtilesTileId(z + 1, cx, cy), cx, cy});
+                    }
+                }
+                memoryCheckpoint("tiling");
+                throwIfCancelled((z - minZoom + static_cast<double>(first + n) / tiles.size()) / levels, "tiles");
+            }
+            tiles.swap(next);
+        }
+    }
+
+    // bounds of the features in degrees: west, south, east, north
+    void bounds(double out[4]) const {
+        if (!extent.IsInit()) {
+            out[0] = -180;
+            out[1] = -85.0511287798066;
+            out[2] = 180;
+            out[3] = 85.0511287798066;
+            return;
+        }
+        const double pi = 3.14159265358979323846;
+        auto lat = [pi](double wy) { return std::atan(std::sinh(pi * (1 - 2 * wy))) * 180 / pi; };
+        out[0] = extent.MinX * 360 - 180;
+        out[1] = lat(extent.MaxY);
+        out[2] = extent.MaxX * 360 - 180;
+        out[3] = lat(extent.MinY);
+    }
+
+    // TileJSON vector_layers
+    std::string vectorLayersJson() const {
+        std::string json = "[";
+        for (const TileLayer& L : layers) {
+            if (json.size() > 1) json += ",";
+            json += "{\"id\":\"";
+            json += escapeJsonString(L.name);
+            json += "\",\"fields\":{";
+            for (size_t k = 0; k < L.fields.size(); k++) {
+                const OGRFieldDefn* fld = L.defn->GetFieldDefn(L.fields[k]);
+                if (k) json += ",";
+                json += "\"";
+                json += escapeJsonString(fld->GetNameRef());
+                json += "\":\"";
+                json += fieldKind(fld);
+                json += "\"";
+            }
+            json += CPLSPrintf("},\"minzoom\":%d,\"maxzoom\":%d}", minZoom, maxZoom);
+        }
+        return json + "]";
+    }
+};
+
+// PMTiles v3: the header and root directory go in the first PMTILES_ROOT_SPACE
+// bytes, the tiles are written after them as they come (clustered, in tile id
+// order), then the metadata and the leaf directories
+static const size_t PMTILES_HEADER_SIZE = 127;
+static const size_t PMTILES_ROOT_SPACE = 16384;
+static const size_t PMTILES_LEAF_ENTRIES = 4096;
+// tiles up to this size are deduplicated by content (mostly empty sea and land)
+static const size_t PMTILES_DEDUP_BYTES = 1024;
+
+struct PmtilesWriter : TileOutput {
+    struct Entry {
+        uint64_t tileId;
+        uint64_t offset;        // in the tile data section
+        uint32_t length;
+        uint32_t runLength;     // 0 in the root: the entry is a leaf directory
+    };
+
+    explicit PmtilesWriter(const std::string& outPath) : path(outPath) {
+        fp = VSIFOpenL(path.c_str(), "wb");
+        if (!fp) throw std::runtime_error("Failed to create PMTiles output");
+        const std::vector<GByte> reserved(PMTILES_ROOT_SPACE, 0);
+        write(reserved);
+    }
+    ~PmtilesWriter() override {
+        if (fp) VSIFCloseL(fp);
+    }
+
+    void write(const std::vector<GByte>& data) {
+        if (!data.empty() && VSIFWriteL(data.data(), 1, data.size(), fp) != data.size()) {
+            throw std::runtime_error("Failed to write PMTiles output");
+        }
+    }
+
+    void writeTile(int, uint32_t, uint32_t, uint64_t tileId, const std::vector<GByte>& data) override {
+        addressed++;
+        std::string key;
+        if (data.size() <= PMTILES_DEDUP_BYTES) {
+            key.assign(data.begin(), data.end());
+            auto it = small.find(key);
+            if (it != small.end()) {
+                Entry& last = entries.back();
+                if (last.offset == it->second && last.tileId + last.runLength == tileId) {
+                    last.runLength++;
+                } else {
+                    entries.push_back({tileId, it->second, static_cast<uint32_t>(data.size()), 1});
+                }
+                return;
+            }
+        }
+        entries.push_back({tileId, dataLength, static_cast<uint32_t>(data.size()), 1});
+        if (!key.empty()) small.emplace(std::move(key), dataLength);
+        write(data);
+        dataLength += data.size();
+        contents++;
+    }
+
+    // directory entries, gzipped
+    static void directory(const Entry* e, size_t n, std::vector<GByte>& out) {
+        std::vector<GByte> raw;
+        putVarint(raw, n);
+        for (size_t i = 0; i < n; i++) putVarint(raw, e[i].tileId - (i ? e[i - 1].tileId : 0));
+        for (size_t i = 0; i < n; i++) putVarint(raw, e[i].runLength);
+        for (size_t i = 0; i < n; i++) putVarint(raw, e[i].length);
+        for (size_t i = 0; i < n; i++) {
+            const bool follows = i > 0 && e[i].offset == e[i - 1].offset + e[i - 1].length;
+            putVarint(raw, follows ? 0 : e[i].offset + 1);
+        }
+        gzipInto(raw.data(), raw.size(), out);
+    }
+
+    static void putLE64(std::vector<GByte>& out, uint64_t v) {
+        putLE32(out, static_cast<uint32_t>(v));
+        putLE32(out, static_cast<uint32_t>(v >> 32));
+    }
+
+    void finish(const TileSet& tiles, const std::string& name) {
+        std::string json = "{\"name\":\"";
+        json += escapeJsonString(name);
+        json += "\",\"format\":\"pbf\",\"type\":\"overlay\",\"vector_layers\":" + tiles.vectorLayersJson() + "}";
+        std::vector<GByte> metadata;
+        gzipInto(reinterpret_cast<const GByte*>(json.data()), json.size(), metadata);
+        write(metadata);
+
+        // the root directory, or leaves of growing size until the root fits
+        std::vector<GByte> root, leaves;
+        directory(entries.data(), entries.size(), root);
+        for (size_t leafSize = PMTILES_LEAF_ENTRIES; PMTILES_HEADER_SIZE + root.size() > PMTILES_ROOT_SPACE; leafSize *= 2) {
+            std::vector<Entry> rootEntries;
+            std::vector<GByte> leaf;
+            leaves.clear();
+            for (size_t i = 0; i < entries.size(); i += leafSize) {
+                const size_t n = std::min(leafSize, entries.size() - i);
+                directory(&entries[i], n, leaf);
+                rootEntries.push_back({entries[i].tileId, leaves.size(), static_cast<uint32_t>(leaf.size()), 0});
+                leaves.insert(leaves.end(), leaf.begin(), leaf.end());
+            }
+            directory(rootEntries.data(), rootEntries.size(), root);
+        }
+        write(leaves);
+
+        double bounds[4];
+        tiles.bounds(bounds);
+        const uint64_t metadataOffset = PMTILES_ROOT_SPACE + dataLength;
+        std::vector<GByte> header = { 'P', 'M', 'T', 'i', 'l', 'e', 's', 3 };
+        putLE64(header, PMTILES_HEADER_SIZE);
+        putLE64(header, root.size());
+        putLE64(header, metadataOffset);
+        putLE64(header, metadata.size());
+        putLE64(header, metadataOffset + metadata.size());
+        putLE64(header, leaves.size());
+        putLE64(header, PMTILES_ROOT_SPACE);
+        putLE64(header, dataLength);
+        putLE64(header, addressed);
+        putLE64(header, entries.size());
+        putLE64(header, contents);
+        header.push_back(1);                // clustered
+        header.push_back(2);                // internal compression: gzip
+        header.push_back(2);                // tile compression: gzip
+        header.push_back(1);                // tile type: MVT
+        header.push_back(static_cast<GByte>(tiles.minZoom));
+        header.push_back(static_cast<GByte>(tiles.maxZoom));
+        for (double v : bounds) putLE32(header, static_cast<uint32_t>(static_cast<int32_t>(std::lround(v * 1e7))));
+        header.push_back(static_cast<GByte>(tiles.minZoom));
+        putLE32(header, static_cast<uint32_t>(static_cast<int32_t>(std::lround((bounds[0] + bounds[2]) / 2 * 1e7))));
+        putLE32(header, static_cast<uint32_t>(static_cast<int32_t>(std::lround((bounds[1] + bounds[3]) / 2 * 1e7))));
+        header.insert(header.end(), root.begin(), root.end());
+
+        if (VSIFSeekL(fp, 0, SEEK_SET) != 0) throw std::runtime_error("Failed to write PMTiles output");
+        write(header);
+        VSILFILE* done = fp;
+        fp = nullptr;
+        if (VSIFCloseL(done) != 0) throw std::runtime_error("Failed to write PMTiles output");
+    }
+
+    std::string path;
+    VSILFILE* fp = nullptr;
+    std::vector<Entry> entries;
+    std::map<std::string, uint64_t> small;  // content of small tiles -> offset
+    uint64_t dataLength = 0;
+    uint64_t addressed = 0;
+    uint64_t contents = 0;
+};
+
+// MBTiles 1.3: a plain SQLite database with the metadata and tiles tables,
+// rows in XYZ order with TMS rows, gzipped MVT tile data
+struct MbtilesWriter : TileOutput {
+    explicit MbtilesWriter(const std::string& outPath) {
+        GDALDriver* sqlite = GetGDALDriverManager()->GetDriverByName("SQLite");
+        if (!sqlite) throw std::runtime_error("Driver not available: SQLite");
+        char** dsco = CSLSetNameValue(nullptr, "METADATA", "NO");
+        ds.reset(sqlite->Create(outPath.c_str(), 0, 0, 0, GDT_Unknown, dsco));
+        CSLDestroy(dsco);
+        if (!ds) throw std::runtime_error("Failed to create MBTiles output");
+        execute("CREATE TABLE metadata (name text, value text)");
+        execute("CREATE TABLE tiles (zoom_level integer, tile_column integer, tile_row integer, tile_data blob)");
+        if (ds->StartTransaction() != OGRERR_NONE) throw std::runtime_error("Failed to write MBTiles output");
+    }
+
+    void execute(const std::string& sql) {
+        CPLErrorReset();
+        OGRLayer* result = ds->ExecuteSQL(sql.c_str(), nullptr, nullptr);
+        if (result) ds->ReleaseResultSet(result);
+        if (CPLGetLastErrorType() >= CE_Failure) {
+            throw std::runtime_error(std::string("Failed to write MBTiles output: ") + CPLGetLastErrorMsg());
+        }
+    }
+
+    void writeTile(int z, uint32_t x, uint32_t y, uint64_t, const std::vector<GByte>& data) override {
+        static const char* hex = "0123456789ABCDEF";
+        sql.assign(CPLSPrintf("INSERT INTO tiles VALUES (%d, %u, %u, X'", z, x, ((uint32_t(1) << z) - 1) - y));
+        for (GByte b : data) {
+            sql += hex[b >> 4];
+            sql += hex[b & 15];
+        }
+        sql += "')";
+        execute(sql);
+    }
+
+    void metadata(const char* name, const std::string& value) {
+        sql = "INSERT INTO metadata VALUES (";
+        appendSqlStringLiteral(sql, name);
+        sql += ", ";
+        appendSqlStringLiteral(sql, value);
+        sql += ")";
+        execute(sql);
+    }
+
+    void finish(const TileSet& tiles, const std::string& name) {
+        execute("CREATE UNIQUE INDEX tile_index ON tiles (zoom_level, tile_column, tile_row)");
+        double b[4];
+        tiles.bounds(b);
+        metadata("name", name);
+        metadata("format", "pbf");
+        metadata("type", "overlay");
+        metadata("version", "2");
+        metadata("minzoom", std::to_string(tiles.minZoom));
+        metadata("maxzoom", std::to_string(tiles.maxZoom));
+        metadata("bounds", CPLSPrintf("%.7f,%.7f,%.7f,%.7f", b[0], b[1], b[2], b[3]));
+        metadata("center", CPLSPrintf("%.7f,%.7f,%d", (b[0] + b[2]) / 2, (b[1] + b[3]) / 2, tiles.minZoom));
+        metadata("json", "{\"vector_layers\":" + tiles.vectorLayersJson() + "}");
+        if (ds->CommitTransaction() != OGRERR_NONE) throw std::runtime_error("Failed to write MBTiles output");
+        ds.reset();
+    }
+
+    DatasetPtr ds;
+    std::string sql;
+};
+
+// ----------------- feature pump -----------------
+// In-process counterpart of GDALVectorTranslate: the features of a source layer are
+// read once, run through the plan's geometry options in batches and fanned out to
+// one or more sink layers (the shapefile splitter, or a single output layer).
+
+// features written per transaction on drivers that have them (ogr2ogr's -gt default)
+static const GIntBig TRANSACTION_FEATURES = 100000;
+
+// upserts: the target feature an input feature replaces, by FID or by the
+// value of a key field (looked up for a whole pump batch, see prefetchUpsertKeys)
+struct UpsertIndex {
+    OGRLayer* target = nullptr;
+    int sourceKey = -1;         // key field of the source layer, -1: match FIDs
+    int targetKey = -1;         // key field of the target layer
+    std::string keyColumn;      // quoted key column, "" for FID upserts
+    std::map<std::string, GIntBig> fids;        // target FIDs of the current batch's keys
+    FeaturePtr keyScratch;      // parses source keys into the target's key type
+    GIntBig replaced = 0;
+};
+
+// keys per lookup statement of prefetchUpsertKeys
+static const size_t UPSERT_LOOKUP_KEYS = 256;
+
+static std::string sqlIdentifier(const std::string& name) {
+    std::string out = "\"";
+    for (char c : name) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// key of src as the target column prints it: SQLite compares with the column's
+// affinity, the batch map compares text, so numeric keys are parsed into the
+// target's field type first ("1.0" and "1" are the same integer key)
+static std::string upsertKeyOf(UpsertIndex& index, const OGRFeature* src) {
+    const char* value = src->GetFieldAsString(index.sourceKey);
+    if (index.target->GetLayerDefn()->GetFieldDefn(index.targetKey)->GetType() == OFTString) return value;
+    if (!index.keyScratch) index.keyScratch.reset(OGRFeature::CreateFeature(index.target->GetLayerDefn()));
+    index.keyScratch->SetField(index.targetKey, value);
+    return index.keyScratch->GetFieldAsString(index.targetKey);
+}
+
+// FID of the target feature src replaces, OGRNullFID when it is new
+static GIntBig upsertTargetFid(UpsertIndex& index, const OGRFeature* src) {
+    if (index.sourceKey < 0) {
+        if (src->GetFID() == OGRNullFID) return OGRNullFID;
+        FeaturePtr existing(index.target->GetFeature(src->GetFID()));
+        return existing ? src->GetFID() : OGRNullFID;
+    }
+    if (!src->IsFieldSetAndNotNull(index.sourceKey)) return OGRNullFID;
+    auto it = index.fids.find(upsertKeyOf(index, src));
+    return it != index.fids.end() ? it->second : OGRNullFID;
+}
+
+// a feature created by the upsert: later features of the batch with its key replace it
+static void noteUpsertKey(UpsertIndex& index, const OGRFeature* src, GIntBig fid) {
+    if (index.sourceKey < 0 || !src->IsFieldSetAndNotNull(index.sourceKey)) return;
+    index.fids[upsertKeyOf(index, src)] = fid;
+}
+
+struct FeatureSink {
+    std::string name;
+    OGRLayer* layer = nullptr;
+    GeoJsonWriter* geojson = nullptr;           // written by the fast GeoJSON writer instead of layer
+    TileSet* tiles = nullptr;                   // stored for the native tiler instead, as tileLayer
+    size_t tileLayer = 0;
+    std::vector<int> fieldMap;
+    OGRwkbGeometryType promoteTo = wkbUnknown;  // wkbMultiLineString/wkbMultiPolygon: force multi
+    bool preserveFid = false;
+    bool failFast = false;      // a failed write aborts the conversion instead of closing this sink
+    bool failed = false;
+    GDALDataset* transactionDs = nullptr;       // set while a transaction is open
+    GIntBig transactionWrites = 0;
+    FeaturePtr scratch;         // destination feature, reset and reused for every write
+    UpsertIndex* upsert = nullptr;              // set: replace matching target features
+};
+
+// picks the sink of each source feature; nullptr drops the feature
+struct SinkRouter {
+    virtual ~SinkRouter() {}
+    virtual FeatureSink* route(const OGRGeometry* srcGeom) = 0;
+};
+
+struct SingleSinkRouter : SinkRouter {
+    explicit SingleSinkRouter(FeatureSink& s) : sink(s) {}
+    FeatureSink* route(const OGRGeometry*) override { return &sink; }
+    FeatureSink& sink;
+};
+
+struct PumpOptions {
+    GeometryOptions geometry;
+    bool explodeCollections = false;
+    bool skipFailures = false;
+    std::string where;          // OGR SQL attribute filter, "" for none
+    bool spatialFilter = false;
+    OGREnvelope bbox;           // spatial filter in source layer coordinates
+};
+
+static void beginSinkTransaction(FeatureSink& sink, GDALDataset* ds) {
+    if (ds->TestCapability(ODsCTransactions) && ds->StartTransaction() == OGRERR_NONE) {
+        sink.transactionDs = ds;
+        sink.transactionWrites = 0;
+    }
+}
+
+static void commitSinkTransaction(FeatureSink& sink) {
+    if (!sink.transactionDs) return;
+    GDALDataset* ds = sink.transactionDs;
+    sink.transactionDs = nullptr;
+    if (ds->CommitTransaction() != OGRERR_NONE) {
+        throw std::runtime_error("Failed to commit features to layer " + sink.name);
+    }
+}
+
+// geom is already prepared (see flushPumpParts); takes ownership
+static bool writeSinkFeature(FeatureSink& sink, const OGRFeature* src, OGRGeometry* geom) {
+    GeometryPtr g(geom);
+    if (sink.geojson) return sink.geojson->writeFeature(src, g.get(), sink.preserveFid);
+    if (sink.tiles) return sink.tiles->add(sink.tileLayer, src, g.get());
+    if (g && sink.promoteTo == wkbMultiLineString) g.reset(OGRGeometryFactory::forceToMultiLineString(g.release()));
+    if (g && sink.promoteTo == wkbMultiPolygon) g.reset(OGRGeometryFactory::forceToMultiPolygon(g.release()));
+
+#if GDAL_VERSION_NUM >= GDAL_COMPUTE_VERSION(3, 5, 0)
+    if (sink.scratch) sink.scratch->Reset();
+    else sink.scratch.reset(OGRFeature::CreateFeature(sink.layer->GetLayerDefn()));
+#else
+    sink.scratch.reset(OGRFeature::CreateFeature(sink.layer->GetLayerDefn()));
+#endif
+    OGRFeature* dst = sink.scratch.get();
+    dst->SetFrom(src, sink.fieldMap.data(), TRUE);
+    dst->SetGeometryDirectly(g.release());
+    dst->SetFID(sink.preserveFid ? src->GetFID() : OGRNullFID);
+    const GIntBig replaces = sink.upsert ? upsertTargetFid(*sink.upsert, src) : OGRNullFID;
+    if (replaces != OGRNullFID) {
+        dst->SetFID(replaces);
+        if (sink.layer->SetFeature(dst) != OGRERR_NONE) return false;
+        sink.upsert->replaced++;
+    } else if (sink.layer->CreateFeature(dst) != OGRERR_NONE) {
+        return false;
+    } else if (sink.upsert) {
+        noteUpsertKey(*sink.upsert, src, dst->GetFID());
+    }
+
+    if (sink.transactionDs && ++sink.transactionWrites >= TRANSACTION_FEATURES) {
+        GDALDataset* ds = sink.transactionDs;
+        commitSinkTransaction(sink);
+        beginSinkTransaction(sink, ds);
+    }
+    return true;
+}
+
+// feature parts are prepared and reprojected in batches of this size
+static const size_t PUMP_BATCH_FEATURES = 512;
+static const size_t PUMP_BATCH_POINTS = 65536;
+
+// a geometry waiting for the batched reprojection, with the feature it came from
+struct PendingPart {
+    size_t feature;             // index into the batch's source features
+    FeatureSink* sink;
+    GeometryPtr geom;
+    bool hasGeometry;           // false: the feature is written without geometry
+};
+
+// MakeValid/simplify parts per pool thread at least
+static const size_t PREPARE_PARTS_PER_THREAD = 8;
+
+// threads for the makeValid/simplify stage (1 when there is nothing to do or no pool)
+static size_t geometryThreadCount(const GeometryOptions& opts) {
+    if (opts.makeValid || opts.simplifyTolerance > 0) return g_threadPool.threads();
+    return 1;
+}
+
+// makeValid/simplify of the pending parts. GEOS dominates on large polygons, so
+// the parts are spread over the thread pool when there is one; each result goes
+// back to its own slot, which keeps the write order.
+static void prepareGeometrySources(ArenaVector<PendingPart>& pending, const GeometryOptions& opts) {
+    auto prepare = [&](PendingPart& p) {
+        if (p.sink->failed) p.geom.reset();
+        else if (p.geom) p.geom.reset(prepareGeometrySource(p.geom.release(), opts));
+    };
+
+    const size_t nThreads = geometryThreadCount(opts);
+    if (nThreads > 1 && pending.size() >= 2 * PREPARE_PARTS_PER_THREAD) {
+        // failures show up as null geometries
+        g_threadPool.parallelFor(pending.size(), [&](size_t i) { prepare(pending[i]); });
+        return;
+    }
+    for (auto& p : pending) prepare(p);
+}
+
+// target FIDs of the keys of one batch, with one "key IN (...)" query per
+// UPSERT_LOOKUP_KEYS keys instead of an attribute filter and a read per feature
+// (FID upserts stay GetFeature lookups on the primary key)
+static void prefetchUpsertKeys(UpsertIndex& index, const ArenaVector<PendingPart>& pending,
+                               const ArenaVector<FeaturePtr>& features) {
+    index.fids.clear();
+    if (index.sourceKey < 0) return;
+
+    // the keys and the lookup statements are gone once the batch is indexed
+    ArenaFrame frame;
+    ArenaVector<JobString> keys;
+    for (const PendingPart& p : pending) {
+        if (p.sink->upsert != &index || p.sink->failed) continue;
+        const OGRFeature* src = features[p.feature].get();
+        if (!src->IsFieldSetAndNotNull(index.sourceKey)) continue;
+        const std::string key = upsertKeyOf(index, src);
+        keys.emplace_back(key.data(), key.size());
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    for (size_t begin = 0; begin < keys.size(); begin += UPSERT_LOOKUP_KEYS) {
+        const size_t end = std::min(keys.size(), begin + UPSERT_LOOKUP_KEYS);
+        // quoted even for numeric keys: SQLite applies the column's affinity
+        JobString filter(index.keyColumn.begin(), index.keyColumn.end());
+        filter += " IN (";
+        for (size_t i = begin; i < end; i++) {
+            if (i > begin) filter += ',';
+            appendSqlStringLiteral(filter, keys[i]);
+        }
+        filter += ')';
+        if (index.target->SetAttributeFilter(filter.c_str()) != OGRERR_NONE) {
+            index.target->SetAttributeFilter(nullptr);
+            throw std::runtime_error("Failed to look up the upsert keys of layer " +
+                                     std::string(index.target->GetName()));
+        }
+        index.target->ResetReading();
+        for (FeaturePtr f(index.target->GetNextFeature()); f; f.reset(index.target->GetNextFeature())) {
+            if (f->IsFieldSetAndNotNull(index.targetKey)) {
+                index.fids.emplace(f->GetFieldAsString(index.targetKey), f->GetFID());
+            }
+        }
+    }
+    // done with the lookup statement before the writes
+    if (!keys.empty()) index.target->SetAttributeFilter(nullptr);
+}
+
+// prepare, reproject (in one batch) and write the pending parts, in read order;
+// features holds the source features the parts refer to, dropped once written
+static void flushPumpParts(ArenaVector<PendingPart>& pending,
+                           ArenaVector<FeaturePtr>& features,
+                           ReprojectionBatch* batch,
+                           const PumpOptions& opts)
+{
+    prepareGeometrySources(pending, opts.geometry);
+
+    if (batch) {
+        std::vector<OGRGeometry*> geoms;
+        geoms.reserve(pending.size());
+        for (auto& p : pending) geoms.push_back(p.geom.get());
+        std::vector<bool> ok;
+        reprojectGeometries(*batch, geoms, ok);
+        for (size_t i = 0; i < pending.size(); i++) {
+            if (!ok[i]) pending[i].geom.reset();
+        }
+    }
+
+    // the update pump writes to a single sink, so one lookup covers the batch
+    if (!pending.empty() && pending.front().sink->upsert) {
+        prefetchUpsertKeys(*pending.front().sink->upsert, pending, features);
+    }
+
+    for (auto& p : pending) {
+        FeatureSink& sink = *p.sink;
+        if (sink.failed) continue;
+        const OGRFeature* src = features[p.feature].get();
+        bool written = false;
+        if (p.geom) {
+            finishGeometry(p.geom.get(), opts.geometry);
+            written = writeSinkFeature(sink, src, p.geom.release());
+        } else if (!p.hasGeometry) {
+            written = writeSinkFeature(sink, src, nullptr);
+        }
+        if (!written && !opts.skipFailures) {
+            if (sink.failFast) {
+                throw std::runtime_error("Failed to write feature " + std::to_string(src->GetFID()) +
+                                         " to layer " + sink.name);
+            }
+            // like a failed ogr2ogr run: keep what was written so far and stop this sink
+            sink.failed = true;
+        }
+    }
+    pending.clear();
+    features.clear();
+}
+
+static size_t vertexCountOf(const OGRGeometry* g) {
+    size_t n = 0;
+    forEachVertexArray(const_cast<OGRGeometry*>(g),
+                       [&](OGRSimpleCurve* c) { n += c->getNumPoints(); },
+                       [&](OGRPoint*) { n++; });
+    return n;
+}
+
+// sets an attribute filter for the lifetime of the scope (session datasets are reused)
+struct AttributeFilterScope {
+    AttributeFilterScope(OGRLayer* l, const std::string& where) : layer(l) {
+        if (where.empty()) return;
+        if (layer->SetAttributeFilter(where.c_str()) != OGRERR_NONE) {
+            layer->SetAttributeFilter(nullptr);
+            throw std::runtime_error("Invalid where clause: " + where);
+        }
+        active = true;
+    }
+    ~AttributeFilterScope() {
+        if (active) layer->SetAttributeFilter(nullptr);
+    }
+    OGRLayer* layer;
+    bool active = false;
+};
+
+// sets a bbox spatial filter for the lifetime of the scope; indexed drivers
+// (GPKG R-tree, FlatGeobuf, Shapefile .qix) then skip the other features
+// without decoding them, the rest reject them on their envelope first
+struct SpatialFilterScope {
+    SpatialFilterScope(OGRLayer* l, const PumpOptions& opts) : layer(l) {
+        if (!opts.spatialFilter) return;
+        layer->SetSpatialFilterRect(opts.bbox.MinX, opts.bbox.MinY, opts.bbox.MaxX, opts.bbox.MaxY);
+        active = true;
+    }
+    ~SpatialFilterScope() {
+        if (active) layer->SetSpatialFilter(nullptr);
+    }
+    OGRLayer* layer;
+    bool active = false;
+};
+
+// read srcLayer once; all parts of an exploded collection go to the sink of its feature
+static void pumpLayer(OGRLayer* srcLayer, const PumpOptions& opts, SinkRouter& router) {
+    AttributeFilterScope filter(srcLayer, opts.where);
+    SpatialFilterScope spatialFilter(srcLayer, opts);
+
+    ReprojectionBatch batch;
+    if (opts.geometry.transform) initReprojectionBatch(batch, opts.geometry.transform);
+    ReprojectionBatch* batchPtr = opts.geometry.transform ? &batch : nullptr;
+
+    // larger batches when the makeValid/simplify stage runs on several threads
+    const size_t geometryThreads = geometryThreadCount(opts.geometry);
+    const size_t batchFeatures = PUMP_BATCH_FEATURES * geometryThreads;
+    const size_t batchPoints = PUMP_BATCH_POINTS * geometryThreads;
+    const bool countPoints = batchPtr || geometryThreads > 1;
+
+    // both lists keep their capacity between batches; the parts of an exploded
+    // collection share the index of their feature
+    ArenaVector<FeaturePtr> features;
+    ArenaVector<PendingPart> pending;
+    features.reserve(batchFeatures);
+    pending.reserve(batchFeatures);
+    size_t pendingPoints = 0;
+
+    // progress is only a fraction when the layer can count cheaply (no extra pass)
+    GIntBig total = -1;
+    if (g_progress.enabled && srcLayer->TestCapability(OLCFastFeatureCount)) {
+        PhaseTimer timer(g_timings.count);
+        total = srcLayer->GetFeatureCount(TRUE);
+    }
+    GIntBig read = 0;
+
+    srcLayer->ResetReading();
+    for (FeaturePtr f(srcLayer->GetNextFeature()); f; f.reset(srcLayer->GetNextFeature())) {
+        // features the router drops never reach a flush, so poll here as well
+        if (++read % static_cast<GIntBig>(PUMP_BATCH_FEATURES) == 0) {
+            throwIfCancelled(total > 0 ? static_cast<double>(read) / total : -1, "translate");
+        }
+        FeatureSink* sink = router.route(f->GetGeometryRef());
+        if (!sink || sink->failed) continue;
+
+        GeometryPtr owned(f->StealGeometry());
+        const size_t src = features.size();
+        features.push_back(std::move(f));
+
+        if (!owned) {
+            pending.push_back({src, sink, nullptr, false});
+        } else {
+            pendingPoints += countPoints ? vertexCountOf(owned.get()) : 0;
+            if (opts.explodeCollections && OGR_GT_IsSubClassOf(wkbFlatten(owned->getGeometryType()), wkbGeometryCollection)) {
+                OGRGeometryCollection* coll = owned->toGeometryCollection();
+                for (int i = 0; i < coll->getNumGeometries(); i++) {
+                    pending.push_back({src, sink, GeometryPtr(coll->getGeometryRef(i)->clone()), true});
+                }
+            } else {
+                pending.push_back({src, sink, std::move(owned), true});
+            }
+        }
+
+        if (pending.size() >= batchFeatures || features.size() >= batchFeatures || pendingPoints >= batchPoints) {
+            flushPumpParts(pending, features, batchPtr, opts);
+            pendingPoints = 0;
+            memoryCheckpoint("translating");
+            throwIfCancelled(total > 0 ? static_cast<double>(read) / total : -1, "translate");
+        }
+    }
+    flushPumpParts(pending, features, batchPtr, opts);
+    throwIfCancelled(1, "translate");
+}
+
+// ----------------- shapefile splitter -----------------
+// A Shapefile holds one geometry family, so mixed layers are split into up to four
+// .shp sets, fed by a single pump over the source layer.
+enum ShpFamily { SHP_POINT, SHP_MULTIPOINT, SHP_LINES, SHP_POLYS, SHP_FAMILY_COUNT };
+
+// same families as WHERE_POINT/WHERE_MULTIPOINT/WHERE_LINES/WHERE_POLYS
+static int shpFamilyOf(OGRwkbGeometryType type) {
+    switch (wkbFlatten(type)) {
+        case wkbPoint:           return SHP_POINT;
+        case wkbMultiPoint:      return SHP_MULTIPOINT;
+        case wkbLineString:
+        case wkbMultiLineString: return SHP_LINES;
+        case wkbPolygon:
+        case wkbMultiPolygon:    return SHP_POLYS;
+        default:                 return -1;
+    }
+}
+
+struct ShpFamilyWriter {
+    GDALDataset* ds = nullptr;
+    FeatureSink sink;
+};
+
+// writers are created on the first feature of each family
+struct ShpFamilyRouter : SinkRouter {
+    ShpFamilyRouter(OGRLayer* srcLayer_, const std::string& baseDir_, const std::string& baseName_,
+                    const OGRSpatialReference* outSrs_, const std::vector<int>& fields_,
+                    const PumpOptions& opts_, bool preserveFid_)
+        : srcLayer(srcLayer_), baseDir(baseDir_), baseName(baseName_), outSrs(outSrs_),
+          fields(fields_), opts(opts_), preserveFid(preserveFid_) {}
+
+    ~ShpFamilyRouter() override {
+        for (auto& w : writers) {
+            if (w.ds) GDALClose(w.ds);
+        }
+    }
+
+    FeatureSink* route(const OGRGeometry* geom) override {
+        const int family = geom ? shpFamilyOf(geom->getGeometryType()) : -1;
+        if (family < 0) return nullptr;
+        ShpFamilyWriter& w = writers[family];
+        if (!w.sink.layer && !w.sink.failed && !open(w, family)) w.sink.failed = true;
+        return &w.sink;
+    }
+
+    bool open(ShpFamilyWriter& w, int family) {
+        static const char* suffixes[SHP_FAMILY_COUNT] = { "_point", "_multipoint", "_lines", "_polygons" };
+        OGRwkbGeometryType types[SHP_FAMILY_COUNT] = {
+            wkbPoint,
+            opts.explodeCollections ? wkbPoint : wkbMultiPoint,
+            wkbMultiLineString, // lines and polygons are promoted to multi
+            wkbMultiPolygon
+        };
+
+        GDALDriver* shpDriver = GetGDALDriverManager()->GetDriverByName("ESRI Shapefile");
+        if (!shpDriver) return false;
+
+        const std::string name = baseName + suffixes[family];
+        const std::string outPath = baseDir + "/" + name + ".shp";
+        w.ds = shpDriver->Create(outPath.c_str(), 0, 0, 0, GDT_Unknown, nullptr);
+        if (!w.ds) return false;
+
+        OGRwkbGeometryType layerType = types[family];
+        if (opts.geometry.keepZ) layerType = OGR_GT_SetZ(layerType);
+
+        char** lco = CSLSetNameValue(nullptr, "ENCODING", "UTF-8");
+        w.sink.name = name;
+        w.sink.layer = w.ds->CreateLayer(name.c_str(), outSrs, layerType, lco);
+        CSLDestroy(lco);
+        if (!w.sink.layer) return false;
+
+        w.sink.fieldMap = createFieldsLike(srcLayer->GetLayerDefn(), w.sink.layer, fields);
+        w.sink.preserveFid = preserveFid;
+        if (family == SHP_LINES) w.sink.promoteTo = wkbMultiLineString;
+        if (family == SHP_POLYS) w.sink.promoteTo = wkbMultiPolygon;
+        return true;
+    }
+
+    OGRLayer* srcLayer;
+    const std::string& baseDir;
+    const std::string& baseName;
+    const OGRSpatialReference* outSrs;
+    const std::vector<int>& fields;
+    const PumpOptions& opts;
+    bool preserveFid;
+    ShpFamilyWriter writers[SHP_FAMILY_COUNT];
+};
+
+static void splitLayerToShapefiles(OGRLayer* srcLayer,
+                                   const std::string& baseDir,
+                                   const std::string& baseName,
+                                   const OGRSpatialReference* outSrs,
+                                   const std::vector<int>& fields,
+                                   const PumpOptions& opts,
+                                   bool preserveFid)
+{
+    ShpFamilyRouter router(srcLayer, baseDir, baseName, outSrs, fields, opts, preserveFid);
+    pumpLayer(srcLayer, opts, router);
+}
+
+// describeDataset's notes on how it resolved the CRS and bbox, only kept with
+// debug logging on (setDebugLogging), so previews skip building them
+struct InfoDebug {
+    const bool enabled = g_debugLogging;
+    std::string text;
+    void note(const char* s) {
+        if (!enabled) return;
+        text += s;
+        text += "; ";
+    }
+    void note(const char* s, const std::string& value) {
+        if (!enabled) return;
+        text += s;
+        text += value;
+        text += "; ";
+    }
+};
+
+static bool transformExtentToWgs84(const OGREnvelope& extent,
+                                   const std::string& sourceCrs,
+                                   double& minX,
+                                   double& minY,
+                                   double& maxX,
+                                   double& maxY,
+                                   InfoDebug& debug)
+{
+    if (sourceCrs.empty()) {
+        debug.note("Source CRS is empty");
+        return false;
+    }
+
+    debug.note("Using source CRS: ", sourceCrs);
+
+    // Quick check: if the CRS string indicates WGS84/EPSG:4326, skip transformation
+    const JobString lowerCrs = toLower(sourceCrs);
+    if (lowerCrs == "epsg:4326" ||
+        lowerCrs == "wgs84" ||
+        lowerCrs == "wgs 84" ||
+        lowerCrs.find("wgs84") != std::string::npos ||
+        lowerCrs.find("wgs 84") != std::string::npos) {
+        debug.note("Already WGS84 (detected from CRS string), skipping");
+        return false;
+    }
+
+    SharedSrs srcSrs = cachedUserSrs(sourceCrs);
+    if (!srcSrs) {
+        debug.note("Failed to parse source CRS");
+        return false;
+    }
+
+    SharedSrs wgs84 = cachedUserSrs("WGS84");
+    if (!wgs84) {
+        debug.note("Failed to create WGS84 CRS");
+        return false;
+    }
+
+    if (srcSrs->IsSame(wgs84.get())) {
+        debug.note("Already WGS84, skipping");
+        return false;
+    }
+
+    struct SamplePoint {
+        double x;
+        double y;
+    };
+
+    const int steps = 8;
+    std::vector<SamplePoint> points;
+    points.reserve((steps + 1) * 4);
+    auto addEdge = [&](double x0, double y0, double x1, double y1) {
+        for (int i = 0; i <= steps; ++i) {
+            double t = static_cast<double>(i) / steps;
+            points.push_back({x0 + (x1 - x0) * t, y0 + (y1 - y0) * t});
+        }
+    };
+
+    addEdge(extent.MinX, extent.MinY, extent.MaxX, extent.MinY); // bottom
+    addEdge(extent.MaxX, extent.MinY, extent.MaxX, extent.MaxY); // right
+    addEdge(extent.MaxX, extent.MaxY, extent.MinX, extent.MaxY); // top
+    addEdge(extent.MinX, extent.MaxY, extent.MinX, extent.MinY); // left
+
+    TransformPtr transform = cachedTransform(srcSrs.get(), sourceCrs, wgs84.get(), "WGS84");
+
+    if (!transform) {
+        debug.note("OGRCreateCoordinateTransformation failed");
+        return false;
+    }
+
+    for (size_t i = 0; i < points.size(); ++i) {
+        double x = points[i].x;
+        double y = points[i].y;
+        if (!transform->Transform(1, &x, &y)) {
+            if (debug.enabled) debug.note("OGR transform failed at point ", std::to_string(i));
+            return false;
+        }
+        points[i].x = x;
+        points[i].y = y;
+    }
+
+    auto minMaxX = std::minmax_element(points.begin(), points.end(),
+        [](const SamplePoint& a, const SamplePoint& b) { return a.x < b.x; });
+    auto minMaxY = std::minmax_element(points.begin(), points.end(),
+        [](const SamplePoint& a, const SamplePoint& b) { return a.y < b.y; });
+    minX = minMaxX.first->x;
+    maxX = minMaxX.second->x;
+    minY = minMaxY.first->y;
+    maxY = minMaxY.second->y;
+
+    debug.note("OGR reprojection successful");
+    return true;
+}
+
+// ----------------- main API -----------------
+// probe mode reads at most this many features when the driver has no cheap count/extent
+static const int PROBE_SAMPLE_FEATURES = 1000;
+
+struct LayerSummary {
+    GIntBig featureCount = 0;
+    bool featureCountExact = true;
+    OGREnvelope extent;
+    bool hasExtent = false;
+    bool extentExact = true;
+};
+
+// feature count and extent of a layer. exact=false only uses what the driver
+// knows without a scan (FlatGeobuf/GPKG/Shapefile headers, indexes) and falls
+// back to the first PROBE_SAMPLE_FEATURES features for the rest.
+static LayerSummary summarizeLayer(OGRLayer* poLayer, bool exact) {
+    LayerSummary sum;
+    if (exact) {
+        sum.featureCount = poLayer->GetFeatureCount();
+        sum.hasExtent = poLayer->GetExtent(&sum.extent, TRUE) == OGRERR_NONE;
+        return sum;
+    }
+
+    sum.featureCount = poLayer->GetFeatureCount(FALSE);
+    sum.hasExtent = poLayer->GetExtent(&sum.extent, FALSE) == OGRERR_NONE;
+    const bool needCount = sum.featureCount < 0;
+    if (!needCount && sum.hasExtent) return sum;
+
+    GIntBig sampled = 0;
+    bool reachedEnd = false;
+    OGREnvelope sampleExtent;
+    bool sampleHasExtent = false;
+
+    poLayer->ResetReading();
+    while (true) {
+        if (sampled >= PROBE_SAMPLE_FEATURES) break;
+        FeaturePtr f(poLayer->GetNextFeature());
+        if (!f) {
+            reachedEnd = true;
+            break;
+        }
+        sampled++;
+        const OGRGeometry* g = f->GetGeometryRef();
+        if (g && !g->IsEmpty()) {
+            OGREnvelope env;
+            g->getEnvelope(&env);
+            sampleExtent.Merge(env);
+            sampleHasExtent = true;
+        }
+    }
+    poLayer->ResetReading();
+
+    if (needCount) {
+        sum.featureCount = sampled;          // a lower bound unless the layer ended
+        sum.featureCountExact = reachedEnd;
+    }
+    if (!sum.hasExtent && sampleHasExtent) {
+        sum.extent = sampleExtent;
+        sum.hasExtent = true;
+        sum.extentExact = reachedEnd;
+    }
+    return sum;
+}
+
+// the first feature's value of a field, as describeDataset reports it
+enum InfoValueType : uint8_t {
+    INFO_INTEGER = 1,
+    INFO_FLOAT = 2,
+    INFO_STRING = 3,
+    INFO_DATE = 4
+};
+
+struct InfoProperty {
+    std::string name;
+    InfoValueType type = INFO_STRING;
+    bool isNull = true;
+    GIntBig integer = 0;
+    double real = 0;
+    std::string text;       // strings and dates
+};
+
+// what describeDataset reports about the first layer, for the JSON and the
+// binary encodings
+struct DatasetInfo {
+    int layers = 0;
+    bool hasLayer = false;
+    bool probe = false;     // exact=false: the Exact flags are reported
+    GIntBig featureCount = 0;
+    bool featureCountExact = true;
+    bool bboxExact = true;
+    std::string geometryType = "Unknown";
+    std::string crs = "Unknown";
+    bool hasBbox = false;
+    bool bboxReprojected = false;
+    double bboxOriginal[4] = {0, 0, 0, 0};
+    double bbox[4] = {0, 0, 0, 0};      // in WGS84 when bboxReprojected
+    InfoDebug debugCrs;
+    InfoDebug debugTransform;
+    std::vector<InfoProperty> properties;   // empty: the layer has no features
+    std::string layerName;
+    std::vector<const OGRFieldDefn*> fields;    // the layer's schema (JSON only)
+};
+
+static InfoValueType infoValueType(OGRFieldType type) {
+    switch (type) {
+        case OFTInteger:
+        case OFTInteger64:
+            return INFO_INTEGER;
+        case OFTReal:
+            return INFO_FLOAT;
+        case OFTDate:
+        case OFTDateTime:
+            return INFO_DATE;
+        default:
+            return INFO_STRING;
+    }
+}
+
+// metadata of the first layer of an opened dataset
+static void collectDatasetInfo(GDALDataset* poDS, const std::string& sourceCrs, bool exact, DatasetInfo& info) {
+    info.layers = poDS->GetLayerCount();
+    info.probe = !exact;
+    OGRLayer* poLayer = info.layers > 0 ? poDS->GetLayer(0) : nullptr;
+    if (!poLayer) return;
+    info.hasLayer = true;
+    info.layerName = poLayer->GetName();
+    OGRFeatureDefn* poFDefn = poLayer->GetLayerDefn();
+    for (int i = 0; i < poFDefn->GetFieldCount(); i++) info.fields.push_back(poFDefn->GetFieldDefn(i));
+
+    // Feature count (and extent, used below)
+    const LayerSummary summary = summarizeLayer(poLayer, exact);
+    info.featureCount = summary.featureCount;
+    info.featureCountExact = summary.featureCountExact;
+    info.bboxExact = summary.extentExact;
+
+    // Geometry type from layer definition
+    info.geometryType = OGRGeometryTypeToName(poLayer->GetGeomType());
+
+    // CRS/SRS - use user-provided sourceCrs if available, otherwise detect
+    const OGRSpatialReference* srs = poLayer->GetSpatialRef();
+    SharedSrs userSrs;
+    InfoDebug& debugInfo = info.debugCrs;
+
+    if (debugInfo.enabled) {
+        const char* projLib = CPLGetConfigOption("PROJ_LIB", nullptr);
+        if (projLib) debugInfo.note("PROJ_LIB=", projLib);
+        else debugInfo.note("PROJ_LIB not set");
+    }
+
+    // If user provided a source CRS, use it for reprojection
+    if (!sourceCrs.empty()) {
+        debugInfo.note("User provided sourceCrs: ", sourceCrs);
+
+        // importFromEPSG for EPSG:n, SetFromUserInput otherwise (parsed once, then cached)
+        userSrs = cachedUserSrs(sourceCrs);
+        if (userSrs) {
+            srs = userSrs.get();
+            debugInfo.note("Successfully set user CRS");
+        } else {
+            // Still use sourceCrs for PROJ transformation even though GDAL
+            // couldn't create an OGRSpatialReference from it
+            debugInfo.note("GDAL CRS methods failed, but will try PROJ for transform");
+        }
+        info.crs = sourceCrs; // Display what user selected
+    } else {
+        debugInfo.note("No sourceCrs provided");
+    }
+
+    // If no user CRS was provided at all, use layer's CRS
+    if (sourceCrs.empty() && srs) {
+        const char* authName = srs->GetAuthorityName(nullptr);
+        const char* authCode = srs->GetAuthorityCode(nullptr);
+        if (authName && authCode) {
+            info.crs = std::string(authName) + ":" + std::string(authCode);
+            debugInfo.note("Using layer CRS: ", info.crs);
+        } else {
+            char* wkt = nullptr;
+            srs->exportToWkt(&wkt);
+            if (wkt) {
+                info.crs = std::string(wkt).substr(0, 50); // Truncate for brevity
+                debugInfo.note("Using layer CRS from WKT");
+                CPLFree(wkt);
+            }
+        }
+    }
+
+    // Bounding box (extent)
+    if (summary.hasExtent) {
+        const OGREnvelope& extent = summary.extent;
+        info.hasBbox = true;
+        const double original[4] = {extent.MinX, extent.MinY, extent.MaxX, extent.MaxY};
+        std::copy(original, original + 4, info.bboxOriginal);
+        std::copy(original, original + 4, info.bbox);
+
+        // Prefer user-provided sourceCrs, otherwise use layer's CRS
+        const std::string transformSourceCrs = sourceCrs.empty() ? info.crs : sourceCrs;
+        info.bboxReprojected = transformExtentToWgs84(extent, transformSourceCrs,
+                                                      info.bbox[0], info.bbox[1], info.bbox[2], info.bbox[3],
+                                                      info.debugTransform);
+    }
+
+    // Properties from first feature
+    poLayer->ResetReading();
+    FeaturePtr poFeature(poLayer->GetNextFeature());
+    if (!poFeature) return;
+
+    const int fieldCount = poFDefn->GetFieldCount();
+    info.properties.resize(fieldCount);
+    for (int i = 0; i < fieldCount; i++) {
+        OGRFieldDefn* poFieldDefn = poFDefn->GetFieldDefn(i);
+        InfoProperty& prop = info.properties[i];
+        prop.name = poFieldDefn->GetNameRef();
+        if (poFeature->IsFieldNull(i) || !poFeature->IsFieldSet(i)) continue;
+
+        prop.isNull = false;
+        prop.type = infoValueType(poFieldDefn->GetType());
+        switch (prop.type) {
+            case INFO_INTEGER:
+                prop.integer = poFeature->GetFieldAsInteger64(i);
+                break;
+            case INFO_FLOAT:
+                prop.real = poFeature->GetFieldAsDouble(i);
+                break;
+            default:
+                prop.text = poFeature->GetFieldAsString(i);
+                break;
+        }
+    }
+}
+
+static const char* infoValueTypeName(InfoValueType type) {
+    switch (type) {
+        case INFO_INTEGER: return "Integer";
+        case INFO_FLOAT: return "Float";
+        case INFO_DATE: return "Date";
+        default: return "String";
+    }
+}
+
+static void appendJsonNumbers(std::string& json, const double* values, int count) {
+    json += "[";
+    for (int i = 0; i < count; i++) {
+        if (i > 0) json += ",";
+        json += std::to_string(values[i]);
+    }
+    json += "]";
+}
+
+// metadata JSON describing the first layer of an opened dataset
+static std::string describeDataset(GDALDataset* poDS, const std::string& sourceCrs, bool exact = true) {
+    DatasetInfo info;
+    collectDatasetInfo(poDS, sourceCrs, exact, info);
+
+    std::string json = "{";
+    json += "\"layers\":" + std::to_string(info.layers) + ",";
+
+    if (info.hasLayer) {
+        json += "\"layerName\":\"" + escapeJsonString(info.layerName) + "\",";
+        json += "\"featureCount\":" + std::to_string(info.featureCount) + ",";
+        if (info.probe) {
+            json += std::string("\"featureCountExact\":") + (info.featureCountExact ? "true" : "false") + ",";
+            json += std::string("\"bboxExact\":") + (info.bboxExact ? "true" : "false") + ",";
+        }
+        json += "\"geometryType\":\"" + escapeJsonString(info.geometryType) + "\",";
+        json += "\"crs\":\"" + escapeJsonString(info.crs) + "\",";
+        if (info.debugCrs.enabled) {
+            json += "\"debugCrs\":\"" + escapeJsonString(info.debugCrs.text) + "\",";
+        }
+
+        // the schema as GDAL types, e.g. to compare drivers and engines
+        json += "\"fields\":[";
+        for (size_t i = 0; i < info.fields.size(); i++) {
+            const OGRFieldDefn* fld = info.fields[i];
+            if (i > 0) json += ",";
+            json += "{\"name\":\"" + escapeJsonString(fld->GetNameRef()) + "\",";
+            json += std::string("\"type\":\"") + OGRFieldDefn::GetFieldTypeName(fld->GetType()) + "\",";
+            json += std::string("\"subType\":\"") + OGRFieldDefn::GetFieldSubTypeName(fld->GetSubType()) + "\"}";
+        }
+        json += "],";
+
+        if (info.hasBbox) {
+            json += "\"bboxOriginal\":";
+            appendJsonNumbers(json, info.bboxOriginal, 4);
+            json += std::string(",\"bboxReprojected\":") + (info.bboxReprojected ? "true" : "false") + ",";
+            if (info.debugTransform.enabled) {
+                json += "\"debugTransform\":\"" + escapeJsonString(info.debugTransform.text) + "\",";
+            }
+            json += "\"bbox\":";
+            appendJsonNumbers(json, info.bbox, 4);
+            json += ",";
+        }
+    }
+
+    json += "\"properties\":[";
+    for (size_t i = 0; i < info.properties.size(); i++) {
+        const InfoProperty& prop = info.properties[i];
+        if (i > 0) json += ",";
+        json += "{\"name\":\"" + escapeJsonString(prop.name) + "\",\"value\":";
+        if (prop.isNull) {
+            json += "null";
+        } else if (prop.type == INFO_INTEGER) {
+            json += std::to_string(prop.integer);
+        } else if (prop.type == INFO_FLOAT) {
+            json += std::to_string(prop.real);
+        } else {
+            json += "\"" + escapeJsonString(prop.text) + "\"";
+        }
+        json += std::string(",\"type\":\"") + infoValueTypeName(prop.isNull ? INFO_STRING : prop.type) + "\"}";
+    }
+    json += "]}";
+    return json;
+}
+
+static std::string infoErrorJson(const std::exception& ex) {
+    ensureLastErrorMessage();
+    if (g_lastError.empty() && ex.what()) {
+        g_lastError = ex.what();
+    }
+    return "{\"error\":\"" + std::string(ex.what()) + "\"}";
+}
+
+static std::string getVectorInfoImpl(
+    const GByte* inputData,
+    size_t inputSize,
+    const std::string& inputFormat,
+    const std::string& sourceCrs
+) {
+    ensureInitialized();
+    resetLastError();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+
+    CPLPushErrorHandler(ErrHandler);
+
+    std::string result = "{}";
+    std::string inputMemFile;
+    JobScope job;
+
+    try {
+        // Materialize input in /vsimem
+        const std::string inFmt = heapString(toLower(inputFormat));
+        const std::string inputPath = materializeInput(inputData, inputSize, inFmt,
+                                                       job.path("preview_input"), inputMemFile);
+
+        // Open dataset
+        DatasetPtr poDS(openInputDataset(inputPath, inFmt));
+        result = describeDataset(poDS.get(), sourceCrs);
+    } catch (const std::exception& ex) {
+        result = infoErrorJson(ex);
+    }
+
+    if (!inputMemFile.empty()) {
+        VSIUnlink(inputMemFile.c_str());
+    }
+
+    CPLPopErrorHandler();
+    return result;
+}
+
+std::string Native::getVectorInfo(
+    const std::vector<uint8_t>& inputData,
+    const std::string& inputFormat,
+    const std::string& sourceCrs
+) {
+    return getVectorInfoImpl(inputData.data(), inputData.size(), inputFormat, sourceCrs);
+}
+
+// GPX auxiliary layers (*_points) only repeat the vertices of tracks/routes
+static bool isGpxAuxiliaryLayer(const std::string& layerName) {
+    const JobString lower = toLower(layerName);
+    return lower == "track_points" || lower == "route_points";
+}
+
+// true when translateDataset writes one set of files per source layer, which
+// is what lets the layers be converted independently (convertSessionLayer)
+static bool convertsPerLayer(const std::string& inFmt, const ConversionPlan& opt) {
+    const std::string driver = getDriverNameFromFormat(opt.outputFormat);
+    if (driver == "ESRI Shapefile") return true;
+    if (driver == "OpenFileGDB" || driver == "MapInfo File") return false;
+    return inFmt == "gpx" && opt.layerName.empty() && opt.geometryTypeFilter.empty();
+}
+
+// options of the feature pump for one layer of a plan
+static PumpOptions pumpOptionsFor(const ConversionPlan& plan, OGRLayer* L, OGRCoordinateTransformation* transform) {
+    PumpOptions opts;
+    opts.geometry.makeValid = plan.makeValid;
+    opts.geometry.keepZ = plan.keepZ;
+    opts.geometry.simplifyTolerance = plan.simplifyTolerance;
+    opts.geometry.transform = transform;
+    opts.explodeCollections = plan.explodeCollections;
+    opts.skipFailures = plan.skipFailures;
+    opts.where = planWhere(plan);
+    opts.spatialFilter = layerSpatialFilter(L, plan, opts.bbox);
+    return opts;
+}
+
+// shapefile output: one pass over the layer feeds up to 4 shapefiles in baseDir
+static void convertLayerToShapefiles(OGRLayer* L, const std::string& baseDir, const ConversionPlan& opt) {
+    const std::string baseName = opt.layerName.empty() ? std::string(L->GetName()) : opt.layerName;
+
+    LayerCrsPlan crs;
+    planLayerCrs(L, opt.sourceCrs, opt.targetCrs, crs);
+
+    splitLayerToShapefiles(L, baseDir, baseName, crs.outSrs,
+                           selectedFields(L->GetLayerDefn(), opt.selectFields),
+                           pumpOptionsFor(opt, L, crs.transform.get()), opt.preserveFid);
+}
+
+// output drivers the feature pump writes itself; the others (and plans with
+// useTranslate) go through GDALVectorTranslate
+static bool pumpWritesDriver(const std::string& driver) {
+    return driver == "GeoJSON" || driver == "GeoJSONSeq" || driver == "FlatGeobuf" ||
+           driver == "GPKG" || driver == "CSV" || driver == "MapInfo File" ||
+           driver == "OpenFileGDB" || driver == "Parquet" || driver == "Arrow" ||
+           writesVectorTiles(driver);
+}
+
+// like ogr2ogr: drivers with a FID layer creation option keep the source FIDs
+static bool driverHasFidOption(GDALDriver* drv) {
+    const char* list = drv->GetMetadataItem(GDAL_DS_LAYER_CREATIONOPTIONLIST);
+    return list && strstr(list, "name='FID'") != nullptr;
+}
+
+// output geometry type of a pumped layer
+static OGRwkbGeometryType pumpLayerGeomType(OGRLayer* L, const ConversionPlan& plan) {
+    OGRwkbGeometryType type = L->GetGeomType();
+    if (type == wkbNone) return type;
+    if (plan.explodeCollections) {
+        // same mapping as ogr2ogr -explodecollections
+        switch (wkbFlatten(type)) {
+            case wkbMultiPoint:         type = wkbPoint; break;
+            case wkbMultiLineString:    type = wkbLineString; break;
+            case wkbMultiPolygon:       type = wkbPolygon; break;
+            case wkbGeometryCollection:
+            case wkbMultiCurve:
+            case wkbMultiSurface:       type = wkbUnknown; break;
+            default: break;
+        }
+    }
+    return OGR_GT_SetModifier(type, plan.keepZ ? TRUE : FALSE, FALSE);
+}
+
+// ----------------- arrow batches -----------------
+// Columnar outputs (GeoParquet, Arrow IPC) of layers that need no per-geometry
+// work are copied as Arrow record batches: GetArrowStream on the source (with
+// the plan's filters installed and unselected fields ignored), WriteArrowBatch
+// on the output, no OGRFeature in between.
+
+#ifdef GEOCONVERTER_HAS_ARROW_BATCHES
+static const int ARROW_BATCH_FEATURES = 65536;
+
+struct StringListScope {
+    char** list;
+    ~StringListScope() { CSLDestroy(list); }
+};
+
+// with no reprojection, makeValid, simplify, explode or dimension change the
+// batches can be written as they are read
+static bool copiesArrowBatches(OGRLayer* L, const ConversionPlan& plan, const LayerCrsPlan& crs) {
+    if (crs.transform || plan.makeValid || plan.simplifyTolerance > 0 || plan.explodeCollections) return false;
+    const OGRwkbGeometryType type = L->GetGeomType();
+    if (type == wkbNone) return true;
+    // the pump forces every geometry to the plan's dimension; batches keep the
+    // source's, so only a known type with no M that already has it qualifies
+    return !OGR_GT_HasM(type) && wkbFlatten(type) != wkbUnknown &&
+           (OGR_GT_HasZ(type) != FALSE) == plan.keepZ;
+}
+
+// hides the fields a plan does not select from the layer for the scope
+struct IgnoredFieldsScope {
+    IgnoredFieldsScope(OGRLayer* l, const std::vector<int>& selected) : layer(l) {
+        OGRFeatureDefn* defn = layer->GetLayerDefn();
+        std::vector<bool> keep(defn->GetFieldCount(), false);
+        for (int i : selected) keep[i] = true;
+        for (int i = 0; i < defn->GetFieldCount(); i++) {
+            if (!keep[i]) names = CSLAddString(names, defn->GetFieldDefn(i)->GetNameRef());
+        }
+        if (names) layer->SetIgnoredFields(const_cast<const char**>(names));
+    }
+    ~IgnoredFieldsScope() {
+        if (!names) return;
+        layer->SetIgnoredFields(nullptr);
+        CSLDestroy(names);
+    }
+    OGRLayer* layer;
+    char** names = nullptr;
+};
+
+static void writeArrowBatches(GDALDataset* dst, OGRLayer* L, const std::string& name,
+                              const OGRSpatialReference* srs, OGRwkbGeometryType geomType,
+                              char** lco, const ConversionPlan& plan, bool keepFids) {
+    const PumpOptions opts = pumpOptionsFor(plan, L, nullptr);
+    AttributeFilterScope filter(L, opts.where);
+    SpatialFilterScope spatialFilter(L, opts);
+    IgnoredFieldsScope ignored(L, selectedFields(L->GetLayerDefn(), plan.selectFields));
+
+    // the column names GetArrowStream gives the FID and the geometry
+    const char* srcFid = L->GetFIDColumn();
+    const std::string fidName = srcFid && srcFid[0] ? srcFid : "OGC_FID";
+    const char* srcGeom = L->GetGeometryColumn();
+    const std::string geomName = srcGeom && srcGeom[0] ? srcGeom : "wkb_geometry";
+
+    const int batchFeatures = plan.rowGroupSize > 0 ? plan.rowGroupSize : ARROW_BATCH_FEATURES;
+    StringListScope streamOptions{nullptr};
+    streamOptions.list = CSLSetNameValue(streamOptions.list, "INCLUDE_FID", keepFids ? "YES" : "NO");
+    streamOptions.list = CSLSetNameValue(streamOptions.list, "MAX_FEATURES_IN_BATCH", std::to_string(batchFeatures).c_str());
+
+    struct ArrowArrayStream stream;
+    if (!L->GetArrowStream(&stream, streamOptions.list)) {
+        throw std::runtime_error(std::string("Failed to read layer ") + L->GetName() + " as Arrow batches");
+    }
+    struct StreamReleaser {
+        ~StreamReleaser() { if (s.release) s.release(&s); }
+        ArrowArrayStream& s;
+    } releaseStream{stream};
+
+    struct ArrowSchema schema;
+    if (stream.get_schema(&stream, &schema) != 0) {
+        throw std::runtime_error(std::string("Failed to get the Arrow schema of layer ") + L->GetName());
+    }
+    struct SchemaReleaser {
+        ~SchemaReleaser() { if (s.release) s.release(&s); }
+        ArrowSchema& s;
+    } releaseSchema{schema};
+
+    OGRLayer* out = dst->CreateLayer(name.c_str(), srs, geomType, lco);
+    if (!out) {
+        throw std::runtime_error("Failed to create layer " + name);
+    }
+    for (int64_t i = 0; i < schema.n_children; i++) {
+        const ArrowSchema* child = schema.children[i];
+        if ((geomType != wkbNone && geomName == child->name) || (keepFids && fidName == child->name)) continue;
+        if (!out->CreateFieldFromArrowSchema(child)) {
+            throw std::runtime_error("Failed to create field " + std::string(child->name) + " in " + name);
+        }
+    }
+
+    StringListScope writeOptions{nullptr};
+    if (keepFids) writeOptions.list = CSLSetNameValue(writeOptions.list, "FID", fidName.c_str());
+    if (geomType != wkbNone) writeOptions.list = CSLSetNameValue(writeOptions.list, "GEOMETRY_NAME", geomName.c_str());
+
+    GIntBig total = -1;
+    if (g_progress.enabled && L->TestCapability(OLCFastFeatureCount)) {
+        PhaseTimer timer(g_timings.count);
+        total = L->GetFeatureCount(TRUE);
+    }
+    GIntBig read = 0;
+
+    for (;;) {
+        struct ArrowArray batch;
+        if (stream.get_next(&stream, &batch) != 0) {
+            const char* error = stream.get_last_error(&stream);
+            throw std::runtime_error(std::string("Failed to read an Arrow batch: ") + (error ? error : "unknown error"));
+        }
+        if (!batch.release) break;  // end of stream
+
+        read += batch.length;
+        const bool written = out->WriteArrowBatch(&schema, &batch, writeOptions.list);
+        if (batch.release) batch.release(&batch);
+        if (!written) {
+            throw std::runtime_error("Failed to write an Arrow batch to " + name);
+        }
+        memoryCheckpoint("translating");
+        throwIfCancelled(total > 0 ? static_cast<double>(read) / total : -1, "translate");
+    }
+    throwIfCancelled(1, "translate");
+}
+#endif
+
+// create one output layer like L in dst and pump L into it; with sourceFids
+// false the output numbers the features itself
+static void pumpLayerInto(GDALDataset* dst, GDALDriver* drv, const std::string& driver,
+                          OGRLayer* L, const std::string& name, const ConversionPlan& plan,
+                          bool sourceFids = true) {
+    // the tile writer reprojects every feature to its EPSG:3857 grid one at a
+    // time; features of a known CRS are handed over in Web Mercator from the
+    // batch kernels instead (the tiles come out the same for any target CRS)
+    const bool knownCrs = !plan.sourceCrs.empty() || L->GetSpatialRef() != nullptr;
+    const std::string targetCrs = writesVectorTiles(driver) && knownCrs ? std::string("EPSG:3857") : plan.targetCrs;
+
+    LayerCrsPlan crs;
+    planLayerCrs(L, plan.sourceCrs, targetCrs, crs);
+
+    const bool keepFids = sourceFids && (plan.preserveFid || (!plan.explodeCollections && driverHasFidOption(drv)));
+
+    char** lco = nullptr;
+    for (const auto& o : driverLayerOptions(driver, plan)) {
+        lco = CSLSetNameValue(lco, o.first.c_str(), o.second.c_str());
+    }
+    const char* srcFid = L->GetFIDColumn();
+    if (keepFids && driverHasFidOption(drv) && srcFid && srcFid[0]) {
+        lco = CSLSetNameValue(lco, "FID", srcFid);
+    }
+
+#ifdef GEOCONVERTER_HAS_ARROW_BATCHES
+    if ((driver == "Parquet" || driver == "Arrow") && copiesArrowBatches(L, plan, crs)) {
+        StringListScope options{lco};
+        writeArrowBatches(dst, L, name, crs.outSrs, pumpLayerGeomType(L, plan), lco, plan, keepFids);
+        return;
+    }
+#endif
+
+    OGRLayer* out = dst->CreateLayer(name.c_str(), crs.outSrs, pumpLayerGeomType(L, plan), lco);
+    CSLDestroy(lco);
+    if (!out) {
+        throw std::runtime_error("Failed to create layer " + name);
+    }
+
+    FeatureSink sink;
+    sink.name = name;
+    sink.layer = out;
+    sink.fieldMap = createFieldsLike(L->GetLayerDefn(), out,
+                                     selectedFields(L->GetLayerDefn(), plan.selectFields));
+    sink.preserveFid = keepFids;
+    sink.failFast = true;
+    beginSinkTransaction(sink, dst);
+
+    SingleSinkRouter router(sink);
+    pumpLayer(L, pumpOptionsFor(plan, L, crs.transform.get()), router);
+    commitSinkTransaction(sink);
+}
+
+// whether a field reads back from the staging FlatGeobuf as it was: it has no
+// lists, stores dates and times as DateTime and drops the UUID subtype
+// (Boolean, Int16, Float32 and JSON come back)
+static bool stagesThroughFlatGeobuf(const OGRFieldDefn* f) {
+    switch (f->GetType()) {
+        case OFTIntegerList:
+        case OFTInteger64List:
+        case OFTRealList:
+        case OFTStringList:
+        case OFTDate:
+        case OFTTime:
+            return false;
+        default:
+            return f->GetSubType() != OFSTUUID;
+    }
+}
+
+// where pumpLayerSorted stages a layer: a temporary file (CPL_TMPDIR) on native
+// builds, so the staged features stay off the heap; WASM builds have no disk,
+// the job's /vsimem directory is heap memory like the rest of the call
+#ifdef __EMSCRIPTEN__
+static const bool SORT_STAGES_ON_HEAP = true;
+#else
+static const bool SORT_STAGES_ON_HEAP = false;
+#endif
+
+static std::string spatialSortStagingPath(const std::string& outPath) {
+    if (SORT_STAGES_ON_HEAP) return outPath + ".sort.fgb";
+    return std::string(CPLGenerateTempFilename("geoconverter_sort")) + ".fgb";
+}
+
+// whether L is written through a spatial sort
+static bool sortsSpatially(OGRLayer* L, const std::string& driver, const ConversionPlan& plan) {
+    if (!plan.spatialSort || driver != "GPKG" || L->GetGeomType() == wkbNone) return false;
+    if (plan.preserveFid) {
+        throw std::runtime_error("spatialSort renumbers the GeoPackage FIDs along the sort and cannot be combined with preserveFid");
+    }
+    // a second copy of the layer on the heap is what spill mode avoids
+    if (SORT_STAGES_ON_HEAP && g_memory.spill) {
+        CPLDebug("GEOCONVERTER", "%s: spill mode, written in source order instead of staging the spatial sort in memory",
+                 L->GetName());
+        return false;
+    }
+    OGRFeatureDefn* defn = L->GetLayerDefn();
+    for (int i : selectedFields(defn, plan.selectFields)) {
+        if (!stagesThroughFlatGeobuf(defn->GetFieldDefn(i))) {
+            CPLDebug("GEOCONVERTER", "%s: field %s would change type in the sort, written in source order",
+                     L->GetName(), defn->GetFieldDefn(i)->GetNameRef());
+            return false;
+        }
+    }
+    return true;
+}
+
+// whether the staged layer has the types and subtypes of the fields it was
+// written from (names may be laundered)
+static bool sameFieldTypes(OGRFeatureDefn* src, const std::vector<int>& fields, OGRFeatureDefn* staged) {
+    if (staged->GetFieldCount() != static_cast<int>(fields.size())) return false;
+    for (size_t j = 0; j < fields.size(); j++) {
+        const OGRFieldDefn* a = src->GetFieldDefn(fields[j]);
+        const OGRFieldDefn* b = staged->GetFieldDefn(static_cast<int>(j));
+        if (a->GetType() != b->GetType() || a->GetSubType() != b->GetSubType()) return false;
+    }
+    return true;
+}
+
+// Spatially sorted pump: L goes through a staging FlatGeobuf first, whose
+// writer Hilbert-sorts the features (they wait in its temporary file next to
+// stagingPath, only the index nodes stay in memory), then into dst in that
+// order. Natively both files are on disk (spatialSortStagingPath); in WASM they
+// are /vsimem heap, which sortsSpatially skips in spill mode. GPKG rows are
+// stored by FID, so the FIDs follow the sort.
+static void pumpLayerSorted(GDALDataset* dst, GDALDriver* drv, const std::string& driver,
+                            OGRLayer* L, const std::string& name, const ConversionPlan& plan,
+                            const std::string& stagingPath) {
+    GDALDriver* fgb = GetGDALDriverManager()->GetDriverByName("FlatGeobuf");
+    if (!fgb) {
+        throw std::runtime_error("Driver not available: FlatGeobuf");
+    }
+    struct StagingFile {
+        ~StagingFile() { VSIUnlink(path.c_str()); }
+        std::string path;
+    } staging{stagingPath};
+
+    {
+        ProgressStage stage(0, 2);
+        DatasetPtr staged(fgb->Create(stagingPath.c_str(), 0, 0, 0, GDT_Unknown, nullptr));
+        if (!staged) {
+            throw std::runtime_error("Failed to create the spatial sort staging file");
+        }
+        pumpLayerInto(staged.get(), fgb, "FlatGeobuf", L, name, plan);
+    }   // closing the FlatGeobuf sorts it
+
+    DatasetPtr sorted(openVectorDataset(stagingPath));
+    OGRLayer* S = sorted->GetLayerCount() > 0 ? sorted->GetLayer(0) : nullptr;
+    if (!S) {
+        throw std::runtime_error("Failed to read the spatial sort staging file");
+    }
+
+    ProgressStage stage(1, 2);
+    // round-trip check: a schema the staging file did not keep (a driver
+    // version mapping types differently) is written unsorted from the source
+    if (!sameFieldTypes(L->GetLayerDefn(), selectedFields(L->GetLayerDefn(), plan.selectFields), S->GetLayerDefn())) {
+        CPLDebug("GEOCONVERTER", "%s: the spatial sort changed field types, written in source order", L->GetName());
+        pumpLayerInto(dst, drv, driver, L, name, plan);
+        return;
+    }
+
+    // the plan was applied by the first pass: copy the sorted layer as it is
+    ConversionPlan copy;
+    copy.keepZ = plan.keepZ;
+    pumpLayerInto(dst, drv, driver, S, name, copy, false);
+}
+
+// GeoJSON through GeoJsonWriter; false when the layer needs the driver
+static bool writeGeoJsonLayer(OGRLayer* L, const std::string& outPath,
+                              const std::string& name, const ConversionPlan& plan) {
+    const std::vector<int> fields = selectedFields(L->GetLayerDefn(), plan.selectFields);
+    if (!geoJsonWriterSupports(L->GetLayerDefn(), fields)) return false;
+
+    LayerCrsPlan crs;
+    planLayerCrs(L, plan.sourceCrs, plan.targetCrs, crs);
+
+    GeoJsonWriter writer;
+    writer.srcDefn = L->GetLayerDefn();
+    writer.fields = fields;
+    writer.precision = plan.geojsonPrecision;
+    writer.begin(name, crs.outSrs);
+
+    FeatureSink sink;
+    sink.name = name;
+    sink.geojson = &writer;
+    sink.fieldMap.assign(writer.srcDefn->GetFieldCount(), -1);
+    sink.preserveFid = plan.preserveFid;
+    sink.failFast = true;
+
+    SingleSinkRouter router(sink);
+    pumpLayer(L, pumpOptionsFor(plan, L, crs.transform.get()), router);
+    writer.finish(outPath);
+    return true;
+}
+
+// PMTiles/MBTiles through the native tiler: every layer is collected in Web
+// Mercator (features without a CRS are taken as such), then tiled at once
+static void writeVectorTiles(const std::vector<OGRLayer*>& layers, const std::string& driver,
+                             const std::string& outPath, const std::string& layerName,
+                             const ConversionPlan& plan) {
+    checkTileZoomRange(plan);
+    TileSet tiles;
+    tiles.minZoom = plan.tileMinZoom >= 0 ? plan.tileMinZoom : DEFAULT_TILE_MIN_ZOOM;
+    tiles.maxZoom = plan.tileMaxZoom >= 0 ? plan.tileMaxZoom : std::max(DEFAULT_TILE_MAX_ZOOM, tiles.minZoom);
+    tiles.simplification = plan.tileSimplification;
+    tiles.simplificationMaxZoom = plan.tileSimplificationMaxZoom;
+
+    const std::string name = layerName.empty() ? std::string(layers[0]->GetName()) : layerName;
+    {
+        ProgressStage collect(0, 2);
+        for (size_t i = 0; i < layers.size(); i++) {
+            ProgressStage stage(i, layers.size());
+            OGRLayer* L = layers[i];
+            const bool knownCrs = !plan.sourceCrs.empty() || L->GetSpatialRef() != nullptr;
+            LayerCrsPlan crs;
+            planLayerCrs(L, plan.sourceCrs, knownCrs ? std::string("EPSG:3857") : std::string(), crs);
+
+            FeatureSink sink;
+            sink.name = i == 0 ? name : std::string(L->GetName());
+            sink.tiles = &tiles;
+            sink.tileLayer = tiles.addLayer(sink.name, L->GetLayerDefn(),
+                                            selectedFields(L->GetLayerDefn(), plan.selectFields));
+            sink.fieldMap.assign(L->GetLayerDefn()->GetFieldCount(), -1);
+            sink.failFast = true;
+
+            SingleSinkRouter router(sink);
+            pumpLayer(L, pumpOptionsFor(plan, L, crs.transform.get()), router);
+        }
+    }
+
+    ProgressStage stage(1, 2);
+    if (driver == "PMTiles") {
+        PmtilesWriter writer(outPath);
+        tiles.encode(writer);
+        writer.finish(tiles, name);
+    } else {
+        MbtilesWriter writer(outPath);
+        tiles.encode(writer);
+        writer.finish(tiles, name);
+    }
+    CPLDebug("GEOCONVERTER", "%s: %d features in " CPL_FRMT_GIB " tiles, zoom %d-%d",
+             name.c_str(), static_cast<int>(tiles.features.size()), tiles.tileCount, tiles.minZoom, tiles.maxZoom);
+}
+
+// write the given source layers into a new dataset at outPath; layerName renames
+// the first one (ogr2ogr's -nln)
+static void writeLayers(GDALDataset* poSrcDS, const std::vector<OGRLayer*>& layers,
+                        const std::string& driver, const std::string& outPath,
+                        const std::string& layerName, const ConversionPlan& plan) {
+    if (plan.useTranslate || !pumpWritesDriver(driver)) {
+        ArgList args = translateArgs(poSrcDS, driver, layerName, plan);
+        for (OGRLayer* L : layers) args.push_back(L->GetName());
+
+        GDALDataset* dst = runVectorTranslate(poSrcDS, outPath, args);
+        if (!dst) {
+            throw std::runtime_error("Vector translate to " + driver + " failed");
+        }
+        GDALClose(dst);
+        return;
+    }
+
+    // the driver supports one layer per file, so only single-layer jobs take the fast writer
+    if (driver == "GeoJSON" && plan.fastWriters && layers.size() == 1) {
+        const std::string name = layerName.empty() ? std::string(layers[0]->GetName()) : layerName;
+        if (writeGeoJsonLayer(layers[0], outPath, name, plan)) return;
+    }
+    if (writesVectorTiles(driver) && plan.fastWriters && !layers.empty()) {
+        writeVectorTiles(layers, driver, outPath, layerName, plan);
+        return;
+    }
+
+    GDALDriver* drv = GetGDALDriverManager()->GetDriverByName(driver.c_str());
+    if (!drv) {
+        throw std::runtime_error("Driver not available: " + driver);
+    }
+    char** dsco = nullptr;
+    for (const auto& o : driverDatasetOptions(driver, plan)) {
+        dsco = CSLSetNameValue(dsco, o.first.c_str(), o.second.c_str());
+    }
+    DatasetPtr dst(drv->Create(outPath.c_str(), 0, 0, 0, GDT_Unknown, dsco));
+    CSLDestroy(dsco);
+    if (!dst) {
+        throw std::runtime_error("Failed to create " + driver + " output");
+    }
+
+    for (size_t i = 0; i < layers.size(); i++) {
+        ProgressStage stage(i, layers.size());
+        const std::string name = (i == 0 && !layerName.empty()) ? layerName : std::string(layers[i]->GetName());
+        if (sortsSpatially(layers[i], driver, plan)) {
+            pumpLayerSorted(dst.get(), drv, driver, layers[i], name, plan, spatialSortStagingPath(outPath));
+        } else {
+            pumpLayerInto(dst.get(), drv, driver, layers[i], name, plan);
+        }
+    }
+}
+
+static std::vector<OGRLayer*> datasetLayers(GDALDataset* poDS) {
+    std::vector<OGRLayer*> layers;
+    for (int i = 0; i < poDS->GetLayerCount(); i++) {
+        if (OGRLayer* L = poDS->GetLayer(i)) layers.push_back(L);
+    }
+    return layers;
+}
+
+// GPX input: one output file per layer in baseDir; false when the layer is empty or fails
+static bool convertGpxLayer(GDALDataset* poSrcDS, OGRLayer* L, const std::string& baseDir, const ConversionPlan& opt) {
+    // Check if layer has features
+    GIntBig featureCount = 0;
+    {
+        PhaseTimer timer(g_timings.count);
+        featureCount = L->GetFeatureCount();
+    }
+    if (featureCount <= 0) return false;
+
+    const std::string driver = getDriverNameFromFormat(opt.outputFormat);
+    const std::string srcLayerName = L->GetName();
+    const std::string outPath = baseDir + "/" + srcLayerName + getExtensionFromFormat(opt.outputFormat);
+
+    try {
+        writeLayers(poSrcDS, {L}, driver, outPath, srcLayerName, opt);
+    } catch (const std::exception&) {
+        // the other layers still go into the ZIP, unless the call was aborted
+        VSIUnlink(outPath.c_str());
+        if (g_progress.cancelled || !g_memory.exceeded.empty()) throw;
+        return false;
+    }
+    return true;
+}
+
+// ZIP every file of a flat /vsimem directory into zipPath and drop the directory;
+// false when the directory held no files
+static bool zipFlatDirectory(const std::string& baseDir, const std::string& zipPath, bool deflate) {
+    std::vector<ZipMember> members;
+    collectZipMembers(baseDir, "", members);
+    if (!members.empty()) writeZipFile(members, zipPath, deflate);
+    VSIRmdirRecursive(baseDir.c_str());
+    return !members.empty();
+}
+
+// translate an opened source dataset; returns the file holding the output, inside job.
+// The source dataset stays open so sessions can convert it again.
+static std::string translateDataset(GDALDataset* poSrcDS, const std::string& inFmt,
+                                    const ConversionPlan& opt, const JobScope& job) {
+    std::string result;
+
+    // ---- Decide driver and output path
+    const std::string driver = getDriverNameFromFormat(opt.outputFormat);
+    const std::string outExt = getExtensionFromFormat(opt.outputFormat);
+
+    // Special case SHP: write to individual directory, then collect all files
+    if (driver == "ESRI Shapefile") {
+        const std::string baseDir = job.path("shp_output");
+
+        const int nL = poSrcDS->GetLayerCount();
+        for (int i = 0; i < nL; i++) {
+            OGRLayer* L = poSrcDS->GetLayer(i);
+            if (!L) continue;
+
+            // Skip GPX auxiliary layers (*_points) - these are just helper layers
+            // The actual geometries are in tracks/routes/waypoints layers
+            if (isGpxAuxiliaryLayer(L->GetName())) continue;
+
+            ProgressStage stage(i, nL);
+            convertLayerToShapefiles(L, baseDir, opt);
+        }
+
+        // Now collect all files from the directory and create a proper ZIP
+        // Using GDAL's /vsizip/ in write mode
+        const std::string zipPath = job.path("output.zip");
+        if (!zipFlatDirectory(baseDir, zipPath, opt.zipDeflate)) {
+            throw std::runtime_error("No shapefile components created");
+        }
+
+        requireMemFile(zipPath, "Failed to create shapefile ZIP");
+        result = zipPath;
+    }
+    else if (driver == "OpenFileGDB") {
+        // Special case for OpenFileGDB: write to .gdb directory, then ZIP it
+        const std::string gdbName = opt.layerName.empty() ? "output.gdb" : opt.layerName + ".gdb";
+        const std::string gdbDir = job.path(gdbName);
+
+        writeLayers(poSrcDS, datasetLayers(poSrcDS), "OpenFileGDB", gdbDir, opt.layerName, opt);
+
+        // Now ZIP the .gdb directory
+        const std::string zipPath = job.path("output.zip");
+        copyDirToZip(gdbDir, zipPath, gdbName, opt.zipDeflate);
+
+        // Cleanup
+        VSIRmdirRecursive(gdbDir.c_str());
+
+        requireMemFile(zipPath, "Failed to create FileGDB ZIP");
+        result = zipPath;
+    }
+    else if (driver == "MapInfo File") {
+        // Special case for MapInfo TAB: write to directory, then ZIP it
+        const std::string baseDir = job.path("mapinfo_output");
+        const std::string baseName = opt.layerName.empty() ? "output" : opt.layerName;
+        const std::string outPath = baseDir + "/" + baseName + ".tab";
+
+        writeLayers(poSrcDS, datasetLayers(poSrcDS), "MapInfo File", outPath, opt.layerName, opt);
+
+        // Collect all MapInfo files (.tab, .dat, .map, .id, .ind) and ZIP them
+        const std::string zipPath = job.path("mapinfo_output.zip");
+        zipFlatDirectory(baseDir, zipPath, opt.zipDeflate);
+
+        requireMemFile(zipPath, "Failed to create MapInfo ZIP");
+        result = zipPath;
+    }
+    else {
+        // Non-SHP/GDB formats
+        // For GPX input, process multiple layers and create a ZIP with separate files
+        if (inFmt == "gpx" && opt.layerName.empty() && opt.geometryTypeFilter.empty()) {
+            const std::string baseDir = job.path("output_files");
+
+            const int nL = poSrcDS->GetLayerCount();
+            bool hasOutput = false;
+
+            for (int i = 0; i < nL; i++) {
+                OGRLayer* L = poSrcDS->GetLayer(i);
+                if (!L) continue;
+
+                // Skip GPX auxiliary layers
+                if (isGpxAuxiliaryLayer(L->GetName())) continue;
+
+                ProgressStage stage(i, nL);
+                if (convertGpxLayer(poSrcDS, L, baseDir, opt)) hasOutput = true;
+            }
+
+            if (!hasOutput) {
+                throw std::runtime_error("No valid layers found in GPX file");
+            }
+
+            // Create ZIP with all output files
+            const std::string zipPath = job.path("output.zip");
+            zipFlatDirectory(baseDir, zipPath, opt.zipDeflate);
+
+            requireMemFile(zipPath, "Failed to create output ZIP");
+            result = zipPath;
+
+        } else {
+            // Single output file (non-GPX or user specified layer/filter)
+            const std::string outPath = job.path("output" + outExt);
+
+            std::vector<OGRLayer*> layers = datasetLayers(poSrcDS);
+
+            // For GPX, specify layer (default to 'tracks')
+            if (inFmt == "gpx") {
+                const std::string gpxLayer = opt.layerName.empty() ? "tracks" : opt.layerName;
+                OGRLayer* L = poSrcDS->GetLayerByName(gpxLayer.c_str());
+                if (!L) {
+                    throw std::runtime_error("Layer not found: " + gpxLayer);
+                }
+                layers.assign(1, L);
+            }
+
+            writeLayers(poSrcDS, layers, driver, outPath, opt.layerName, opt);
+
+            vsi_l_offset n = 0;
+            GByte* buf = VSIGetMemFileBuffer(outPath.c_str(), &n, FALSE);
+            if (!buf || n == 0) {
+                VSIUnlink(outPath.c_str());
+                throw std::runtime_error("Failed to read output data");
+            }
+            result = outPath;
+        }
+    }
+    return result;
+}
+
+// explain an empty result in g_lastError
+static void describeEmptyResult(const std::string& result, const ConversionPlan& opt) {
+    if (result.empty()) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty()) {
+            g_lastError = "GDAL returned an empty dataset";
+        }
+        if (!opt.sourceCrs.empty() || !opt.targetCrs.empty()) {
+            g_lastError += " (source CRS: " + (opt.sourceCrs.empty() ? std::string("auto") : opt.sourceCrs)
+                         + ", target CRS: " + (opt.targetCrs.empty() ? std::string("auto") : opt.targetCrs) + ")";
+        }
+        g_lastError += " driver=" + getDriverNameFromFormat(opt.outputFormat);
+    }
+}
+
+static void failConversion(std::string& result, const std::exception& ex) {
+    // For now, keep contract: empty path indicates failure.
+    ensureLastErrorMessage();
+    if (g_lastError.empty() && ex.what()) {
+        g_lastError = ex.what();
+    }
+    // GDAL reports a cancelled translate as a generic failure
+    overrideAbortError();
+    if (!result.empty()) {
+        VSIUnlink(result.c_str());
+    }
+    result.clear();
+}
+
+// drivers that are done with their input file by name once open (they either
+// read it whole or keep their own handle, which keeps /vsimem bytes alive)
+static bool releasesInputAfterOpen(GDALDataset* ds) {
+    GDALDriver* drv = ds->GetDriver();
+    const std::string name = drv ? drv->GetDescription() : "";
+    return name == "GeoJSON" || name == "GeoJSONSeq" || name == "ESRIJSON" ||
+           name == "TopoJSON" || name == "KML";
+}
+
+// runs the conversion and returns the file holding the output, inside job ("" on failure).
+// With adoptInput the VSIMalloc'd input is owned (and freed) here.
+static std::string convertVectorImpl(
+    const GByte* inputData,
+    size_t inputSize,
+    const std::string& inputFormat,
+    const ConversionPlan& opt,
+    const JobScope& job,
+    bool adoptInput = false
+) {
+    ensureInitialized();
+    std::string result;
+
+    resetLastError();
+    resetCallInstrumentation();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
+
+    // ---- 1) Materialize input in /vsimem and open
+    std::string inputMemFile;
+    bool inputReleased = false;
+
+    try {
+        beginCallMemory(opt.memoryBudget, inputSize, job.dir);
+        memoryCheckpoint("starting");
+
+        const std::string inFmt = heapString(toLower(inputFormat));
+        std::string inputPath;
+        {
+            PhaseTimer timer(g_timings.materialize);
+            inputPath = materializeInput(inputData, inputSize, inFmt, job.path("input"),
+                                         inputMemFile, adoptInput);
+        }
+        sampleMemory("materializing input", true);
+
+        DatasetPtr poSrcDS;
+        {
+            PhaseTimer timer(g_timings.open);
+            poSrcDS.reset(openInputDataset(inputPath, inFmt));
+        }
+        memoryCheckpoint("opening input");
+
+        // spill mode: an adopted input goes as soon as the dataset no longer needs its name
+        if (g_memory.spill && adoptInput && inputPath == inputMemFile && releasesInputAfterOpen(poSrcDS.get())) {
+            VSIUnlink(inputMemFile.c_str());
+            inputMemFile.clear();
+            inputReleased = true;
+        }
+        {
+            PhaseTimer timer(g_timings.translate);
+            result = translateDataset(poSrcDS.get(), inFmt, opt, job);
+        }
+        memoryCheckpoint("translating", true);
+        describeEmptyResult(result, opt);
+    } catch (const std::exception& ex) {
+        failConversion(result, ex);
+    }
+
+    // cleanup input
+    if (!inputMemFile.empty()) {
+        VSIUnlink(inputMemFile.c_str());
+    } else if (adoptInput && !inputReleased) {
+        VSIFree(const_cast<GByte*>(inputData)); // never adopted by /vsimem
+    }
+
+    CPLPopErrorHandler();
+
+    if (result.empty()) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty()) {
+            g_lastError = "No output produced by GDAL";
+        }
+    }
+
+    return result;
+}
+
+// ZIP outputs deflate their members unless setZipCompression("store") was called
+static std::atomic<bool> g_zipDeflate(true);
+
+void Native::setZipCompression(const std::string& mode) {
+    g_zipDeflate = toLower(mode) != "store";
+}
+
+static ConversionPlan makeConversionPlan(
+    const std::string& outputFormat,
+    const std::string& sourceCrs,
+    const std::string& targetCrs,
+    const std::string& layerName,
+    const std::string& geometryTypeFilter,
+    bool skipFailures,
+    bool makeValid,
+    bool keepZ,
+    const std::string& whereClause,
+    const std::string& selectFields,
+    double simplifyTolerance,
+    bool explodeCollections,
+    bool preserveFid,
+    int geojsonPrecision,
+    const std::string& csvGeometryMode
+) {
+    ConversionPlan opt;
+    opt.outputFormat = outputFormat;
+    opt.sourceCrs = sourceCrs;
+    opt.targetCrs = targetCrs;
+    opt.layerName = layerName;
+    opt.geometryTypeFilter = geometryTypeFilter;
+    opt.skipFailures = skipFailures;
+    opt.makeValid = makeValid;
+    opt.keepZ = keepZ;
+    opt.whereClause = whereClause;
+    opt.selectFields = selectFields;
+    opt.simplifyTolerance = simplifyTolerance;
+    opt.explodeCollections = explodeCollections;
+    opt.preserveFid = preserveFid;
+    opt.geojsonPrecision = geojsonPrecision;
+    opt.csvGeometryMode = csvGeometryMode;
+    opt.zipDeflate = g_zipDeflate;
+    return opt;
+}
+
+std::vector<uint8_t> Native::convertVector(
+    const std::vector<uint8_t>& inputData,
+    const std::string& inputFormat,
+    const std::string& outputFormat,
+    const std::string& sourceCrs,
+    const std::string& targetCrs,
+    const std::string& layerName,
+    const std::string& geometryTypeFilter,
+    bool skipFailures,
+    bool makeValid,
+    bool keepZ,
+    const std::string& whereClause,
+    const std::string& selectFields,
+    double simplifyTolerance,
+    bool explodeCollections,
+    bool preserveFid,
+    int geojsonPrecision,
+    const std::string& csvGeometryMode
+) {
+    std::vector<uint8_t> result;
+    JobScope job;
+    const std::string outPath = convertVectorImpl(
+        inputData.data(), inputData.size(), inputFormat,
+        makeConversionPlan(outputFormat, sourceCrs, targetCrs, layerName, geometryTypeFilter,
+                           skipFailures, makeValid, keepZ, whereClause, selectFields,
+                           simplifyTolerance, explodeCollections, preserveFid,
+                           geojsonPrecision, csvGeometryMode),
+        job);
+    if (outPath.empty()) {
+        return result;
+    }
+
+    PhaseTimer timer(g_timings.copyOut);
+    vsi_l_offset n = 0;
+    GByte* buf = VSIGetMemFileBuffer(outPath.c_str(), &n, FALSE);
+    if (buf && n > 0) {
+        result.assign(buf, buf + n);
+    }
+    VSIUnlink(outPath.c_str());
+    return result;
+}
+
+// ----------------- zero-copy buffers -----------------
+// Outputs handed to JS stay in /vsimem until released, so the worker can read
+// them straight out of the WASM heap instead of through a std::vector copy.
+static std::mutex g_outputsMutex;
+static std::map<int, std::string> g_outputs;
+static int g_nextOutputId = 1;
+
+static int registerOutput(const std::string& memPath) {
+    std::lock_guard<std::mutex> lock(g_outputsMutex);
+    const int id = g_nextOutputId++;
+
+    // move the file out of its job directory, which is removed when the call returns
+    const size_t slash = memPath.find_last_of('/');
+    const size_t dot = memPath.find_last_of('.');
+    const std::string ext = (dot != std::string::npos && dot > slash) ? memPath.substr(dot) : "";
+    const std::string ownedPath = "/vsimem/outputs/output_" + std::to_string(id) + ext;
+    g_outputs[id] = VSIRename(memPath.c_str(), ownedPath.c_str()) == 0 ? ownedPath : memPath;
+    return id;
+}
+
+static std::string lookupOutput(int outputId) {
+    std::lock_guard<std::mutex> lock(g_outputsMutex);
+    auto it = g_outputs.find(outputId);
+    return it == g_outputs.end() ? std::string() : it->second;
+}
+
+size_t Native::allocBuffer(size_t size) {
+    // VSIMalloc so the buffer can later be handed to VSIFileFromMemBuffer
+    return reinterpret_cast<size_t>(VSIMalloc(size > 0 ? size : 1));
+}
+
+void Native::freeBuffer(size_t address) {
+    VSIFree(reinterpret_cast<void*>(address));
+}
+
+std::string Native::getVectorInfoFromBuffer(
+    size_t inputAddress,
+    size_t inputSize,
+    const std::string& inputFormat,
+    const std::string& sourceCrs
+) {
+    return getVectorInfoImpl(reinterpret_cast<const GByte*>(inputAddress), inputSize,
+                             inputFormat, sourceCrs);
+}
+
+int Native::convertVectorToBuffer(
+    size_t inputAddress,
+    size_t inputSize,
+    const std::string& inputFormat,
+    const std::string& outputFormat,
+    const std::string& sourceCrs,
+    const std::string& targetCrs,
+    const std::string& layerName,
+    const std::string& geometryTypeFilter,
+    bool skipFailures,
+    bool makeValid,
+    bool keepZ,
+    const std::string& whereClause,
+    const std::string& selectFields,
+    double simplifyTolerance,
+    bool explodeCollections,
+    bool preserveFid,
+    int geojsonPrecision,
+    const std::string& csvGeometryMode
+) {
+    JobScope job;
+    const std::string outPath = convertVectorImpl(
+        reinterpret_cast<const GByte*>(inputAddress), inputSize, inputFormat,
+        makeConversionPlan(outputFormat, sourceCrs, targetCrs, layerName, geometryTypeFilter,
+                           skipFailures, makeValid, keepZ, whereClause, selectFields,
+                           simplifyTolerance, explodeCollections, preserveFid,
+                           geojsonPrecision, csvGeometryMode),
+        job);
+    return outPath.empty() ? 0 : registerOutput(outPath);
+}
+
+int Native::convertBufferWithPlan(
+    size_t inputAddress,
+    size_t inputSize,
+    const std::string& inputFormat,
+    const ConversionPlan& plan
+) {
+    JobScope job;
+    const std::string outPath = convertVectorImpl(
+        reinterpret_cast<const GByte*>(inputAddress), inputSize, inputFormat, plan, job, plan.adoptInput);
+    return outPath.empty() ? 0 : registerOutput(outPath);
+}
+
+size_t Native::getOutputAddress(int outputId) {
+    const std::string path = lookupOutput(outputId);
+    if (path.empty()) return 0;
+    vsi_l_offset n = 0;
+    return reinterpret_cast<size_t>(VSIGetMemFileBuffer(path.c_str(), &n, FALSE));
+}
+
+size_t Native::getOutputSize(int outputId) {
+    const std::string path = lookupOutput(outputId);
+    if (path.empty()) return 0;
+    vsi_l_offset n = 0;
+    VSIGetMemFileBuffer(path.c_str(), &n, FALSE);
+    return static_cast<size_t>(n);
+}
+
+void Native::releaseOutput(int outputId) {
+    std::lock_guard<std::mutex> lock(g_outputsMutex);
+    auto it = g_outputs.find(outputId);
+    if (it == g_outputs.end()) return;
+    VSIUnlink(it->second.c_str());
+    g_outputs.erase(it);
+}
+
+// ----------------- output streams -----------------
+// Pull-style reads of an output in bounded chunks, so JS can forward each chunk
+// (e.g. to a WritableStream) without materializing the whole file a second time.
+static std::mutex g_streamsMutex;
+static std::map<int, VSILFILE*> g_streams;
+static int g_nextStreamId = 1;
+
+int Native::openOutputStream(int outputId) {
+    const std::string path = lookupOutput(outputId);
+    if (path.empty()) return 0;
+    VSILFILE* fp = VSIFOpenL(path.c_str(), "rb");
+    if (!fp) return 0;
+
+    std::lock_guard<std::mutex> lock(g_streamsMutex);
+    const int streamId = g_nextStreamId++;
+    g_streams[streamId] = fp;
+    return streamId;
+}
+
+size_t Native::readOutputStream(int streamId, size_t address, size_t maxBytes) {
+    VSILFILE* fp = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_streamsMutex);
+        auto it = g_streams.find(streamId);
+        if (it == g_streams.end()) return 0;
+        fp = it->second;
+    }
+    return VSIFReadL(reinterpret_cast<void*>(address), 1, maxBytes, fp);
+}
+
+void Native::closeOutputStream(int streamId) {
+    std::lock_guard<std::mutex> lock(g_streamsMutex);
+    auto it = g_streams.find(streamId);
+    if (it == g_streams.end()) return;
+    VSIFCloseL(it->second);
+    g_streams.erase(it);
+}
+
+// ----------------- blob inputs -----------------
+// /vsiblob/<id>/input.<ext> reads byte ranges of a JS Blob/File registered in
+// Module.geoconverterBlobs, so GDAL only pulls in the parts of the file it touches.
+#ifdef __EMSCRIPTEN__
+EM_JS(int, geoconverterReadBlob, (int blobId, double offset, int length, void* dst), {
+    var blob = Module.geoconverterBlobs && Module.geoconverterBlobs[blobId];
+    if (!blob) return -1;
+    // FileReaderSync is available in workers, which is where conversions run
+    var bytes = new Uint8Array(new FileReaderSync().readAsArrayBuffer(blob.slice(offset, offset + length)));
+    HEAPU8.set(bytes, dst);
+    return bytes.length;
+});
+#else
+static int geoconverterReadBlob(int, double, int, void*) { return -1; }
+#endif
+
+static const char* BLOB_PREFIX = "/vsiblob/";
+static const size_t BLOB_READ_BLOCK = 1024 * 1024;      // GDAL-side read buffer
+static const size_t BLOB_CACHE_SIZE = 32 * 1024 * 1024; // GDAL-side block cache
+
+static std::mutex g_blobsMutex;
+static std::map<int, vsi_l_offset> g_blobSizes;
+
+struct BlobHandle {
+    int blobId;
+    vsi_l_offset size;
+    vsi_l_offset pos;
+    bool eof;
+};
+
+// "/vsiblob/7/input.gpkg" -> 7 (and its registered size); false when unknown
+static bool parseBlobPath(const char* filename, int& blobId, vsi_l_offset& size) {
+    const size_t prefixLen = strlen(BLOB_PREFIX);
+    if (strncmp(filename, BLOB_PREFIX, prefixLen) != 0) return false;
+    const char* rest = filename + prefixLen;
+    const char* slash = strchr(rest, '/');
+    if (!slash || strchr(slash + 1, '/')) return false; // only the input file itself exists
+    blobId = atoi(rest);
+
+    std::lock_guard<std::mutex> lock(g_blobsMutex);
+    auto it = g_blobSizes.find(blobId);
+    if (it == g_blobSizes.end()) return false;
+    size = it->second;
+    return true;
+}
+
+static void* blobOpen(void*, const char* filename, const char* access) {
+    int blobId = 0;
+    vsi_l_offset size = 0;
+    if (strchr(access, 'w') || strchr(access, 'a') || strchr(access, '+')) return nullptr;
+    if (!parseBlobPath(filename, blobId, size)) return nullptr;
+    return new BlobHandle{blobId, size, 0, false};
+}
+
+static int blobStat(void*, const char* filename, VSIStatBufL* stat, int) {
+    int blobId = 0;
+    vsi_l_offset size = 0;
+    if (!parseBlobPath(filename, blobId, size)) return -1;
+    memset(stat, 0, sizeof(VSIStatBufL));
+    stat->st_size = size;
+    stat->st_mode = S_IFREG;
+    return 0;
+}
+
+static vsi_l_offset blobTell(void* file) {
+    return static_cast<BlobHandle*>(file)->pos;
+}
+
+static int blobSeek(void* file, vsi_l_offset offset, int whence) {
+    BlobHandle* h = static_cast<BlobHandle*>(file);
+    if (whence == SEEK_SET) h->pos = offset;
+    else if (whence == SEEK_CUR) h->pos += offset;
+    else if (whence == SEEK_END) h->pos = h->size + offset;
+    else return -1;
+    h->eof = false;
+    return 0;
+}
+
+static size_t blobRead(void* file, void* buffer, size_t size, size_t count) {
+    BlobHandle* h = static_cast<BlobHandle*>(file);
+    if (size == 0 || count == 0) return 0;
+    const vsi_l_offset available = h->pos < h->size ? h->size - h->pos : 0;
+    const size_t wanted = static_cast<size_t>(std::min<vsi_l_offset>(size * count, available));
+    if (wanted < size * count) h->eof = true;
+    if (wanted == 0) return 0;
+
+    const int got = geoconverterReadBlob(h->blobId, static_cast<double>(h->pos),
+                                         static_cast<int>(wanted), buffer);
+    if (got <= 0) {
+        h->eof = true;
+        return 0;
+    }
+    h->pos += got;
+    return static_cast<size_t>(got) / size;
+}
+
+static int blobEof(void* file) {
+    return static_cast<BlobHandle*>(file)->eof ? 1 : 0;
+}
+
+static int blobClose(void* file) {
+    delete static_cast<BlobHandle*>(file);
+    return 0;
+}
+
+static void installBlobFilesystem() {
+    static std::once_flag once;
+    std::call_once(once, [] {
+        VSIFilesystemPluginCallbacksStruct* cb = VSIAllocFilesystemPluginCallbacksStruct();
+        cb->open = blobOpen;
+        cb->stat = blobStat;
+        cb->tell = blobTell;
+        cb->seek = blobSeek;
+        cb->read = blobRead;
+        cb->eof = blobEof;
+        cb->close = blobClose;
+        // let GDAL buffer reads in blocks and keep a block cache, so small
+        // header reads do not each cost a Blob.slice() round trip
+        cb->nBufferSize = BLOB_READ_BLOCK;
+        cb->nCacheSize = BLOB_CACHE_SIZE;
+        VSIInstallPluginHandler(BLOB_PREFIX, cb);
+        VSIFreeFilesystemPluginCallbacksStruct(cb);
+    });
+}
+
+// register a blob and return the path of its raw file (before resolveInputPath)
+static std::string registerBlobInput(int blobId, vsi_l_offset size, const std::string& inFmt) {
+    installBlobFilesystem();
+    {
+        std::lock_guard<std::mutex> lock(g_blobsMutex);
+        g_blobSizes[blobId] = size;
+    }
+
+    // peek at the signature to tell KMZ from KML, as materializeInput does
+    GByte head[4] = {0, 0, 0, 0};
+    size_t headLen = 0;
+    const std::string probePath = std::string(BLOB_PREFIX) + std::to_string(blobId) + "/input.bin";
+    if (VSILFILE* fp = VSIFOpenL(probePath.c_str(), "rb")) {
+        headLen = VSIFReadL(head, 1, sizeof(head), fp);
+        VSIFCloseL(fp);
+    }
+    return std::string(BLOB_PREFIX) + std::to_string(blobId) + "/input" +
+           inputFileExtension(inFmt, hasZipSignature(head, headLen));
+}
+
+static void unregisterBlobInput(int blobId) {
+    std::lock_guard<std::mutex> lock(g_blobsMutex);
+    g_blobSizes.erase(blobId);
+}
+
+// ----------------- sessions -----------------
+// A session materializes the input once and keeps the GDALDataset open, so a
+// preview followed by N conversions costs one parse plus N writes.
+struct Session {
+    JobScope job;             // holds the adopted input; removed after ds closes
+    std::string inputFormat;  // lower-case
+    std::string memFile;      // owns the adopted input buffer (buffer sessions)
+    size_t inputBytes = 0;    // heap held by the input (buffer sessions)
+    int blobId = -1;          // registered /vsiblob/ input (blob sessions)
+    DatasetPtr ds;
+    // read position of the last getFeatures page; reset by any call that
+    // reads the layers itself
+    OGRLayer* pageLayer = nullptr;
+    GIntBig pageNext = 0;
+};
+
+static std::mutex g_sessionsMutex;
+static std::map<int, std::unique_ptr<Session>> g_sessions;
+static int g_nextSessionId = 1;
+
+static Session* lookupSession(int sessionId) {
+    std::lock_guard<std::mutex> lock(g_sessionsMutex);
+    auto it = g_sessions.find(sessionId);
+    if (it == g_sessions.end()) {
+        throw std::runtime_error("Unknown session " + std::to_string(sessionId));
+    }
+    return it->second.get();
+}
+
+int Native::openSession(size_t inputAddress, size_t inputSize, const std::string& inputFormat) {
+    ensureInitialized();
+    resetLastError();
+    resetCallInstrumentation();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
+
+    GByte* data = reinterpret_cast<GByte*>(inputAddress);
+    std::unique_ptr<Session> session(new Session());
+    int sessionId = 0;
+
+    try {
+        session->inputFormat = heapString(toLower(inputFormat));
+        session->inputBytes = inputSize;
+        beginCallMemory(0, inputSize, session->job.dir);
+        std::string inputPath;
+        {
+            PhaseTimer timer(g_timings.materialize);
+            inputPath = materializeInput(data, inputSize, session->inputFormat,
+                                         session->job.path("input"), session->memFile, true);
+        }
+        PhaseTimer timer(g_timings.open);
+        session->ds.reset(openInputDataset(inputPath, session->inputFormat));
+
+        std::lock_guard<std::mutex> lock(g_sessionsMutex);
+        sessionId = g_nextSessionId++;
+        g_sessions[sessionId] = std::move(session);
+    } catch (const std::exception& ex) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty() && ex.what()) {
+            g_lastError = ex.what();
+        }
+        if (session->memFile.empty()) {
+            VSIFree(data); // never adopted by /vsimem
+        }
+        sessionId = 0;
+    }
+
+    CPLPopErrorHandler();
+    return sessionId;
+}
+
+int Native::openBlobSession(int blobId, double blobSize, const std::string& inputFormat) {
+    ensureInitialized();
+    resetLastError();
+    resetCallInstrumentation();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
+
+    std::unique_ptr<Session> session(new Session());
+    int sessionId = 0;
+
+    try {
+        session->inputFormat = heapString(toLower(inputFormat));
+        session->blobId = blobId;
+        beginCallMemory(0, 0, session->job.dir);
+        std::string filePath;
+        {
+            PhaseTimer timer(g_timings.materialize);
+            filePath = registerBlobInput(blobId, static_cast<vsi_l_offset>(blobSize), session->inputFormat);
+        }
+        PhaseTimer timer(g_timings.open);
+        session->ds.reset(openInputDataset(resolveInputPath(filePath, session->inputFormat),
+                                           session->inputFormat));
+
+        std::lock_guard<std::mutex> lock(g_sessionsMutex);
+        sessionId = g_nextSessionId++;
+        g_sessions[sessionId] = std::move(session);
+    } catch (const std::exception& ex) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty() && ex.what()) {
+            g_lastError = ex.what();
+        }
+        unregisterBlobInput(blobId);
+        sessionId = 0;
+    }
+
+    CPLPopErrorHandler();
+    return sessionId;
+}
+
+std::string Native::getSessionInfo(int sessionId, const std::string& sourceCrs, bool exact) {
+    ensureInitialized();
+    resetLastError();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
+
+    std::string result = "{}";
+    try {
+        Session* session = lookupSession(sessionId);
+        session->pageLayer = nullptr;
+        result = describeDataset(session->ds.get(), sourceCrs, exact);
+    } catch (const std::exception& ex) {
+        result = infoErrorJson(ex);
+    }
+
+    CPLPopErrorHandler();
+    return result;
+}
+
+int Native::convertSession(
+    int sessionId,
+    const std::string& outputFormat,
+    const std::string& sourceCrs,
+    const std::string& targetCrs,
+    const std::string& layerName,
+    const std::string& geometryTypeFilter,
+    bool skipFailures,
+    bool makeValid,
+    bool keepZ,
+    const std::string& whereClause,
+    const std::string& selectFields,
+    double simplifyTolerance,
+    bool explodeCollections,
+    bool preserveFid,
+    int geojsonPrecision,
+    const std::string& csvGeometryMode
+) {
+    return convertSessionWithPlan(sessionId, makeConversionPlan(
+        outputFormat, sourceCrs, targetCrs, layerName, geometryTypeFilter, skipFailures,
+        makeValid, keepZ, whereClause, selectFields, simplifyTolerance, explodeCollections,
+        preserveFid, geojsonPrecision, csvGeometryMode));
+}
+
+int Native::convertSessionWithPlan(int sessionId, const ConversionPlan& opt) {
+    ensureInitialized();
+    resetLastError();
+    resetCallInstrumentation();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
+
+    std::string result;
+    JobScope job;
+    try {
+        Session* session = lookupSession(sessionId);
+        session->pageLayer = nullptr;
+        beginCallMemory(opt.memoryBudget, session->inputBytes, job.dir);
+        memoryCheckpoint("starting");
+        {
+            PhaseTimer timer(g_timings.translate);
+            result = translateDataset(session->ds.get(), session->inputFormat, opt, job);
+        }
+        memoryCheckpoint("translating", true);
+        describeEmptyResult(result, opt);
+    } catch (const std::exception& ex) {
+        failConversion(result, ex);
+    }
+
+    CPLPopErrorHandler();
+
+    if (result.empty()) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty()) {
+            g_lastError = "No output produced by GDAL";
+        }
+        return 0;
+    }
+    return registerOutput(result);
+}
+
+void Native::closeSession(int sessionId) {
+    std::unique_ptr<Session> session;
+    {
+        std::lock_guard<std::mutex> lock(g_sessionsMutex);
+        auto it = g_sessions.find(sessionId);
+        if (it == g_sessions.end()) return;
+        session = std::move(it->second);
+        g_sessions.erase(it);
+    }
+    session->ds.reset();
+    if (session->blobId >= 0) unregisterBlobInput(session->blobId);
+}
+
+// ----------------- per-layer jobs -----------------
+// Layer jobs let a pool of workers (each with its own session on the same
+// input) convert the layers of one dataset side by side.
+
+// convert one source layer into a ZIP inside job; "" when the layer produced nothing
+static std::string translateLayer(GDALDataset* poSrcDS, const std::string& inFmt,
+                                  const std::string& sourceLayer, const ConversionPlan& opt,
+                                  const JobScope& job) {
+    if (!convertsPerLayer(inFmt, opt)) {
+        throw std::runtime_error("Output format " + opt.outputFormat + " is not written per layer");
+    }
+    OGRLayer* L = poSrcDS->GetLayerByName(sourceLayer.c_str());
+    if (!L) {
+        throw std::runtime_error("Layer not found: " + sourceLayer);
+    }
+
+    const std::string filesDir = job.path("files");
+    if (getDriverNameFromFormat(opt.outputFormat) == "ESRI Shapefile") {
+        convertLayerToShapefiles(L, filesDir, opt);
+    } else if (!convertGpxLayer(poSrcDS, L, filesDir, opt)) {
+        return "";
+    }
+
+    const std::string zipPath = job.path("output.zip");
+    if (!zipFlatDirectory(filesDir, zipPath, opt.zipDeflate)) {
+        return "";
+    }
+    requireMemFile(zipPath, "Failed to create layer ZIP");
+    return zipPath;
+}
+
+std::string Native::getSessionLayerPlan(
+    int sessionId,
+    const std::string& outputFormat,
+    const std::string& layerName,
+    const std::string& geometryTypeFilter
+) {
+    resetLastError();
+
+    std::string json = "[";
+    try {
+        Session* session = lookupSession(sessionId);
+
+        ConversionPlan opt;
+        opt.outputFormat = outputFormat;
+        opt.layerName = layerName;
+        opt.geometryTypeFilter = geometryTypeFilter;
+        if (convertsPerLayer(session->inputFormat, opt)) {
+            bool first = true;
+            const int nL = session->ds->GetLayerCount();
+            for (int i = 0; i < nL; i++) {
+                OGRLayer* L = session->ds->GetLayer(i);
+                if (!L || isGpxAuxiliaryLayer(L->GetName())) continue;
+                if (!first) json += ",";
+                json += "\"" + escapeJsonString(L->GetName()) + "\"";
+                first = false;
+            }
         }
-        result = "{\"error\":\"" + std::string(ex.what()) + "\"}";
+    } catch (const std::exception& ex) {
+        g_lastError = ex.what();
     }
-
-    CPLPopErrorHandler();
-    return result;
+    json += "]";
+    return json;
 }
 
-std::vector<uint8_t> Native::convertVector(
-    const std::vector<uint8_t>& inputData,
-    const std::string& inputFormat,
+int Native::convertSessionLayer(
+    int sessionId,
+    const std::string& sourceLayer,
     const std::string& outputFormat,
     const std::string& sourceCrs,
     const std::string& targetCrs,
@@ -874,583 +6445,972 @@ std::vector<uint8_t> Native::convertVector(
     int geojsonPrecision,
     const std::string& csvGeometryMode
 ) {
-    GDALAllRegister();
-    std::vector<uint8_t> result;
+    return convertSessionLayerWithPlan(sessionId, sourceLayer, makeConversionPlan(
+        outputFormat, sourceCrs, targetCrs, layerName, geometryTypeFilter, skipFailures,
+        makeValid, keepZ, whereClause, selectFields, simplifyTolerance, explodeCollections,
+        preserveFid, geojsonPrecision, csvGeometryMode));
+}
 
+int Native::convertSessionLayerWithPlan(
+    int sessionId,
+    const std::string& sourceLayer,
+    const ConversionPlan& opt
+) {
+    ensureInitialized();
     resetLastError();
+    resetCallInstrumentation();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
     CPLPushErrorHandler(ErrHandler);
 
-    // ---- 1) Materialize input in /vsimem and open
-    std::string inputPath;
-    VSILFILE* fpIn = nullptr;
-    std::string driver;
-
+    int outputId = 0;
+    JobScope job;
     try {
-        const std::string inFmt = toLower(inputFormat);
-        if (inFmt == "shapefile") {
-            const std::string zipPath = "/vsimem/input.zip";
-            fpIn = VSIFileFromMemBuffer(zipPath.c_str(),
-                                        const_cast<GByte*>(inputData.data()),
-                                        static_cast<vsi_l_offset>(inputData.size()),
-                                        FALSE);
-            if (!fpIn) throw std::runtime_error("Failed to create input ZIP file");
-            VSIFCloseL(fpIn); fpIn = nullptr;
-
-            const std::string zipVsi = "/vsizip/" + zipPath; // note: /vsizip//vsimem/input.zip also works
-            inputPath = pickShpInsideZip(zipVsi);
-            if (inputPath.empty()) throw std::runtime_error("No .shp found in input ZIP");
-        } else if (inFmt == "kml") {
-            // Check if input is a KMZ (zipped KML) by looking for ZIP signature
-            bool isKmz = false;
-            if (inputData.size() >= 4) {
-                // Check for ZIP magic number (PK\x03\x04 or PK\x05\x06)
-                isKmz = (inputData[0] == 'P' && inputData[1] == 'K' &&
-                        (inputData[2] == 0x03 || inputData[2] == 0x05));
-            }
-
-            if (isKmz) {
-                const std::string zipPath = "/vsimem/input.kmz";
-                fpIn = VSIFileFromMemBuffer(zipPath.c_str(),
-                                            const_cast<GByte*>(inputData.data()),
-                                            static_cast<vsi_l_offset>(inputData.size()),
-                                            FALSE);
-                if (!fpIn) throw std::runtime_error("Failed to create input KMZ file");
-                VSIFCloseL(fpIn); fpIn = nullptr;
-
-                const std::string zipVsi = "/vsizip/" + zipPath;
-                inputPath = pickKmlInsideZip(zipVsi);
-                if (inputPath.empty()) throw std::runtime_error("No .kml found in KMZ archive");
-            } else {
-                // Regular KML file
-                inputPath = "/vsimem/input.kml";
-                fpIn = VSIFileFromMemBuffer(inputPath.c_str(),
-                                            const_cast<GByte*>(inputData.data()),
-                                            static_cast<vsi_l_offset>(inputData.size()),
-                                            FALSE);
-                if (!fpIn) throw std::runtime_error("Failed to create input KML file");
-                VSIFCloseL(fpIn); fpIn = nullptr;
-            }
-        } else if (inFmt == "mapinfo") {
-            // MapInfo TAB format - handle as ZIP
-            const std::string zipPath = "/vsimem/input.zip";
-            fpIn = VSIFileFromMemBuffer(zipPath.c_str(),
-                                        const_cast<GByte*>(inputData.data()),
-                                        static_cast<vsi_l_offset>(inputData.size()),
-                                        FALSE);
-            if (!fpIn) throw std::runtime_error("Failed to create input ZIP file");
-            VSIFCloseL(fpIn); fpIn = nullptr;
-
-            const std::string zipVsi = "/vsizip/" + zipPath;
-            inputPath = pickTabInsideZip(zipVsi);
-            if (inputPath.empty()) throw std::runtime_error("No .tab found in input ZIP");
-        } else if (inFmt == "openfilegdb") {
-            const std::string zipPath = "/vsimem/input.zip";
-            fpIn = VSIFileFromMemBuffer(zipPath.c_str(),
-                                        const_cast<GByte*>(inputData.data()),
-                                        static_cast<vsi_l_offset>(inputData.size()),
-                                        FALSE);
-            if (!fpIn) throw std::runtime_error("Failed to create input ZIP file");
-            VSIFCloseL(fpIn); fpIn = nullptr;
-
-            const std::string zipVsi = "/vsizip/" + zipPath;
-            inputPath = pickGdbInsideZip(zipVsi);
-            if (inputPath.empty()) throw std::runtime_error("No .gdb folder found in input ZIP");
-        } else {
-            std::string inputExt = getExtensionFromFormat(inFmt);
-            if (inputExt == ".zip") inputExt = ".dat"; // non-shp should not be zip here
-            inputPath = "/vsimem/input" + inputExt;
-            fpIn = VSIFileFromMemBuffer(inputPath.c_str(),
-                                        const_cast<GByte*>(inputData.data()),
-                                        static_cast<vsi_l_offset>(inputData.size()),
-                                        FALSE);
-            if (!fpIn) throw std::runtime_error("Failed to create input virtual file");
-            VSIFCloseL(fpIn); fpIn = nullptr;
-        }
-
-        GDALDataset* poSrcDS = (GDALDataset*)GDALOpenEx(
-            inputPath.c_str(), GDAL_OF_VECTOR | GDAL_OF_READONLY, nullptr, nullptr, nullptr
-        );
-        if (!poSrcDS) throw std::runtime_error("Failed to open input dataset");
-
-        // ---- 2) Decide driver and output path
-        driver = getDriverNameFromFormat(outputFormat);
-        const std::string outExt = getExtensionFromFormat(outputFormat);
-
-        // Special case SHP: write to individual directory, then collect all files
-        if (driver == "ESRI Shapefile") {
-            const std::string baseDir = "/vsimem/shp_output";
-
-            const int nL = poSrcDS->GetLayerCount();
-            for (int i = 0; i < nL; i++) {
-                OGRLayer* L = poSrcDS->GetLayer(i);
-                if (!L) continue;
-                const std::string srcLayerName = L->GetName();
-
-                // Skip GPX auxiliary layers (*_points) - these are just helper layers
-                // The actual geometries are in tracks/routes/waypoints layers
-                std::string lowerLayerName = toLower(srcLayerName);
-                if (lowerLayerName == "track_points" || lowerLayerName == "route_points") {
-                    continue;
-                }
+        Session* session = lookupSession(sessionId);
+        session->pageLayer = nullptr;
+        beginCallMemory(opt.memoryBudget, session->inputBytes, job.dir);
+        memoryCheckpoint("starting");
+        std::string zipPath;
+        {
+            PhaseTimer timer(g_timings.translate);
+            zipPath = translateLayer(session->ds.get(), session->inputFormat, sourceLayer, opt, job);
+        }
+        memoryCheckpoint("translating", true);
+        outputId = zipPath.empty() ? -1 : registerOutput(zipPath);
+    } catch (const std::exception& ex) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty() && ex.what()) {
+            g_lastError = ex.what();
+        }
+        overrideAbortError();
+        outputId = 0;
+    }
 
-                // We split into up to 4 shapefiles per layer, only if counts > 0
-                struct Part { const char* where; const char* suffix; bool promoteToMulti; };
-                const Part parts[] = {
-                    { WHERE_POINT,      "_point",      false },
-                    { WHERE_MULTIPOINT, "_multipoint", false },
-                    { WHERE_LINES,      "_lines",      true  },
-                    { WHERE_POLYS,      "_polygons",   true  }
-                };
+    CPLPopErrorHandler();
+    return outputId;
+}
 
-                for (const auto& p : parts) {
-                    GIntBig cnt = countGeomWhere(poSrcDS, srcLayerName, p.where);
-                    if (cnt <= 0) continue;
-
-                    const std::string baseName =
-                        (layerName.empty() ? srcLayerName : layerName) + std::string(p.suffix);
-                    const std::string outPath = baseDir + "/" + baseName + ".shp";
-
-                    std::vector<std::string> args = {
-                        "-f", "ESRI Shapefile",
-                        "-where", p.where,
-                        "-nln", baseName,
-                        "-dim", keepZ ? "XYZ" : "XY",
-                        srcLayerName  // Specify which layer to convert
-                    };
-
-                    // Explode collections
-                    if (explodeCollections) {
-                        args.push_back("-explodecollections");
-                    }
+// ----------------- batches -----------------
+// A batch converts many inputs (e.g. hundreds of small KMLs) with one plan and
+// one setup: the worker feeds them one at a time while it reads the next file.
+// Merged batches keep every result in the batch's job directory ("zip") or
+// append every input's features to one staging GeoPackage layer ("layer"),
+// which finishBatch writes out in the plan's format.
+
+struct Batch {
+    JobScope job;
+    ConversionPlan plan;
+    std::string merge;                  // "", "zip" or "layer"
+    int converted = 0;
+    std::set<std::string> memberNames;  // zip: file names taken so far
+    DatasetPtr staging;                 // layer: every input's features so far
+    OGRLayer* stagingLayer = nullptr;
+    SharedSrs stagingSrs;               // layer: the first input's output CRS
+    std::string stagingSrsKey;
+};
+
+static std::mutex g_batchesMutex;
+static std::map<int, std::unique_ptr<Batch>> g_batches;
+static int g_nextBatchId = 1;
+
+static Batch* lookupBatch(int batchId) {
+    std::lock_guard<std::mutex> lock(g_batchesMutex);
+    auto it = g_batches.find(batchId);
+    if (it == g_batches.end()) {
+        throw std::runtime_error("Unknown batch " + std::to_string(batchId));
+    }
+    return it->second.get();
+}
 
-                    if (p.promoteToMulti) {
-                        args.insert(args.end(), {"-nlt", "PROMOTE_TO_MULTI"});
-                    }
+// "name.kml" -> "name.geojson", with "_2", "_3", ... for names already taken
+static std::string batchMemberName(Batch& batch, const std::string& inputName, const std::string& resultPath) {
+    std::string base = CPLGetBasename(inputName.c_str());
+    if (base.empty()) base = "output_" + std::to_string(batch.converted + 1);
+    const std::string ext = CPLGetExtension(resultPath.c_str());
+    const std::string suffix = ext.empty() ? "" : "." + ext;
 
-                    // Global options
-                    if (skipFailures) args.push_back("-skipfailures");
-                    if (makeValid) args.push_back("-makevalid");
-                    if (preserveFid) args.push_back("-preserve_fid");
-                    if (simplifyTolerance > 0) {
-                        args.insert(args.end(), {"-simplify", std::to_string(simplifyTolerance)});
-                    }
+    std::string name = base + suffix;
+    for (int n = 2; batch.memberNames.count(name); n++) {
+        name = base + "_" + std::to_string(n) + suffix;
+    }
+    batch.memberNames.insert(name);
+    return name;
+}
 
-                    pushDriverLCO(args, driver, geojsonPrecision, csvGeometryMode);
-                    pushCrsArgs(args, poSrcDS, sourceCrs, targetCrs);
+// staging layer fields for the selected source fields, matched by name so
+// inputs with the same schema share columns; map[i] is the staging index of
+// source field i, or -1
+static std::vector<int> mergeFieldsInto(OGRFeatureDefn* srcDefn, OGRLayer* dstLayer,
+                                        const std::vector<int>& srcFields) {
+    std::vector<int> fieldMap(srcDefn->GetFieldCount(), -1);
+    OGRFeatureDefn* dstDefn = dstLayer->GetLayerDefn();
+    const JobString fidColumn = toLower(dstLayer->GetFIDColumn());
+    for (int i : srcFields) {
+        OGRFieldDefn* fld = srcDefn->GetFieldDefn(i);
+        if (!fidColumn.empty() && toLower(fld->GetNameRef()) == fidColumn) continue;
+        const int existing = dstDefn->GetFieldIndex(fld->GetNameRef());
+        if (existing >= 0) {
+            fieldMap[i] = existing;
+            continue;
+        }
+        const int before = dstDefn->GetFieldCount();
+        if (dstLayer->CreateField(fld, TRUE) == OGRERR_NONE &&
+            dstDefn->GetFieldCount() > before) {
+            fieldMap[i] = before;
+        }
+    }
+    return fieldMap;
+}
 
-                    GDALDataset* dst = runVectorTranslate(poSrcDS, outPath, args);
-                    if (!dst) {
-                        continue;
-                    }
-                    GDALClose(dst);
-                }
-            }
+// append the layers of one opened input to the staging layer, in one
+// transaction so a failed input leaves nothing behind
+static void appendToStaging(Batch& batch, GDALDataset* src) {
+    const ConversionPlan& plan = batch.plan;
+    if (!batch.staging) {
+        GDALDriver* gpkg = GetGDALDriverManager()->GetDriverByName("GPKG");
+        if (!gpkg) {
+            throw std::runtime_error("Driver not available: GPKG");
+        }
+        batch.staging.reset(gpkg->Create(batch.job.path("merged.gpkg").c_str(), 0, 0, 0, GDT_Unknown, nullptr));
+        if (!batch.staging) {
+            throw std::runtime_error("Failed to create the batch staging file");
+        }
+    }
 
-            // Now collect all files from the directory and create a proper ZIP
-            // Using GDAL's /vsizip/ in write mode
-            char** fileList = VSIReadDir(baseDir.c_str());
-            if (!fileList) {
-                throw std::runtime_error("No shapefile components created");
+    struct LayerJob {
+        OGRLayer* layer;
+        LayerCrsPlan crs;
+        std::vector<int> fieldMap;
+    };
+    std::vector<LayerJob> jobs;
+    for (OGRLayer* L : datasetLayers(src)) {
+        if (isGpxAuxiliaryLayer(L->GetName())) continue;
+        jobs.emplace_back();
+        LayerJob& job = jobs.back();
+        job.layer = L;
+        planLayerCrs(L, plan.sourceCrs, plan.targetCrs, job.crs);
+
+        if (!batch.stagingLayer) {
+            if (job.crs.outSrs) {
+                batch.stagingSrs = shareSrs(job.crs.outSrs->Clone());
+                batch.stagingSrsKey = srsCacheKey(batch.stagingSrs.get());
             }
-
-            // Create a proper ZIP by copying files into it
-            const std::string zipPath = "/vsimem/output.zip";
-            for (int i = 0; fileList[i] != nullptr; i++) {
-                std::string fileName = fileList[i];
-                if (fileName == "." || fileName == "..") continue;
-
-                std::string srcPath = baseDir + "/" + fileName;
-                std::string dstPath = "/vsizip/" + zipPath + "/" + fileName;
-
-                // Read source file
-                vsi_l_offset nBytes = 0;
-                GByte* fileData = VSIGetMemFileBuffer(srcPath.c_str(), &nBytes, FALSE);
-                if (fileData && nBytes > 0) {
-                    // Write to ZIP
-                    VSILFILE* fpOut = VSIFOpenL(dstPath.c_str(), "wb");
-                    if (fpOut) {
-                        VSIFWriteL(fileData, 1, nBytes, fpOut);
-                        VSIFCloseL(fpOut);
-                    }
-                }
-                VSIUnlink(srcPath.c_str());
+            const std::string name = plan.layerName.empty() ? std::string("merged") : plan.layerName;
+            batch.stagingLayer = batch.staging->CreateLayer(name.c_str(), batch.stagingSrs.get(),
+                                                            OGR_GT_SetModifier(wkbUnknown, plan.keepZ ? TRUE : FALSE, FALSE), nullptr);
+            if (!batch.stagingLayer) {
+                throw std::runtime_error("Failed to create the batch staging layer");
             }
-            CSLDestroy(fileList);
-            VSIRmdirRecursive(baseDir.c_str());
-
-            // collect the resulting ZIP bytes
-            vsi_l_offset zipLen = 0;
-            GByte* zipBuf = VSIGetMemFileBuffer(zipPath.c_str(), &zipLen, FALSE);
-            if (zipBuf && zipLen > 0) {
-                result.assign(zipBuf, zipBuf + zipLen);
-            } else {
-                throw std::runtime_error("Failed to create shapefile ZIP");
+        } else if (plan.targetCrs.empty() && batch.stagingSrs && job.crs.outSrs &&
+                   !job.crs.outSrs->IsSame(batch.stagingSrs.get())) {
+            // with no target CRS, later inputs join the first one's
+            job.crs.transform = cachedTransform(job.crs.outSrs, srsCacheKey(job.crs.outSrs),
+                                                batch.stagingSrs.get(), batch.stagingSrsKey);
+            if (!job.crs.transform) {
+                throw std::runtime_error(std::string("Unable to compute transformation of ") + L->GetName() +
+                                         " to the CRS of the first input");
             }
-            VSIUnlink(zipPath.c_str());
         }
-        else if (driver == "OpenFileGDB") {
-            // Special case for OpenFileGDB: write to .gdb directory, then ZIP it
-            const std::string gdbName = layerName.empty() ? "output.gdb" : layerName + ".gdb";
-            const std::string gdbDir = "/vsimem/" + gdbName;
-
-            std::vector<std::string> args = {
-                "-f", "OpenFileGDB",
-                "-dim", keepZ ? "XYZ" : "XY"
-            };
+        // schema changes stay outside the transaction
+        job.fieldMap = mergeFieldsInto(L->GetLayerDefn(), batch.stagingLayer,
+                                       selectedFields(L->GetLayerDefn(), plan.selectFields));
+    }
 
-            // Explode collections
-            if (explodeCollections) {
-                args.push_back("-explodecollections");
-            }
+    const bool transaction = batch.staging->StartTransaction() == OGRERR_NONE;
+    try {
+        for (size_t i = 0; i < jobs.size(); i++) {
+            ProgressStage stage(i, jobs.size());
+            FeatureSink sink;
+            sink.name = batch.stagingLayer->GetName();
+            sink.layer = batch.stagingLayer;
+            sink.fieldMap = jobs[i].fieldMap;
+            sink.failFast = true;
+
+            SingleSinkRouter router(sink);
+            pumpLayer(jobs[i].layer, pumpOptionsFor(plan, jobs[i].layer, jobs[i].crs.transform.get()), router);
+        }
+        if (transaction && batch.staging->CommitTransaction() != OGRERR_NONE) {
+            throw std::runtime_error("Failed to commit features to the batch staging layer");
+        }
+    } catch (...) {
+        if (transaction) batch.staging->RollbackTransaction();
+        throw;
+    }
+}
 
-            // Global options
-            if (skipFailures) args.push_back("-skipfailures");
-            if (makeValid) args.push_back("-makevalid");
-            if (preserveFid) args.push_back("-preserve_fid");
+int Native::openBatch(const ConversionPlan& plan, const std::string& merge) {
+    ensureInitialized();
+    resetLastError();
 
-            // Simplify geometry
-            if (simplifyTolerance > 0) {
-                args.insert(args.end(), {"-simplify", std::to_string(simplifyTolerance)});
-            }
+    const JobString mode = toLower(merge);
+    if (mode != "" && mode != "zip" && mode != "layer") {
+        g_lastError = "Unknown batch merge mode: " + merge;
+        return 0;
+    }
 
-            // Optional layer rename
-            if (!layerName.empty()) {
-                args.insert(args.end(), {"-nln", layerName});
-            }
+    std::unique_ptr<Batch> batch(new Batch());
+    batch->plan = plan;
+    batch->plan.adoptInput = true;  // every addBatchInput buffer is owned by the batch
+    batch->merge = mode;
 
-            // Optional geometry filter
-            const std::string where = whereFromFilter(geometryTypeFilter);
-            if (!where.empty()) {
-                args.insert(args.end(), {"-where", where});
-            }
+    std::lock_guard<std::mutex> lock(g_batchesMutex);
+    const int batchId = g_nextBatchId++;
+    g_batches[batchId] = std::move(batch);
+    return batchId;
+}
 
-            // User-provided WHERE clause
-            if (!whereClause.empty()) {
-                args.insert(args.end(), {"-where", whereClause});
-            }
+int Native::addBatchInput(
+    int batchId,
+    size_t inputAddress,
+    size_t inputSize,
+    const std::string& inputFormat,
+    const std::string& name
+) {
+    GByte* data = reinterpret_cast<GByte*>(inputAddress);
+    Batch* batch = nullptr;
+    try {
+        batch = lookupBatch(batchId);
+    } catch (const std::exception& ex) {
+        resetLastError();
+        g_lastError = ex.what();
+        VSIFree(data);
+        return 0;
+    }
 
-            // Field selection
-            if (!selectFields.empty()) {
-                args.insert(args.end(), {"-select", selectFields});
-            }
+    if (batch->merge != "layer") {
+        JobScope job;
+        const std::string result = convertVectorImpl(data, inputSize, inputFormat, batch->plan, job, true);
+        if (result.empty()) return 0;
+        batch->converted++;
+        if (batch->merge.empty()) return registerOutput(result);
+
+        const std::string memberPath = batch->job.path("members/" + batchMemberName(*batch, name, result));
+        if (VSIRename(result.c_str(), memberPath.c_str()) != 0) {
+            g_lastError = "Failed to keep the batch output of " + name;
+            return 0;
+        }
+        return batch->converted;
+    }
 
-            pushCrsArgs(args, poSrcDS, sourceCrs, targetCrs);
+    ensureInitialized();
+    resetLastError();
+    resetCallInstrumentation();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
 
-            GDALDataset* dst = runVectorTranslate(poSrcDS, gdbDir, args);
-            if (!dst) {
-                GDALClose(poSrcDS);
-                throw std::runtime_error("Vector translate to OpenFileGDB failed");
-            }
-            GDALClose(dst);
+    int converted = 0;
+    JobScope job;
+    std::string memFile;
+    try {
+        const std::string inFmt = heapString(toLower(inputFormat));
+        beginCallMemory(batch->plan.memoryBudget, inputSize, job.dir);
+        memoryCheckpoint("starting");
+        std::string inputPath;
+        {
+            PhaseTimer timer(g_timings.materialize);
+            inputPath = materializeInput(data, inputSize, inFmt, job.path("input"), memFile, true);
+        }
+        DatasetPtr src;
+        {
+            PhaseTimer timer(g_timings.open);
+            src.reset(openInputDataset(inputPath, inFmt));
+        }
+        memoryCheckpoint("opening input");
+        {
+            PhaseTimer timer(g_timings.translate);
+            appendToStaging(*batch, src.get());
+        }
+        memoryCheckpoint("translating");
+        converted = ++batch->converted;
+    } catch (const std::exception& ex) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty() && ex.what()) {
+            g_lastError = ex.what();
+        }
+        overrideAbortError();
+    }
 
-            // Now ZIP the .gdb directory
-            const std::string zipPath = "/vsimem/output.zip";
-            copyDirToZip(gdbDir, zipPath, gdbName);
+    if (!memFile.empty()) {
+        VSIUnlink(memFile.c_str());
+    } else {
+        VSIFree(data); // never adopted by /vsimem
+    }
+    CPLPopErrorHandler();
+    return converted;
+}
 
-            // Collect the resulting ZIP bytes
-            vsi_l_offset zipLen = 0;
-            GByte* zipBuf = VSIGetMemFileBuffer(zipPath.c_str(), &zipLen, FALSE);
-            if (zipBuf && zipLen > 0) {
-                result.assign(zipBuf, zipBuf + zipLen);
-            } else {
-                throw std::runtime_error("Failed to create FileGDB ZIP");
-            }
+int Native::finishBatch(int batchId) {
+    ensureInitialized();
+    resetLastError();
+    resetCallInstrumentation();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
 
-            // Cleanup
-            VSIRmdirRecursive(gdbDir.c_str());
-            VSIUnlink(zipPath.c_str());
+    std::string result;
+    try {
+        Batch* batch = lookupBatch(batchId);
+        if (batch->merge.empty()) {
+            CPLPopErrorHandler();
+            return -1;  // every output went out with its addBatchInput
+        }
+        if (batch->converted == 0) {
+            throw std::runtime_error("No batch input was converted");
         }
-        else if (driver == "MapInfo File") {
-            // Special case for MapInfo TAB: write to directory, then ZIP it
-            const std::string baseDir = "/vsimem/mapinfo_output";
-            const std::string baseName = layerName.empty() ? "output" : layerName;
-            const std::string outPath = baseDir + "/" + baseName + ".tab";
-
-            std::vector<std::string> args = {
-                "-f", "MapInfo File",
-                "-dim", keepZ ? "XYZ" : "XY"
-            };
-
-            // Explode collections
-            if (explodeCollections) {
-                args.push_back("-explodecollections");
-            }
 
-            // Global options
-            if (skipFailures) args.push_back("-skipfailures");
-            if (makeValid) args.push_back("-makevalid");
-            if (preserveFid) args.push_back("-preserve_fid");
+        PhaseTimer timer(g_timings.translate);
+        if (batch->merge == "zip") {
+            const std::string zipPath = batch->job.path("output.zip");
+            zipFlatDirectory(batch->job.path("members"), zipPath, batch->plan.zipDeflate);
+            requireMemFile(zipPath, "Failed to create the batch ZIP");
+            result = zipPath;
+        } else {
+            // the plan was applied while staging: write the merged layer out as it is
+            ConversionPlan copy;
+            copy.outputFormat = batch->plan.outputFormat;
+            copy.layerName = batch->stagingLayer->GetName();
+            copy.keepZ = batch->plan.keepZ;
+            copy.skipFailures = batch->plan.skipFailures;
+            copy.geojsonPrecision = batch->plan.geojsonPrecision;
+            copy.csvGeometryMode = batch->plan.csvGeometryMode;
+            copy.zipDeflate = batch->plan.zipDeflate;
+            copy.useTranslate = batch->plan.useTranslate;
+            copy.fastWriters = batch->plan.fastWriters;
+            copy.memoryBudget = batch->plan.memoryBudget;
+            copy.tileMinZoom = batch->plan.tileMinZoom;
+            copy.tileMaxZoom = batch->plan.tileMaxZoom;
+            copy.tileSimplification = batch->plan.tileSimplification;
+            copy.tileSimplificationMaxZoom = batch->plan.tileSimplificationMaxZoom;
+            copy.spatialSort = batch->plan.spatialSort;
+            copy.columnarCompression = batch->plan.columnarCompression;
+            copy.rowGroupSize = batch->plan.rowGroupSize;
+
+            beginCallMemory(copy.memoryBudget, 0, batch->job.dir);
+            batch->stagingLayer->ResetReading();
+            result = translateDataset(batch->staging.get(), "gpkg", copy, batch->job);
+            memoryCheckpoint("translating", true);
+            describeEmptyResult(result, copy);
+        }
+    } catch (const std::exception& ex) {
+        failConversion(result, ex);
+    }
 
-            // Simplify geometry
-            if (simplifyTolerance > 0) {
-                args.insert(args.end(), {"-simplify", std::to_string(simplifyTolerance)});
-            }
+    CPLPopErrorHandler();
+    if (result.empty()) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty()) {
+            g_lastError = "No output produced by GDAL";
+        }
+        return 0;
+    }
+    return registerOutput(result);
+}
 
-            // Optional layer rename
-            if (!layerName.empty()) {
-                args.insert(args.end(), {"-nln", layerName});
-            }
+void Native::closeBatch(int batchId) {
+    std::unique_ptr<Batch> batch;
+    {
+        std::lock_guard<std::mutex> lock(g_batchesMutex);
+        auto it = g_batches.find(batchId);
+        if (it == g_batches.end()) return;
+        batch = std::move(it->second);
+        g_batches.erase(it);
+    }
+    batch->staging.reset();
+}
 
-            // Optional geometry filter
-            const std::string where = whereFromFilter(geometryTypeFilter);
-            if (!where.empty()) {
-                args.insert(args.end(), {"-where", where});
-            }
+// ----------------- incremental updates -----------------
+// updateOutput merges a new input into an earlier output instead of
+// converting the whole dataset again. A GeoPackage target is opened for
+// update and changed in one transaction, so the work follows the size of the
+// change; FlatGeobuf has no in-place updates and is rewritten (its packed
+// R-tree is built over all features).
+
+// one input layer, converted into the target layer
+struct UpdateJob {
+    OGRLayer* layer;
+    LayerCrsPlan crs;
+    std::vector<int> fieldMap;
+    int keyField = -1;          // upserts by key: the key field of layer
+};
+
+static OGRLayer* updateTargetLayer(GDALDataset* ds, const std::string& name) {
+    OGRLayer* L = name.empty() ? ds->GetLayer(0) : ds->GetLayerByName(name.c_str());
+    if (!L) {
+        throw std::runtime_error(name.empty() ? std::string("The update target has no layer")
+                                              : "Layer " + name + " not found in the update target");
+    }
+    return L;
+}
 
-            // User-provided WHERE clause
-            if (!whereClause.empty()) {
-                args.insert(args.end(), {"-where", whereClause});
+// the input layers to write into target: reprojected to its CRS, their
+// fields matched by name (missing ones are added to target)
+static std::vector<UpdateJob> planUpdateJobs(GDALDataset* src, OGRLayer* target,
+                                             const ConversionPlan& plan, const std::string& key) {
+    const OGRSpatialReference* targetSrs = target->GetSpatialRef();
+    const std::string targetSrsKey = targetSrs ? srsCacheKey(targetSrs) : std::string();
+    std::vector<UpdateJob> jobs;
+    for (OGRLayer* L : datasetLayers(src)) {
+        if (isGpxAuxiliaryLayer(L->GetName())) continue;
+        jobs.emplace_back();
+        UpdateJob& job = jobs.back();
+        job.layer = L;
+        planLayerCrs(L, plan.sourceCrs, "", job.crs);
+        if (targetSrs && job.crs.outSrs && !job.crs.outSrs->IsSame(targetSrs)) {
+            job.crs.transform = cachedTransform(job.crs.outSrs, srsCacheKey(job.crs.outSrs),
+                                                targetSrs, targetSrsKey);
+            if (!job.crs.transform) {
+                throw std::runtime_error(std::string("Unable to compute transformation of ") + L->GetName() +
+                                         " to the CRS of the update target");
             }
-
-            // Field selection
-            if (!selectFields.empty()) {
-                args.insert(args.end(), {"-select", selectFields});
+        }
+        if (!key.empty()) {
+            job.keyField = L->GetLayerDefn()->GetFieldIndex(key.c_str());
+            if (job.keyField < 0) {
+                throw std::runtime_error("Key field " + key + " not found in input layer " + L->GetName());
             }
+        }
+        job.fieldMap = mergeFieldsInto(L->GetLayerDefn(), target,
+                                       selectedFields(L->GetLayerDefn(), plan.selectFields));
+    }
+    if (jobs.empty()) {
+        throw std::runtime_error("No layers found in the update input");
+    }
+    return jobs;
+}
 
-            // CRS behavior
-            pushCrsArgs(args, poSrcDS, sourceCrs, targetCrs);
-
-            GDALDataset* dst = runVectorTranslate(poSrcDS, outPath, args);
-            if (!dst) {
-                GDALClose(poSrcDS);
-                throw std::runtime_error("Vector translate failed");
-            }
-            GDALClose(dst);
+static void pumpUpdateJobs(const std::vector<UpdateJob>& jobs, OGRLayer* target,
+                           const ConversionPlan& plan, UpsertIndex* upsert) {
+    for (size_t i = 0; i < jobs.size(); i++) {
+        ProgressStage stage(i, jobs.size());
+        FeatureSink sink;
+        sink.name = target->GetName();
+        sink.layer = target;
+        sink.fieldMap = jobs[i].fieldMap;
+        // FID upserts keep the input FIDs, so the next update matches them again
+        sink.preserveFid = plan.preserveFid || (upsert && upsert->keyColumn.empty());
+        sink.failFast = true;
+        sink.upsert = upsert;
+        if (upsert) upsert->sourceKey = jobs[i].keyField;
+
+        SingleSinkRouter router(sink);
+        pumpLayer(jobs[i].layer, pumpOptionsFor(plan, jobs[i].layer, jobs[i].crs.transform.get()), router);
+    }
+}
 
-            // Collect all MapInfo files (.tab, .dat, .map, .id, .ind) and ZIP them
-            const std::string zipPath = "/vsimem/mapinfo_output.zip";
-            char** fileList = VSIReadDir(baseDir.c_str());
-            for (int i = 0; fileList && fileList[i]; i++) {
-                const std::string filename = fileList[i];
-                if (filename == "." || filename == "..") continue;
+// returns targetPath, updated in place
+static std::string updateGeoPackage(const std::string& targetPath, GDALDataset* src,
+                                    const ConversionPlan& plan, bool upserts, const std::string& key) {
+    const char* const drivers[] = {"GPKG", nullptr};
+    DatasetPtr ds((GDALDataset*)GDALOpenEx(targetPath.c_str(), GDAL_OF_VECTOR | GDAL_OF_UPDATE,
+                                           drivers, nullptr, nullptr));
+    if (!ds) throw std::runtime_error("Failed to open the update target GeoPackage");
+    OGRLayer* target = updateTargetLayer(ds.get(), plan.layerName);
+
+    // schema changes (new fields, the key index) stay outside the transaction
+    std::vector<UpdateJob> jobs = planUpdateJobs(src, target, plan, upserts ? key : std::string());
+    UpsertIndex upsert;
+    upsert.target = target;
+    if (upserts && !key.empty()) {
+        if (target->GetLayerDefn()->GetFieldIndex(key.c_str()) < 0) {
+            throw std::runtime_error("Key field " + key + " not found in layer " + target->GetName());
+        }
+        // keeps every lookup an index search; stays in the file for the next update
+        const std::string table = target->GetName();
+        const std::string sql = "CREATE INDEX IF NOT EXISTS " + sqlIdentifier("idx_" + table + "_" + key) +
+                                " ON " + sqlIdentifier(table) + " (" + sqlIdentifier(key) + ")";
+        // quiet: a failure here is not the error of the update
+        CPLErrorReset();
+        CPLPushErrorHandler(CPLQuietErrorHandler);
+        OGRLayer* rs = ds->ExecuteSQL(sql.c_str(), nullptr, nullptr);
+        if (rs) ds->ReleaseResultSet(rs);
+        CPLPopErrorHandler();
+        if (CPLGetLastErrorType() == CE_Failure) {
+            // the upsert still works, each batch lookup scans the table instead
+            CPLDebug("GEOCONVERTER", "%s: key index not created: %s", table.c_str(), CPLGetLastErrorMsg());
+            CPLErrorReset();
+        }
+        upsert.keyColumn = sqlIdentifier(key);
+        upsert.targetKey = target->GetLayerDefn()->GetFieldIndex(key.c_str());
+    }
 
-                const std::string srcPath = baseDir + "/" + filename;
-                const std::string dstPath = std::string("/vsizip/") + zipPath + "/" + filename;
+    // one transaction for the whole update: a failed input leaves the target as it was
+    if (ds->StartTransaction() != OGRERR_NONE) {
+        throw std::runtime_error("Failed to start the update transaction");
+    }
+    try {
+        pumpUpdateJobs(jobs, target, plan, upserts ? &upsert : nullptr);
+        target->SetAttributeFilter(nullptr);
+        if (ds->CommitTransaction() != OGRERR_NONE) {
+            throw std::runtime_error("Failed to commit the update of layer " + std::string(target->GetName()));
+        }
+    } catch (...) {
+        target->SetAttributeFilter(nullptr);
+        ds->RollbackTransaction();
+        throw;
+    }
+    if (upserts) {
+        CPLDebug("GEOCONVERTER", "%s: upsert replaced " CPL_FRMT_GIB " features", target->GetName(), upsert.replaced);
+    }
+    ds.reset();
+    return targetPath;
+}
 
-                // Copy file to ZIP
-                vsi_l_offset nBytes = 0;
-                GByte* fileData = VSIGetMemFileBuffer(srcPath.c_str(), &nBytes, FALSE);
-                if (fileData && nBytes > 0) {
-                    VSILFILE* fpOut = VSIFOpenL(dstPath.c_str(), "wb");
-                    if (fpOut) {
-                        VSIFWriteL(fileData, 1, nBytes, fpOut);
-                        VSIFCloseL(fpOut);
-                    }
-                }
-                VSIUnlink(srcPath.c_str());
-            }
-            CSLDestroy(fileList);
-            VSIRmdirRecursive(baseDir.c_str());
+// returns the rewritten file: the target's features (less those an upsert
+// replaces) followed by the input's
+static std::string updateFlatGeobuf(const std::string& targetPath, GDALDataset* src,
+                                    const ConversionPlan& plan, bool upserts, const std::string& key,
+                                    const JobScope& job) {
+    if (upserts && key.empty()) {
+        throw std::runtime_error("FlatGeobuf upserts need a key field: FlatGeobuf keeps no FIDs");
+    }
+    DatasetPtr targetDs(openVectorDataset(targetPath));
+    OGRLayer* target = updateTargetLayer(targetDs.get(), plan.layerName);
+    const int targetKey = upserts ? target->GetLayerDefn()->GetFieldIndex(key.c_str()) : -1;
+    if (upserts && targetKey < 0) {
+        throw std::runtime_error("Key field " + key + " not found in layer " + target->GetName());
+    }
 
-            // Collect the resulting ZIP bytes
-            vsi_l_offset zipLen = 0;
-            GByte* zipBuf = VSIGetMemFileBuffer(zipPath.c_str(), &zipLen, FALSE);
-            if (zipBuf && zipLen > 0) {
-                result.assign(zipBuf, zipBuf + zipLen);
-            } else {
-                throw std::runtime_error("Failed to create MapInfo ZIP");
+    GDALDriver* drv = GetGDALDriverManager()->GetDriverByName("FlatGeobuf");
+    if (!drv) {
+        throw std::runtime_error("Driver not available: FlatGeobuf");
+    }
+    const std::string outPath = job.path("updated.fgb");
+    DatasetPtr out(drv->Create(outPath.c_str(), 0, 0, 0, GDT_Unknown, nullptr));
+    if (!out) throw std::runtime_error("Failed to create the updated FlatGeobuf");
+    OGRLayer* outLayer = out->CreateLayer(target->GetName(), target->GetSpatialRef(), target->GetGeomType(), nullptr);
+    if (!outLayer) throw std::runtime_error("Failed to create layer " + std::string(target->GetName()));
+
+    // every field exists before the first feature is written
+    const std::vector<int> targetMap = createFieldsLike(target->GetLayerDefn(), outLayer,
+                                                        selectedFields(target->GetLayerDefn(), ""));
+    std::vector<UpdateJob> jobs = planUpdateJobs(src, outLayer, plan, upserts ? key : std::string());
+
+    // upserts: the keys of the input features, whose target versions are not copied,
+    // as the target's key column prints them (see upsertKeyOf)
+    std::set<std::string> keys;
+    if (upserts) {
+        UpsertIndex keyed;
+        keyed.target = target;
+        keyed.targetKey = targetKey;
+        for (const UpdateJob& j : jobs) {
+            const PumpOptions opts = pumpOptionsFor(plan, j.layer, nullptr);
+            AttributeFilterScope filter(j.layer, opts.where);
+            SpatialFilterScope spatialFilter(j.layer, opts);
+            keyed.sourceKey = j.keyField;
+            j.layer->ResetReading();
+            for (FeaturePtr f(j.layer->GetNextFeature()); f; f.reset(j.layer->GetNextFeature())) {
+                if (f->IsFieldSetAndNotNull(j.keyField)) keys.insert(upsertKeyOf(keyed, f.get()));
             }
-            VSIUnlink(zipPath.c_str());
         }
-        else {
-            // Non-SHP/GDB formats
-            // For GPX input, process multiple layers and create a ZIP with separate files
-            if (inFmt == "gpx" && layerName.empty() && geometryTypeFilter.empty()) {
-                const std::string baseDir = "/vsimem/output_files";
-
-                const int nL = poSrcDS->GetLayerCount();
-                bool hasOutput = false;
+    }
 
-                for (int i = 0; i < nL; i++) {
-                    OGRLayer* L = poSrcDS->GetLayer(i);
-                    if (!L) continue;
-                    const std::string srcLayerName = L->GetName();
+    GIntBig copied = 0;
+    GIntBig replaced = 0;
+    FeaturePtr dst(OGRFeature::CreateFeature(outLayer->GetLayerDefn()));
+    target->ResetReading();
+    for (FeaturePtr f(target->GetNextFeature()); f; f.reset(target->GetNextFeature())) {
+        if ((copied + replaced) % static_cast<GIntBig>(PUMP_BATCH_FEATURES) == 0) {
+            throwIfCancelled(-1, "translate");
+        }
+        if (targetKey >= 0 && f->IsFieldSetAndNotNull(targetKey) && keys.count(f->GetFieldAsString(targetKey))) {
+            replaced++;
+            continue;
+        }
+        dst->SetFrom(f.get(), targetMap.data(), TRUE);
+        dst->SetFID(OGRNullFID);
+        if (outLayer->CreateFeature(dst.get()) != OGRERR_NONE) {
+            throw std::runtime_error("Failed to copy feature " + std::to_string(f->GetFID()) +
+                                     " of the update target");
+        }
+        copied++;
+    }
+    memoryCheckpoint("translating");
+
+    pumpUpdateJobs(jobs, outLayer, plan, nullptr);
+    CPLDebug("GEOCONVERTER", "%s: kept " CPL_FRMT_GIB " features, replaced " CPL_FRMT_GIB,
+             target->GetName(), copied, replaced);
+    out.reset();    // writes the packed index
+    requireMemFile(outPath, "Failed to write the updated FlatGeobuf");
+    return outPath;
+}
 
-                    // Skip GPX auxiliary layers
-                    std::string lowerLayerName = toLower(srcLayerName);
-                    if (lowerLayerName == "track_points" || lowerLayerName == "route_points") {
-                        continue;
-                    }
+int Native::updateOutput(
+    size_t targetAddress,
+    size_t targetSize,
+    const std::string& targetFormat,
+    size_t inputAddress,
+    size_t inputSize,
+    const std::string& inputFormat,
+    const ConversionPlan& plan,
+    const std::string& mode,
+    const std::string& key
+) {
+    ensureInitialized();
+    resetLastError();
+    resetCallInstrumentation();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
 
-                    // Check if layer has features
-                    GIntBig featureCount = L->GetFeatureCount();
-                    if (featureCount <= 0) continue;
-
-                    const std::string outPath = baseDir + "/" + srcLayerName + outExt;
-
-                    std::vector<std::string> args = {
-                        "-f", driver,
-                        "-dim", keepZ ? "XYZ" : "XY",
-                        "-nln", srcLayerName,
-                        srcLayerName  // Specify layer to convert
-                    };
-
-                    if (explodeCollections) args.push_back("-explodecollections");
-                    if (skipFailures) args.push_back("-skipfailures");
-                    if (makeValid) args.push_back("-makevalid");
-                    if (preserveFid) args.push_back("-preserve_fid");
-                    if (simplifyTolerance > 0) {
-                        args.insert(args.end(), {"-simplify", std::to_string(simplifyTolerance)});
-                    }
-                    if (!selectFields.empty()) {
-                        args.insert(args.end(), {"-select", selectFields});
-                    }
+    GByte* targetData = reinterpret_cast<GByte*>(targetAddress);
+    GByte* inputData = reinterpret_cast<GByte*>(inputAddress);
+    const std::string tgtFmt = heapString(toLower(targetFormat));
+    const std::string inFmt = heapString(toLower(inputFormat));
+    const JobString updateMode = toLower(mode);
 
-                    pushDriverLCO(args, driver, geojsonPrecision, csvGeometryMode);
-                    pushCrsArgs(args, poSrcDS, sourceCrs, targetCrs);
+    std::string result;
+    JobScope job;
+    std::string targetFile;
+    std::string inputFile;
+    try {
+        if (tgtFmt != "geopackage" && tgtFmt != "flatgeobuf") {
+            throw std::runtime_error("Updates need a GeoPackage or FlatGeobuf target, not " + targetFormat);
+        }
+        if (updateMode != "append" && updateMode != "upsert") {
+            throw std::runtime_error("Unknown update mode: " + mode);
+        }
+        if (updateMode == "upsert" && plan.explodeCollections) {
+            throw std::runtime_error("Upserts cannot explode collections: the parts would replace each other");
+        }
 
-                    GDALDataset* dst = runVectorTranslate(poSrcDS, outPath, args);
-                    if (dst) {
-                        GDALClose(dst);
-                        hasOutput = true;
-                    }
-                }
+        // the target layer's CRS is the output CRS (a spatial filter is in the source CRS)
+        ConversionPlan updatePlan = plan;
+        updatePlan.targetCrs.clear();
+        updatePlan.spatialFilterTargetCrs = false;
 
-                if (!hasOutput) {
-                    GDALClose(poSrcDS);
-                    throw std::runtime_error("No valid layers found in GPX file");
-                }
+        beginCallMemory(plan.memoryBudget, targetSize + inputSize, job.dir);
+        memoryCheckpoint("starting");
+        std::string targetPath;
+        std::string inputPath;
+        {
+            PhaseTimer timer(g_timings.materialize);
+            targetPath = materializeInput(targetData, targetSize, tgtFmt, job.path("target"), targetFile, true);
+            inputPath = materializeInput(inputData, inputSize, inFmt, job.path("input"), inputFile, true);
+        }
+        DatasetPtr src;
+        {
+            PhaseTimer timer(g_timings.open);
+            src.reset(openInputDataset(inputPath, inFmt));
+        }
+        memoryCheckpoint("opening input");
+        {
+            PhaseTimer timer(g_timings.translate);
+            const bool upserts = updateMode == "upsert";
+            result = tgtFmt == "geopackage"
+                ? updateGeoPackage(targetPath, src.get(), updatePlan, upserts, key)
+                : updateFlatGeobuf(targetPath, src.get(), updatePlan, upserts, key, job);
+        }
+        memoryCheckpoint("translating", true);
+    } catch (const std::exception& ex) {
+        failConversion(result, ex);
+    }
 
-                // Create ZIP with all output files
-                const std::string zipPath = "/vsimem/output.zip";
-                char** fileList = VSIReadDir(baseDir.c_str());
-                for (int i = 0; fileList && fileList[i]; i++) {
-                    const std::string filename = fileList[i];
-                    if (filename == "." || filename == "..") continue;
-
-                    const std::string srcPath = baseDir + "/" + filename;
-                    const std::string dstPath = "/vsizip/" + zipPath + "/" + filename;
-
-                    vsi_l_offset nBytes = 0;
-                    GByte* fileData = VSIGetMemFileBuffer(srcPath.c_str(), &nBytes, FALSE);
-                    if (fileData && nBytes > 0) {
-                        VSILFILE* fpOut = VSIFOpenL(dstPath.c_str(), "wb");
-                        if (fpOut) {
-                            VSIFWriteL(fileData, 1, nBytes, fpOut);
-                            VSIFCloseL(fpOut);
-                        }
-                    }
-                    VSIUnlink(srcPath.c_str());
-                }
-                CSLDestroy(fileList);
-                VSIRmdirRecursive(baseDir.c_str());
-
-                // Read ZIP into result
-                vsi_l_offset zipLen = 0;
-                GByte* zipBuf = VSIGetMemFileBuffer(zipPath.c_str(), &zipLen, FALSE);
-                if (zipBuf && zipLen > 0) {
-                    result.assign(zipBuf, zipBuf + zipLen);
-                } else {
-                    throw std::runtime_error("Failed to create output ZIP");
-                }
-                VSIUnlink(zipPath.c_str());
+    // never adopted by /vsimem when empty; an updated GeoPackage is the target file itself
+    if (targetFile.empty()) {
+        VSIFree(targetData);
+    } else if (targetFile != result) {
+        VSIUnlink(targetFile.c_str());
+    }
+    if (inputFile.empty()) {
+        VSIFree(inputData);
+    } else {
+        VSIUnlink(inputFile.c_str());
+    }
 
-            } else {
-                // Single output file (non-GPX or user specified layer/filter)
-                const std::string outPath = "/vsimem/output" + outExt;
+    CPLPopErrorHandler();
+    if (result.empty()) {
+        ensureLastErrorMessage();
+        if (g_lastError.empty()) {
+            g_lastError = "No output produced by GDAL";
+        }
+        return 0;
+    }
+    return registerOutput(result);
+}
 
-                std::vector<std::string> args = {
-                    "-f", driver,
-                    "-dim", keepZ ? "XYZ" : "XY"
-                };
+// ----------------- feature pages -----------------
+// Paged reads of session features for virtual-scrolled previews, as one
+// little-endian binary table per page (decoded by src/workers/featurePage.js):
+//   "GCF1", u32 rowCount, u32 columnCount, f64 nextOffset (-1: end of layer)
+//   per column: u8 type, u32 name length, name (UTF-8)
+//   i64 fids[rowCount]
+//   geometries: u32 end offsets[rowCount], ISO WKB (empty: no geometry)
+//   per column: null bitmap (bit i%8 of byte i/8 set: row i is null), then
+//     int32/int64/float64 columns: the values of every row,
+//     string columns: u32 end offsets[rowCount], UTF-8 bytes.
+// Types other than the numeric ones (dates, lists, binary) come as strings.
+
+static const int FEATURE_PAGE_MAX_ROWS = 10000;
+
+enum FeaturePageColumn : GByte {
+    PAGE_INT32 = 1,
+    PAGE_INT64 = 2,
+    PAGE_FLOAT64 = 3,
+    PAGE_STRING = 4
+};
+
+static FeaturePageColumn featurePageColumn(OGRFieldType type) {
+    switch (type) {
+        case OFTInteger:   return PAGE_INT32;
+        case OFTInteger64: return PAGE_INT64;
+        case OFTReal:      return PAGE_FLOAT64;
+        default:           return PAGE_STRING;
+    }
+}
 
-                if (explodeCollections) args.push_back("-explodecollections");
-                if (skipFailures) args.push_back("-skipfailures");
-                if (makeValid) args.push_back("-makevalid");
-                if (preserveFid) args.push_back("-preserve_fid");
-                if (simplifyTolerance > 0) {
-                    args.insert(args.end(), {"-simplify", std::to_string(simplifyTolerance)});
-                }
+template <typename T>
+static void putRaw(std::vector<GByte>& out, T v) {
+    GByte b[sizeof(T)];
+    memcpy(b, &v, sizeof(T));   // wasm and the supported hosts are little-endian
+    out.insert(out.end(), b, b + sizeof(T));
+}
 
-                pushDriverLCO(args, driver, geojsonPrecision, csvGeometryMode);
-                pushCrsArgs(args, poSrcDS, sourceCrs, targetCrs);
+// variable-length values of one column: end offsets, then the bytes
+static void putPageBlobs(std::vector<GByte>& out, const std::vector<std::string>& values) {
+    uint32_t end = 0;
+    for (const std::string& v : values) {
+        end += static_cast<uint32_t>(v.size());
+        putLE32(out, end);
+    }
+    for (const std::string& v : values) out.insert(out.end(), v.begin(), v.end());
+}
 
-                if (!layerName.empty()) {
-                    args.insert(args.end(), {"-nln", layerName});
-                }
+// hand encoded bytes to JS as an output (read and released like a conversion's)
+static int registerOutputBytes(const std::string& memPath, const std::vector<GByte>& bytes) {
+    GByte* buffer = static_cast<GByte*>(VSIMalloc(bytes.size() > 0 ? bytes.size() : 1));
+    if (!buffer) {
+        throw std::runtime_error("Out of memory for output " + memPath);
+    }
+    memcpy(buffer, bytes.data(), bytes.size());
+    VSIFCloseL(VSIFileFromMemBuffer(memPath.c_str(), buffer, bytes.size(), TRUE));
+    return registerOutput(memPath);
+}
 
-                const std::string where = whereFromFilter(geometryTypeFilter);
-                if (!where.empty()) {
-                    args.insert(args.end(), {"-where", where});
-                }
+static std::vector<GByte> encodeFeaturePage(const std::vector<FeaturePtr>& rows, OGRFeatureDefn* defn,
+                                            const std::vector<int>& fields, double nextOffset) {
+    std::vector<GByte> out = {'G', 'C', 'F', '1'};
+    putLE32(out, static_cast<uint32_t>(rows.size()));
+    putLE32(out, static_cast<uint32_t>(fields.size()));
+    putRaw(out, nextOffset);
+
+    for (int i : fields) {
+        const char* name = defn->GetFieldDefn(i)->GetNameRef();
+        out.push_back(featurePageColumn(defn->GetFieldDefn(i)->GetType()));
+        putLE32(out, static_cast<uint32_t>(strlen(name)));
+        out.insert(out.end(), name, name + strlen(name));
+    }
 
-                if (!whereClause.empty()) {
-                    args.insert(args.end(), {"-where", whereClause});
-                }
+    for (const FeaturePtr& f : rows) putRaw<int64_t>(out, f->GetFID());
 
-                if (!selectFields.empty()) {
-                    args.insert(args.end(), {"-select", selectFields});
-                }
+    std::vector<std::string> blobs;
+    blobs.reserve(rows.size());
+    for (const FeaturePtr& f : rows) {
+        const OGRGeometry* g = f->GetGeometryRef();
+        std::string wkb;
+        if (g) {
+            wkb.resize(g->WkbSize());
+            g->exportToWkb(wkbNDR, reinterpret_cast<unsigned char*>(&wkb[0]), wkbVariantIso);
+        }
+        blobs.push_back(std::move(wkb));
+    }
+    putPageBlobs(out, blobs);
 
-                // For GPX, specify layer (default to 'tracks')
-                if (inFmt == "gpx") {
-                    std::string gpxLayer = layerName.empty() ? "tracks" : layerName;
-                    args.push_back(gpxLayer);
-                }
+    for (int i : fields) {
+        std::vector<GByte> nulls((rows.size() + 7) / 8, 0);
+        for (size_t r = 0; r < rows.size(); r++) {
+            if (!rows[r]->IsFieldSetAndNotNull(i)) nulls[r / 8] |= static_cast<GByte>(1 << (r % 8));
+        }
+        out.insert(out.end(), nulls.begin(), nulls.end());
 
-                GDALDataset* dst = runVectorTranslate(poSrcDS, outPath, args);
-                if (!dst) {
-                    GDALClose(poSrcDS);
-                    throw std::runtime_error("Vector translate failed");
-                }
-                GDALClose(dst);
-
-                vsi_l_offset n = 0;
-                GByte* buf = VSIGetMemFileBuffer(outPath.c_str(), &n, FALSE);
-                if (!buf || n == 0) {
-                    GDALClose(poSrcDS);
-                    VSIUnlink(outPath.c_str());
-                    throw std::runtime_error("Failed to read output data");
-                }
-                result.assign(buf, buf + n);
-                VSIUnlink(outPath.c_str());
+        const FeaturePageColumn type = featurePageColumn(defn->GetFieldDefn(i)->GetType());
+        if (type == PAGE_STRING) {
+            blobs.clear();
+            for (const FeaturePtr& f : rows) {
+                blobs.push_back(f->IsFieldSetAndNotNull(i) ? f->GetFieldAsString(i) : "");
             }
+            putPageBlobs(out, blobs);
+            continue;
+        }
+        for (const FeaturePtr& f : rows) {
+            if (type == PAGE_INT32) putRaw<int32_t>(out, f->GetFieldAsInteger(i));
+            else if (type == PAGE_INT64) putRaw<int64_t>(out, f->GetFieldAsInteger64(i));
+            else putRaw<double>(out, f->GetFieldAsDouble(i));
         }
+    }
+    return out;
+}
+
+int Native::getFeatures(
+    int sessionId,
+    const std::string& layerName,
+    double offset,
+    int limit,
+    const std::string& fields
+) {
+    ensureInitialized();
+    resetLastError();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
 
-        GDALClose(poSrcDS);
+    int outputId = 0;
+    JobScope job;
+    try {
+        Session* session = lookupSession(sessionId);
+        OGRLayer* L = layerName.empty() ? session->ds->GetLayer(0)
+                                        : session->ds->GetLayerByName(layerName.c_str());
+        if (!L) {
+            throw std::runtime_error("Layer not found: " + (layerName.empty() ? std::string("(first)") : layerName));
+        }
+        const std::vector<int> columns = selectedFields(L->GetLayerDefn(), fields);
+        const GIntBig start = static_cast<GIntBig>(std::max(0.0, offset));
+        const int count = std::max(0, std::min(limit, FEATURE_PAGE_MAX_ROWS));
+
+        // the next page of a sequential scan continues where the last one stopped;
+        // anything else seeks (drivers without random access skip features)
+        bool positioned = session->pageLayer == L && session->pageNext == start;
+        session->pageLayer = nullptr;
+        if (!positioned) {
+            L->ResetReading();
+            positioned = start == 0 || L->SetNextByIndex(start) == OGRERR_NONE;
+        }
 
-        // cleanup input
-        if (inFmt == "shapefile" || inFmt == "openfilegdb") {
-            VSIUnlink("/vsimem/input.zip");
-        } else {
-            VSIUnlink(inputPath.c_str());
+        std::vector<FeaturePtr> rows;
+        rows.reserve(count);
+        while (positioned && static_cast<int>(rows.size()) < count) {
+            FeaturePtr f(L->GetNextFeature());
+            if (!f) break;
+            rows.push_back(std::move(f));
         }
 
-        if (result.empty()) {
-            ensureLastErrorMessage();
-            if (g_lastError.empty()) {
-                g_lastError = "GDAL returned an empty dataset";
-            }
-            if (!sourceCrs.empty() || !targetCrs.empty()) {
-                g_lastError += " (source CRS: " + (sourceCrs.empty() ? std::string("auto") : sourceCrs)
-                             + ", target CRS: " + (targetCrs.empty() ? std::string("auto") : targetCrs) + ")";
-            }
-            if (!driver.empty()) {
-                g_lastError += " driver=" + driver;
-            }
+        const bool more = positioned && count > 0 && static_cast<int>(rows.size()) == count;
+        if (more) {
+            session->pageLayer = L;
+            session->pageNext = start + count;
         }
+        const std::vector<GByte> page = encodeFeaturePage(rows, L->GetLayerDefn(), columns,
+                                                          more ? static_cast<double>(start + count) : -1.0);
 
+        outputId = registerOutputBytes(job.path("features.bin"), page);
     } catch (const std::exception& ex) {
-        // For now, keep contract: empty vector indicates failure.
         ensureLastErrorMessage();
         if (g_lastError.empty() && ex.what()) {
             g_lastError = ex.what();
         }
-        result.clear();
+        outputId = 0;
     }
 
     CPLPopErrorHandler();
+    return outputId;
+}
 
-    if (result.empty()) {
+// ----------------- binary info -----------------
+// describeDataset's result as one little-endian record (decoded by
+// src/workers/vectorInfo.js), so wide layers skip JSON building and parsing:
+//   "GCI1", u32 layers, u8 flags (INFO_FLAG_*), f64 featureCount,
+//   f64 bboxOriginal[4], f64 bbox[4] (zeros without INFO_HAS_BBOX)
+//   strings (u32 length, UTF-8): geometryType, crs, debugCrs, debugTransform
+//   u32 propertyCount, per property: u8 type (InfoValueType), u8 isNull,
+//     name string, then unless null an i64, f64 or string value.
+// Properties keep their field's type when null (the JSON reports "String").
+
+enum InfoFlag : GByte {
+    INFO_HAS_LAYER = 1,
+    INFO_PROBE = 2,             // count/bbox exactness below is meaningful
+    INFO_COUNT_EXACT = 4,
+    INFO_BBOX_EXACT = 8,
+    INFO_HAS_BBOX = 16,
+    INFO_BBOX_REPROJECTED = 32,
+    INFO_DEBUG = 64
+};
+
+static void putInfoString(std::vector<GByte>& out, const std::string& s) {
+    putLE32(out, static_cast<uint32_t>(s.size()));
+    out.insert(out.end(), s.begin(), s.end());
+}
+
+static std::vector<GByte> encodeDatasetInfo(const DatasetInfo& info) {
+    std::vector<GByte> out = {'G', 'C', 'I', '1'};
+    putLE32(out, static_cast<uint32_t>(info.layers));
+    GByte flags = 0;
+    if (info.hasLayer) flags |= INFO_HAS_LAYER;
+    if (info.probe) flags |= INFO_PROBE;
+    if (info.featureCountExact) flags |= INFO_COUNT_EXACT;
+    if (info.bboxExact) flags |= INFO_BBOX_EXACT;
+    if (info.hasBbox) flags |= INFO_HAS_BBOX;
+    if (info.bboxReprojected) flags |= INFO_BBOX_REPROJECTED;
+    if (info.debugCrs.enabled) flags |= INFO_DEBUG;
+    out.push_back(flags);
+    putRaw(out, static_cast<double>(info.featureCount));
+    for (double v : info.bboxOriginal) putRaw(out, v);
+    for (double v : info.bbox) putRaw(out, v);
+
+    putInfoString(out, info.geometryType);
+    putInfoString(out, info.crs);
+    putInfoString(out, info.debugCrs.text);
+    putInfoString(out, info.debugTransform.text);
+
+    putLE32(out, static_cast<uint32_t>(info.properties.size()));
+    for (const InfoProperty& prop : info.properties) {
+        out.push_back(prop.type);
+        out.push_back(prop.isNull ? 1 : 0);
+        putInfoString(out, prop.name);
+        if (prop.isNull) continue;
+        if (prop.type == INFO_INTEGER) putRaw(out, static_cast<int64_t>(prop.integer));
+        else if (prop.type == INFO_FLOAT) putRaw(out, prop.real);
+        else putInfoString(out, prop.text);
+    }
+    return out;
+}
+
+int Native::getSessionInfoBinary(int sessionId, const std::string& sourceCrs, bool exact) {
+    ensureInitialized();
+    resetLastError();
+    CallArenaScope arenaScope;
+    CallDebugScope debugScope;
+    CPLPushErrorHandler(ErrHandler);
+
+    int outputId = 0;
+    JobScope job;
+    try {
+        Session* session = lookupSession(sessionId);
+        session->pageLayer = nullptr;
+        DatasetInfo info;
+        collectDatasetInfo(session->ds.get(), sourceCrs, exact, info);
+        outputId = registerOutputBytes(job.path("info.bin"), encodeDatasetInfo(info));
+    } catch (const std::exception& ex) {
         ensureLastErrorMessage();
-        if (g_lastError.empty()) {
-            g_lastError = "No output produced by GDAL";
+        if (g_lastError.empty() && ex.what()) {
+            g_lastError = ex.what();
         }
+        outputId = 0;
     }
 
-    return result;
+    CPLPopErrorHandler();
+    return outputId;
 }
 
 std::string Native::getLastError() {
     return g_lastError;
 }
+
+std::string Native::getLastMemoryUsage() {
+    const MemoryState& m = g_memory;
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"peakHeapBytes\":%.0f,\"peakVsimemBytes\":%.0f,\"heapBytes\":%.0f,\"budgetBytes\":%.0f,\"spill\":%s}",
+             static_cast<double>(m.peakHeap), static_cast<double>(m.peakVsimem),
+             static_cast<double>(heapInUse()), static_cast<double>(m.budget), m.spill ? "true" : "false");
+    return buf;
+}
+
+std::string Native::getLastTimings() {
+    const CallTimings& t = g_timings;
+    const double translate = std::max(0.0, t.translate - t.count - t.zip);
+    char buf[256];
+    snprintf(buf, sizeof(buf),
+             "{\"materialize\":%.3f,\"open\":%.3f,\"count\":%.3f,\"translate\":%.3f,\"zip\":%.3f,\"copyOut\":%.3f}",
+             t.materialize, t.open, t.count, translate, t.zip, t.copyOut);
+    return buf;
+}
@@ -1,13 +1,106 @@
 #ifndef _NATIVE_H
 #define _NATIVE_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <vector>
 
+// Typed conversion options, shared by the *WithPlan entry points. Mirrors the
+// positional parameters of convertVector (which fill one of these internally).
+class ConversionPlan {
+public:
+    std::string outputFormat;
+    std::string sourceCrs;
+    std::string targetCrs;
+    std::string layerName;
+    std::string geometryTypeFilter;
+    bool skipFailures = false;
+    bool makeValid = false;
+    bool keepZ = false;
+    std::string whereClause;
+    std::string selectFields;
+    double simplifyTolerance = 0;
+    bool explodeCollections = false;
+    bool preserveFid = false;
+    int geojsonPrecision = 7;
+    std::string csvGeometryMode;
+    bool zipDeflate = true;     // false: store ZIP members uncompressed
+    // Formats the native feature pump writes (GeoJSON, GeoJSONSeq, FlatGeobuf,
+    // GPKG, CSV, MapInfo, FileGDB) go through GDALVectorTranslate instead.
+    bool useTranslate = false;
+    // false: the pump writes GeoJSON through the GDAL driver instead of its own
+    // writer (which follows the driver's output with WRITE_BBOX and precision),
+    // and PMTiles/MBTiles through GDAL's MVT writer instead of the native tiler.
+    bool fastWriters = true;
+    // Heap bytes the call may use (0 = unlimited). Past it the call fails with
+    // "Memory budget exceeded ..."; inputs expected to come close switch to
+    // spill mode (ZIPs built one member at a time, adopted inputs released
+    // once opened). See getLastMemoryUsage.
+    double memoryBudget = 0;
+    // Bounding box "minx,miny,maxx,maxy" the features must intersect ("" =
+    // none), in the source CRS or, with spatialFilterTargetCrs, the target CRS.
+    // Set as the layer's spatial filter, so indexed sources (GPKG, FlatGeobuf,
+    // Shapefile with .qix) never decode the features outside it.
+    std::string spatialFilter;
+    bool spatialFilterTargetCrs = false;
+    // Vector tile outputs (PMTiles, MBTiles): zoom range (-1 = GDAL's MVT
+    // writer default, 0 and 5) and line/polygon simplification in tile units
+    // (of 4096 per tile), below tileMaxZoom; tileSimplificationMaxZoom (-1 =
+    // the same) applies at it. The native tiler and GDAL's writer read them alike.
+    int tileMinZoom = -1;
+    int tileMaxZoom = -1;
+    double tileSimplification = 0;
+    double tileSimplificationMaxZoom = -1;
+    // GPKG output in Hilbert order (FIDs renumbered along it), so bbox queries
+    // read few pages; FlatGeobuf outputs always are, as their packed R-tree
+    // requires. Feature pump only (ignored with useTranslate); fails with
+    // preserveFid. The sort is staged in a temporary file natively and in
+    // memory in WASM, where spill mode writes the layers in source order.
+    bool spatialSort = false;
+    // GeoParquet and Arrow IPC outputs: compression codec ("" = driver
+    // default, e.g. ZSTD or NONE) and rows per row group / record batch (0 =
+    // driver default). Layers without per-geometry work are copied as Arrow
+    // record batches instead of feature by feature.
+    std::string columnarCompression;
+    int rowGroupSize = 0;
+    // convertBufferWithPlan takes ownership of the allocBuffer() input and
+    // frees it itself; the caller must not call freeBuffer on it.
+    bool adoptInput = false;
+};
+
 class Native {
 public:
     static std::string getGdalInfo();
+
+    // One-time GDAL/PROJ setup; other methods call it implicitly. drivers is a
+    // comma-separated list of GDAL short names to keep ("" registers all) and
+    // only takes effect on the first call. Returns the registered driver count.
+    static int initialize(const std::string& drivers);
+    // Whether the GDAL driver with this short name (e.g. "Parquet") is
+    // registered; optional formats are only offered when it is.
+    static bool hasDriver(const std::string& name);
+    // Route CPL debug messages to the error handler for the calls that follow
+    // on this thread (off by default; the worker sets it per message).
+    static void setDebugLogging(bool enabled);
+    // Report progress of the calls that follow on this thread to
+    // Module.geoconverterProgress(fraction, phase) (fraction < 0: unknown);
+    // returning false from it cancels the conversion ("Conversion cancelled").
+    static void setProgressReporting(bool enabled);
+    // Set a GDAL configuration option for the calls that follow on this thread
+    // ("" unsets it), e.g. GEOCONVERTER_STREAMING_GEOJSON_MIN_SIZE in tests.
+    static void setConfigOption(const std::string& key, const std::string& value);
+    // JSON object of the wall-clock milliseconds per phase of the last
+    // open/convert call on this thread: materialize, open, count, translate,
+    // zip and copyOut (the copy into a std::vector; 0 for buffer outputs).
+    static std::string getLastTimings();
+    // JSON object of the heap and /vsimem high-water marks of the last
+    // open/convert call on this thread (peakHeapBytes, peakVsimemBytes,
+    // sampled at phase boundaries and feature batches), the heap in use now,
+    // the budget and whether the call ran in spill mode.
+    static std::string getLastMemoryUsage();
+
     static std::string getVectorInfo(
         const std::vector<uint8_t>& inputData,
         const std::string& inputFormat,
@@ -33,6 +126,183 @@ public:
         const std::string& csvGeometryMode
     );
     static std::string getLastError();
+
+    // ZIP outputs (Shapefile, MapInfo, FileGDB, multi-layer GPX): "deflate"
+    // (default) or "store", which skips compression for fast local downloads.
+    static void setZipCompression(const std::string& mode);
+
+    // Zero-copy variants: the worker fills a buffer from allocBuffer() with a
+    // single HEAPU8.set and reads the result through a view of the /vsimem
+    // output, which stays alive until releaseOutput().
+    static size_t allocBuffer(size_t size);
+    static void freeBuffer(size_t address);
+    static std::string getVectorInfoFromBuffer(
+        size_t inputAddress,
+        size_t inputSize,
+        const std::string& inputFormat,
+        const std::string& sourceCrs
+    );
+    static int convertVectorToBuffer(
+        size_t inputAddress,
+        size_t inputSize,
+        const std::string& inputFormat,
+        const std::string& outputFormat,
+        const std::string& sourceCrs,
+        const std::string& targetCrs,
+        const std::string& layerName,
+        const std::string& geometryTypeFilter,
+        bool skipFailures,
+        bool makeValid,
+        bool keepZ,
+        const std::string& whereClause,
+        const std::string& selectFields,
+        double simplifyTolerance,
+        bool explodeCollections,
+        bool preserveFid,
+        int geojsonPrecision,
+        const std::string& csvGeometryMode
+    );
+    static int convertBufferWithPlan(
+        size_t inputAddress,
+        size_t inputSize,
+        const std::string& inputFormat,
+        const ConversionPlan& plan
+    );
+    static size_t getOutputAddress(int outputId);
+    static size_t getOutputSize(int outputId);
+    static void releaseOutput(int outputId);
+
+    // Chunked reads of an output into a caller-owned buffer; readOutputStream
+    // returns the number of bytes copied, 0 at the end of the output.
+    static int openOutputStream(int outputId);
+    static size_t readOutputStream(int streamId, size_t address, size_t maxBytes);
+    static void closeOutputStream(int streamId);
+
+    // Sessions keep the materialized input and the opened dataset across a
+    // preview and any number of conversions. openSession adopts a buffer from
+    // allocBuffer(): the caller must not free it afterwards. Returns 0 on failure.
+    static int openSession(size_t inputAddress, size_t inputSize, const std::string& inputFormat);
+    // Blob sessions read the input lazily from a JS Blob registered as
+    // Module.geoconverterBlobs[blobId] (size as double: files may exceed 4 GB).
+    static int openBlobSession(int blobId, double blobSize, const std::string& inputFormat);
+    // exact=false is a fast probe: feature count and bbox come from headers or
+    // indexes where the driver has them, otherwise from a sample of the first
+    // features ("featureCountExact"/"bboxExact" say which).
+    static std::string getSessionInfo(int sessionId, const std::string& sourceCrs, bool exact);
+    // getSessionInfo as a compact binary record instead of JSON (layout in the
+    // binary info section of native.cpp). Returns an output id, 0 on failure.
+    // debugCrs/debugTransform notes are only built with setDebugLogging on.
+    static int getSessionInfoBinary(int sessionId, const std::string& sourceCrs, bool exact);
+    static int convertSession(
+        int sessionId,
+        const std::string& outputFormat,
+        const std::string& sourceCrs,
+        const std::string& targetCrs,
+        const std::string& layerName,
+        const std::string& geometryTypeFilter,
+        bool skipFailures,
+        bool makeValid,
+        bool keepZ,
+        const std::string& whereClause,
+        const std::string& selectFields,
+        double simplifyTolerance,
+        bool explodeCollections,
+        bool preserveFid,
+        int geojsonPrecision,
+        const std::string& csvGeometryMode
+    );
+    static int convertSessionWithPlan(int sessionId, const ConversionPlan& plan);
+    // Per-layer conversion for a pool of workers. The plan is a JSON array of
+    // the source layers convertSessionLayer accepts ("[]" when the output is not
+    // written per layer). convertSessionLayer returns an output id holding a ZIP
+    // of that layer's files, -1 when the layer produced nothing, 0 on failure.
+    static std::string getSessionLayerPlan(
+        int sessionId,
+        const std::string& outputFormat,
+        const std::string& layerName,
+        const std::string& geometryTypeFilter
+    );
+    static int convertSessionLayer(
+        int sessionId,
+        const std::string& sourceLayer,
+        const std::string& outputFormat,
+        const std::string& sourceCrs,
+        const std::string& targetCrs,
+        const std::string& layerName,
+        const std::string& geometryTypeFilter,
+        bool skipFailures,
+        bool makeValid,
+        bool keepZ,
+        const std::string& whereClause,
+        const std::string& selectFields,
+        double simplifyTolerance,
+        bool explodeCollections,
+        bool preserveFid,
+        int geojsonPrecision,
+        const std::string& csvGeometryMode
+    );
+    static int convertSessionLayerWithPlan(
+        int sessionId,
+        const std::string& sourceLayer,
+        const ConversionPlan& plan
+    );
+    static void closeSession(int sessionId);
+
+    // One page of a session layer's features ("" = the first layer) as a
+    // binary table of typed columns plus WKB, see the feature pages section of
+    // native.cpp for the layout. fields is a comma-separated list ("" = all);
+    // sequential pages continue the previous read instead of seeking. Returns
+    // an output id (read it like a conversion output), 0 on failure.
+    static int getFeatures(
+        int sessionId,
+        const std::string& layerName,
+        double offset,
+        int limit,
+        const std::string& fields
+    );
+
+    // Batches convert many inputs with one plan and one setup. merge "" makes
+    // addBatchInput return each input's output id; "zip" collects the outputs
+    // in one ZIP (one member per input, named after it) and "layer" appends
+    // every input's features to one output layer (plan.layerName, default
+    // "merged"; without a targetCrs, in the first input's CRS), both returned
+    // by finishBatch. addBatchInput adopts an allocBuffer() input like
+    // convertBufferWithPlan with adoptInput; it returns 0 when that input
+    // failed (the batch goes on), otherwise the output id ("") or the number
+    // of inputs merged so far. finishBatch returns 0 on failure, -1 for "".
+    static int openBatch(const ConversionPlan& plan, const std::string& merge);
+    static int addBatchInput(
+        int batchId,
+        size_t inputAddress,
+        size_t inputSize,
+        const std::string& inputFormat,
+        const std::string& name
+    );
+    static int finishBatch(int batchId);
+    static void closeBatch(int batchId);
+
+    // Incremental update of an earlier GeoPackage or FlatGeobuf output
+    // (targetFormat "geopackage" or "flatgeobuf") with the features of an
+    // input, converted with plan into the target layer (plan.layerName, ""
+    // = the first one) and its CRS, so plan.targetCrs is ignored. mode
+    // "append" adds every input feature; "upsert" replaces the target feature
+    // whose key field equals the input feature's (key "" matches FIDs, as
+    // preserveFid writes them; GeoPackage only) and adds the rest. A
+    // GeoPackage is changed in place in one transaction, its R-tree kept up
+    // by its triggers; a FlatGeobuf is rewritten, as its packed index must
+    // be. Both buffers come from allocBuffer() and are adopted. Returns an
+    // output id of the updated file, 0 on failure.
+    static int updateOutput(
+        size_t targetAddress,
+        size_t targetSize,
+        const std::string& targetFormat,
+        size_t inputAddress,
+        size_t inputSize,
+        const std::string& inputFormat,
+        const ConversionPlan& plan,
+        const std::string& mode,
+        const std::string& key
+    );
 };
 
 #endif
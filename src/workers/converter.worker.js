@@ -4,27 +4,492 @@
  */
 
 let isInitialized = false;
+let initializing = null;
 let Module = null;
 
-// Initialize WASM module when worker starts
-const initialize = async () => {
-  if (isInitialized) return;
+// Comma-separated GDAL driver short names to keep registered ('' keeps all)
+const DRIVER_ALLOW_LIST = '';
 
-  try {
+// Instantiate the WASM module and set up GDAL once. wasmModule is the
+// WebAssembly.Module the pool compiled on the main thread ('warmup'); without
+// it the Emscripten loader fetches and compiles cpp.wasm itself.
+const initialize = (wasmModule = null) => {
+  if (isInitialized) return Promise.resolve();
+  if (initializing) return initializing;
+
+  initializing = (async () => {
     // Import the compiled WASM module directly
     // The cpp.js file is generated by the cpp.js build process and named 'cpp'
     // via the cppjs.config.js configuration
     const baseUrl = self.location.origin || '';
 
+    // the pthreads build shares its memory with the native thread pool's workers
+    if (typeof SharedArrayBuffer === 'undefined' || !self.crossOriginIsolated) {
+      throw new Error('The converter needs a cross-origin isolated page (COOP/COEP headers)');
+    }
+
     importScripts(baseUrl + '/cpp.js');
 
-    // initCppJs is exported as a global by the cpp.js module
-    // Wait for the module to be ready
-    Module = await self.initCppJs();
+    // initCppJs is exported as a global by the cpp.js module and forwards its
+    // argument to the Emscripten module, whose instantiateWasm hook replaces
+    // the fetch + compile. The pool's pthread workers load cpp.js themselves:
+    // this worker's own script is not it. Wait for the module to be ready
+    Module = await self.initCppJs({
+      mainScriptUrlOrBlob: baseUrl + '/cpp.js',
+      ...(wasmModule ? {
+        instantiateWasm: (imports, receiveInstance) => {
+          WebAssembly.instantiate(wasmModule, imports)
+            .then((instance) => receiveInstance(instance, wasmModule));
+          return {};
+        }
+      } : {})
+    });
+
+    // Register drivers and locate PROJ data once, before the first request.
+    // DRIVER_ALLOW_LIST can name the GDAL drivers to keep to speed up opens.
+    Module.Native.initialize(DRIVER_ALLOW_LIST);
     isInitialized = true;
-  } catch (error) {
+  })().catch((error) => {
     console.error('Failed to initialize WASM in worker:', error);
+    initializing = null;
     throw error;
+  });
+  return initializing;
+};
+
+// HEAPU8 is replaced whenever the WASM memory grows, so always read it fresh
+const heapU8 = () => Module.HEAPU8 || new Uint8Array(Module.wasmMemory.buffer);
+
+// Copy file data into the WASM heap with a single HEAPU8.set
+const copyToHeap = (fileData) => {
+  const bytes = new Uint8Array(fileData);
+  const address = Module.Native.allocBuffer(bytes.length);
+  if (!address) {
+    throw new Error('Failed to allocate input buffer');
+  }
+  heapU8().set(bytes, address);
+  return { address, size: bytes.length };
+};
+
+// Copy a native output out of the heap and release its /vsimem buffer
+const takeOutput = (outputId) => {
+  try {
+    const address = Module.Native.getOutputAddress(outputId);
+    const size = Module.Native.getOutputSize(outputId);
+    return heapU8().slice(address, address + size);
+  } finally {
+    Module.Native.releaseOutput(outputId);
+  }
+};
+
+// Blobs/Files read lazily by the native /vsiblob/ filesystem, keyed by id
+let nextBlobId = 1;
+const registerBlob = (blob) => {
+  Module.geoconverterBlobs = Module.geoconverterBlobs || {};
+  const blobId = nextBlobId++;
+  Module.geoconverterBlobs[blobId] = blob;
+  return blobId;
+};
+const unregisterBlob = (blobId) => {
+  if (Module.geoconverterBlobs) delete Module.geoconverterBlobs[blobId];
+};
+
+// Blob sessions keep their blob registered until closeSession
+const sessionBlobs = new Map();
+
+// Info of an open session as a binary record (decoded by vectorInfo.js on the
+// main thread), which skips building and parsing JSON for wide layers
+const sessionInfoRecord = (openedId, sourceCrs, exact) => {
+  const outputId = Module.Native.getSessionInfoBinary(openedId, sourceCrs || '', exact);
+  if (!outputId) {
+    throw new Error(Module.Native.getLastError() || 'Failed to read dataset info');
+  }
+  return takeOutput(outputId).buffer;
+};
+
+// Flags byte of an info record and the bits read here: the InfoFlag enum of
+// the "binary info" section of native.cpp (vectorInfo.js decodes the rest;
+// this classic worker cannot import it)
+const INFO_FLAGS_OFFSET = 8;
+const INFO_PROBE = 2;
+const INFO_COUNT_EXACT = 4;
+const INFO_BBOX_EXACT = 8;
+
+// A record is final unless it is a probe that estimated the count or the bbox
+const isExactRecord = (record) => {
+  const flags = new Uint8Array(record)[INFO_FLAGS_OFFSET];
+  return (flags & INFO_PROBE) === 0 || ((flags & INFO_COUNT_EXACT) !== 0 && (flags & INFO_BBOX_EXACT) !== 0);
+};
+
+// Post a session's info record: a fast probe first and, if it had to estimate
+// (unless options.exact is false), the exact record as the final message.
+// With keep, returns a copy of the final record (for the result cache).
+const postSessionInfoRecord = (openedId, options, fileName, keep = false) => {
+  let info = sessionInfoRecord(openedId, options.sourceCrs, false);
+  if (options.exact !== false && !isExactRecord(info)) {
+    self.postMessage({ type: 'probe', info, fileName }, [info]);
+    info = sessionInfoRecord(openedId, options.sourceCrs, true);
+  }
+
+  const kept = keep ? info.slice(0) : null;
+  self.postMessage({
+    success: true,
+    info,
+    fileName
+  }, [info]);
+  return kept;
+};
+
+// The ConversionPlan fields that shape the output, with their defaults applied
+// (also the options part of result cache keys)
+const normalizePlanOptions = (outputFormat, options) => ({
+  outputFormat: String(outputFormat).toLowerCase(),
+  sourceCrs: options.sourceCrs || '',
+  targetCrs: options.targetCrs || '',
+  layerName: options.layerName || '',
+  geometryTypeFilter: options.geometryTypeFilter || '',
+  skipFailures: Boolean(options.skipFailures),
+  makeValid: Boolean(options.makeValid),
+  keepZ: Boolean(options.keepZ),
+  whereClause: options.whereClause || '',
+  selectFields: options.selectFields || '',
+  simplifyTolerance: Number(options.simplifyTolerance) || 0,
+  explodeCollections: Boolean(options.explodeCollections),
+  preserveFid: Boolean(options.preserveFid),
+  geojsonPrecision: options.geojsonPrecision ?? 7,
+  csvGeometryMode: options.csvGeometryMode || '',
+  // [minx, miny, maxx, maxy] (or that as a string) in the source CRS, or in the
+  // target CRS with spatialFilterTargetCrs
+  spatialFilter: Array.isArray(options.spatialFilter)
+    ? options.spatialFilter.join(',')
+    : (options.spatialFilter || ''),
+  spatialFilterTargetCrs: Boolean(options.spatialFilterTargetCrs),
+  // PMTiles/MBTiles: zoom range (-1: driver default) and simplification in
+  // tile pixels (tileSimplificationMaxZoom, if set, at the maximum zoom)
+  tileMinZoom: options.tileMinZoom ?? -1,
+  tileMaxZoom: options.tileMaxZoom ?? -1,
+  tileSimplification: Number(options.tileSimplification) || 0,
+  tileSimplificationMaxZoom: options.tileSimplificationMaxZoom ?? -1,
+  spatialSort: Boolean(options.spatialSort),
+  // GeoParquet/Arrow IPC: codec ('' = driver default, e.g. 'zstd', 'snappy',
+  // 'none') and rows per row group or record batch (0 = driver default)
+  columnarCompression: options.columnarCompression || '',
+  rowGroupSize: Number(options.rowGroupSize) || 0,
+  zipDeflate: (options.zipCompression || 'deflate') !== 'store',
+  // engine: 'native' (default), 'driver' (no fast GeoJSON writer or native tiler) or 'translate'
+  // (every format through GDALVectorTranslate), e.g. to compare outputs
+  useTranslate: options.engine === 'translate',
+  fastWriters: options.engine !== 'driver'
+});
+
+// Typed native conversion options; the caller must delete() the plan
+const createPlan = (outputFormat, options) => {
+  const plan = new Module.ConversionPlan();
+  Object.entries(normalizePlanOptions(outputFormat, options)).forEach(([name, value]) => {
+    plan[name] = value;
+  });
+  // heap bytes the conversion may use; above it, it fails instead of running out
+  plan.memoryBudget = Number(options.memoryBudget) || 0;
+  return plan;
+};
+
+// ---- result cache
+// Outputs and info JSON of earlier requests live in IndexedDB, keyed by a
+// SHA-256 of the input bytes (WebCrypto, so no WASM is involved) plus the
+// normalized options, and are evicted least recently used first beyond
+// CACHE_MAX_BYTES. A hit is answered without loading the WASM module.
+// options.cache === false bypasses it. Storage is best effort: any IndexedDB
+// failure just means a miss.
+
+// Bump when a converter change alters the output for the same input and options
+const CACHE_VERSION = 2;
+const CACHE_DB = 'geoconverter-cache';
+const CACHE_STORE = 'results';
+const CACHE_MAX_BYTES = 512 * 1024 * 1024;
+const CACHE_MAX_ENTRY_BYTES = 128 * 1024 * 1024;
+
+let cacheDb = null;
+const openCacheDb = () => {
+  if (!cacheDb) {
+    cacheDb = new Promise((resolve) => {
+      if (typeof indexedDB === 'undefined') {
+        resolve(null);
+        return;
+      }
+      const request = indexedDB.open(CACHE_DB, 1);
+      request.onupgradeneeded = () => {
+        request.result.createObjectStore(CACHE_STORE, { keyPath: 'key' })
+          .createIndex('lastUsed', 'lastUsed');
+      };
+      request.onsuccess = () => resolve(request.result);
+      request.onerror = () => resolve(null); // e.g. storage disabled
+    });
+  }
+  return cacheDb;
+};
+
+const idbResult = (request) => new Promise((resolve, reject) => {
+  request.onsuccess = () => resolve(request.result);
+  request.onerror = () => reject(request.error);
+});
+
+const idbDone = (tx) => new Promise((resolve, reject) => {
+  tx.oncomplete = resolve;
+  tx.onerror = () => reject(tx.error);
+  tx.onabort = () => reject(tx.error);
+});
+
+const cacheEnabled = (options) =>
+  Boolean(options) && options.cache !== false && typeof crypto !== 'undefined' && Boolean(crypto.subtle);
+
+const toHex = (buffer) => Array.from(new Uint8Array(buffer), (b) => b.toString(16).padStart(2, '0')).join('');
+
+const contentKey = async (data) => toHex(await crypto.subtle.digest('SHA-256', data));
+
+// Blob info requests never read the whole file, so a File is keyed by its
+// name, size and modification time instead (null: not cacheable)
+const fileKey = (blob) => (typeof blob.lastModified === 'number' && blob.name
+  ? `file:${blob.name}:${blob.size}:${blob.lastModified}`
+  : null);
+
+const cacheKey = (kind, inputKey, parts) => `${CACHE_VERSION}:${kind}:${inputKey}:${JSON.stringify(parts)}`;
+
+// Look an entry up and mark it used; null on a miss
+const cacheGet = async (key) => {
+  const db = await openCacheDb();
+  if (!db) return null;
+  try {
+    const tx = db.transaction(CACHE_STORE, 'readwrite');
+    const store = tx.objectStore(CACHE_STORE);
+    const entry = await idbResult(store.get(key));
+    if (entry) store.put({ ...entry, lastUsed: Date.now() });
+    await idbDone(tx);
+    return entry || null;
+  } catch {
+    return null;
+  }
+};
+
+// Store value (a Blob or a string) and evict the least recently used entries
+// beyond CACHE_MAX_BYTES
+const cachePut = async (key, value, size) => {
+  if (size > CACHE_MAX_ENTRY_BYTES) return;
+  const db = await openCacheDb();
+  if (!db) return;
+  try {
+    const tx = db.transaction(CACHE_STORE, 'readwrite');
+    const store = tx.objectStore(CACHE_STORE);
+    store.put({ key, value, size, lastUsed: Date.now() });
+
+    let total = 0;
+    const cursorRequest = store.index('lastUsed').openCursor(null, 'prev'); // newest first
+    cursorRequest.onsuccess = () => {
+      const cursor = cursorRequest.result;
+      if (!cursor) return;
+      total += cursor.value.size;
+      if (total > CACHE_MAX_BYTES) cursor.delete();
+      cursor.continue();
+    };
+    await idbDone(tx);
+  } catch {
+    // quota exceeded or storage unavailable: leave the cache as it is
+  }
+};
+
+const cacheClear = async () => {
+  const db = await openCacheDb();
+  if (!db) return;
+  const tx = db.transaction(CACHE_STORE, 'readwrite');
+  tx.objectStore(CACHE_STORE).clear();
+  await idbDone(tx);
+};
+
+// A cacheable info result parses and carries no error
+const isCacheableInfo = (info) => {
+  try {
+    return JSON.parse(info).error === undefined;
+  } catch {
+    return false;
+  }
+};
+
+// Answer a conversion from a cached output Blob, shaped like postOutput
+const postCachedOutput = async (blob, fileName, stream) => {
+  if (stream) {
+    for (let offset = 0; offset < blob.size; offset += OUTPUT_CHUNK_SIZE) {
+      const data = await blob.slice(offset, offset + OUTPUT_CHUNK_SIZE).arrayBuffer();
+      self.postMessage({ type: 'chunk', data, fileName }, [data]);
+    }
+    self.postMessage({ success: true, streamed: true, size: blob.size, fileName, cached: true });
+    return;
+  }
+
+  const data = await blob.arrayBuffer();
+  self.postMessage({ success: true, data, fileName, cached: true }, [data]);
+};
+
+// Route native progress reports of the current request. options.progress posts
+// them as 'progress' messages; the request is cancelled once cancelBuffer (an
+// Int32Array-sized SharedArrayBuffer, needs cross-origin isolation) holds a
+// non-zero value or options.timeoutMs has passed.
+const installProgress = (options, cancelBuffer, fileName) => {
+  const cancelFlag = cancelBuffer ? new Int32Array(cancelBuffer) : null;
+  const deadline = options && options.timeoutMs > 0 ? performance.now() + options.timeoutMs : Infinity;
+  const postsProgress = Boolean(options && options.progress);
+
+  Module.geoconverterProgress = (fraction, phase) => {
+    if (postsProgress) {
+      self.postMessage({ type: 'progress', fraction, phase, fileName });
+    }
+    return !(cancelFlag && Atomics.load(cancelFlag, 0)) && performance.now() < deadline;
+  };
+  Module.Native.setProgressReporting(postsProgress || cancelFlag !== null || deadline !== Infinity);
+};
+
+// Per-phase timings (ms) of the last native call, plus the copy out of the heap
+const lastTimings = (copyOut) => {
+  const timings = JSON.parse(Module.Native.getLastTimings());
+  timings.copyOut += copyOut;
+  return timings;
+};
+
+// Heap and /vsimem high-water marks of the last native call
+const lastMemoryUsage = () => JSON.parse(Module.Native.getLastMemoryUsage());
+
+// Outputs are forwarded in chunks of this size so peak memory stays bounded
+const OUTPUT_CHUNK_SIZE = 8 * 1024 * 1024;
+
+// Post a native output to the main thread as 'chunk' messages, then release it.
+// With keptParts, a copy of every chunk is kept there (as Blobs) first.
+const postOutputChunks = (outputId, fileName, keptParts) => {
+  const totalSize = Module.Native.getOutputSize(outputId);
+  const chunkSize = Math.max(1, Math.min(OUTPUT_CHUNK_SIZE, totalSize));
+  const chunkAddress = Module.Native.allocBuffer(chunkSize);
+  const streamId = Module.Native.openOutputStream(outputId);
+
+  try {
+    if (!chunkAddress || !streamId) {
+      throw new Error('Failed to open output stream');
+    }
+
+    let bytesRead;
+    while ((bytesRead = Module.Native.readOutputStream(streamId, chunkAddress, chunkSize)) > 0) {
+      const chunk = heapU8().slice(chunkAddress, chunkAddress + bytesRead);
+      if (keptParts) keptParts.push(new Blob([chunk]));
+      self.postMessage({ type: 'chunk', data: chunk.buffer, fileName }, [chunk.buffer]);
+    }
+  } finally {
+    if (streamId) Module.Native.closeOutputStream(streamId);
+    if (chunkAddress) Module.Native.freeBuffer(chunkAddress);
+    Module.Native.releaseOutput(outputId);
+  }
+
+  return totalSize;
+};
+
+// Send a conversion result either as chunks (stream mode) or as one transferred buffer.
+// WASM memory never shrinks, so heapBytes is the high-water mark of this instance.
+// With keep, resolves with a Blob copy of the output (for the result cache).
+const postOutput = (outputId, fileName, stream, keep = false) => {
+  const copyStart = performance.now();
+  if (stream) {
+    const parts = keep ? [] : null;
+    const size = postOutputChunks(outputId, fileName, parts);
+    const timings = lastTimings(performance.now() - copyStart);
+    self.postMessage({
+      success: true, streamed: true, size, fileName, timings,
+      memory: lastMemoryUsage(), heapBytes: heapU8().length
+    });
+    return parts ? new Blob(parts) : null;
+  }
+
+  const outputArray = takeOutput(outputId);
+  const timings = lastTimings(performance.now() - copyStart);
+  const kept = keep ? new Blob([outputArray]) : null;
+
+  // Send result back to main thread (transfer ownership for efficiency)
+  self.postMessage({
+    success: true,
+    data: outputArray.buffer,
+    fileName,
+    timings,
+    memory: lastMemoryUsage(),
+    heapBytes: heapU8().length
+  }, [outputArray.buffer]);
+  return kept;
+};
+
+// Bytes of a batch entry. Blobs/Files are read asynchronously, by the browser
+// off this thread, so the next input loads while the current one converts.
+const readBatchInput = (entry) =>
+  (entry.fileBlob ? entry.fileBlob.arrayBuffer() : Promise.resolve(entry.fileData));
+
+// Convert every entry of files ({ fileBlob or fileData, fileName, inputFormat })
+// with one plan. Each input is answered by a 'batchItem' message (with its
+// output when merge is ''); merged batches ('zip', 'layer') end with the output
+// like a 'convert' request, others with { success, converted, failed }.
+const convertBatch = async ({ files, inputFormat, outputFormat, options, merge, fileName, stream, cancelBuffer }) => {
+  const plan = createPlan(outputFormat, options);
+  let batchId = 0;
+  try {
+    batchId = Module.Native.openBatch(plan, merge || '');
+  } finally {
+    plan.delete();
+  }
+  if (!batchId) {
+    throw new Error(Module.Native.getLastError() || 'Failed to open batch');
+  }
+
+  let pending = files.length > 0 ? readBatchInput(files[0]) : null;
+  let converted = 0;
+  try {
+    for (let index = 0; index < files.length; index++) {
+      const entry = files[index];
+      const current = pending;
+      pending = index + 1 < files.length ? readBatchInput(files[index + 1]) : null;
+
+      let result = 0;
+      let error = '';
+      try {
+        const input = copyToHeap(await current);
+        installProgress(options, cancelBuffer, entry.fileName);
+        // the batch adopts the input buffer, on success or failure
+        result = Module.Native.addBatchInput(batchId, input.address, input.size,
+                                             entry.inputFormat || inputFormat, entry.fileName || '');
+        if (!result) error = Module.Native.getLastError() || 'Conversion failed';
+      } catch (readError) {
+        error = readError.message;
+      }
+      if (error === 'Conversion cancelled') {
+        throw new Error(error);
+      }
+
+      if (!result) {
+        self.postMessage({ type: 'batchItem', index, fileName: entry.fileName, success: false, error });
+      } else if (!merge) {
+        const output = takeOutput(result);
+        self.postMessage({
+          type: 'batchItem', index, fileName: entry.fileName, success: true,
+          data: output.buffer, timings: lastTimings(0)
+        }, [output.buffer]);
+      } else {
+        self.postMessage({ type: 'batchItem', index, fileName: entry.fileName, success: true, timings: lastTimings(0) });
+      }
+      if (result) converted++;
+    }
+
+    if (!merge) {
+      self.postMessage({ success: true, converted, failed: files.length - converted, fileName });
+      return;
+    }
+    const outputId = Module.Native.finishBatch(batchId);
+    if (!outputId) {
+      throw new Error(Module.Native.getLastError() || 'Batch conversion failed');
+    }
+    postOutput(outputId, fileName, stream);
+  } finally {
+    if (pending) pending.catch(() => {}); // read ahead for an aborted batch
+    Module.Native.closeBatch(batchId);
   }
 };
 
@@ -32,52 +497,102 @@ self.onmessage = async function(e) {
   const {
     type,
     fileData,
+    fileBlob,
     inputFormat,
     outputFormat,
     options,
-    fileName
+    fileName,
+    sessionId,
+    layer,
+    stream,
+    cancelBuffer,
+    offset,
+    limit,
+    fields,
+    files,
+    merge,
+    update,
+    wasmModule
   } = e.data;
+  // GDAL config options of this request, unset again once it is done
+  const gdalConfig = Object.entries((options && options.gdalConfig) || {});
+  // they change outputs and info alike, so they are part of every cache key
+  const configKey = gdalConfig.map(([key, value]) => [key, String(value)])
+    .sort((a, b) => (a[0] < b[0] ? -1 : a[0] > b[0] ? 1 : 0));
 
   try {
+    // Sent by the pool before any request: set up GDAL while the worker is idle
+    if (type === 'warmup') {
+      await initialize(wasmModule);
+      self.postMessage({ success: true, warm: true, heapBytes: heapU8().length });
+      return;
+    }
+
+    // Cached answers first: a hit needs no WASM at all
+    let resultKey = null;
+    if (type === 'clearCache') {
+      await cacheClear();
+      self.postMessage({ success: true, fileName });
+      return;
+    }
+    if (cacheEnabled(options)) {
+      if (type === 'convert') {
+        resultKey = cacheKey('convert', await contentKey(fileData),
+                             [String(inputFormat).toLowerCase(), normalizePlanOptions(outputFormat, options), configKey]);
+      } else if (type === 'getVectorInfo') {
+        resultKey = cacheKey('info', await contentKey(fileData),
+                             [String(inputFormat).toLowerCase(), options.sourceCrs || '', configKey]);
+      } else if ((type === 'getVectorInfoFromBlob' || type === 'getSessionInfoBinary') && fileKey(fileBlob)) {
+        // a session's info is keyed like its blob's, when the caller passes it
+        resultKey = cacheKey('info', fileKey(fileBlob),
+                             [String(inputFormat).toLowerCase(), options.sourceCrs || '', options.exact !== false, configKey]);
+      }
+
+      const hit = resultKey && await cacheGet(resultKey);
+      if (hit) {
+        if (type === 'convert') {
+          await postCachedOutput(hit.value, fileName, stream);
+        } else {
+          self.postMessage({ success: true, info: hit.value, fileName, cached: true });
+        }
+        return;
+      }
+    }
+
     // Ensure WASM is initialized
     if (!isInitialized) {
       await initialize();
     }
 
-    if (type === 'convert') {
-      // Create C++ vector from file data
-      const inputArray = new Uint8Array(fileData);
-      const inputVector = new Module.VectorUint8();
+    // ZIP outputs: 'deflate' (default) or 'store' for fast, uncompressed archives
+    if (options) {
+      Module.Native.setZipCompression(options.zipCompression || 'deflate');
+    }
 
-      for (let i = 0; i < inputArray.length; i++) {
-        inputVector.push_back(inputArray[i]);
-      }
+    // GDAL debug messages only for requests that ask for them
+    Module.Native.setDebugLogging(Boolean(options && options.debug));
+    installProgress(options, cancelBuffer, fileName);
+    gdalConfig.forEach(([key, value]) => Module.Native.setConfigOption(key, String(value)));
 
-      // Perform conversion with all options
-      const outputVector = Module.Native.convertVector(
-        inputVector,
-        inputFormat,
-        outputFormat,
-        options.sourceCrs,
-        options.targetCrs,
-        options.layerName,
-        options.geometryTypeFilter,
-        options.skipFailures,
-        options.makeValid,
-        options.keepZ,
-        options.whereClause,
-        options.selectFields,
-        options.simplifyTolerance,
-        options.explodeCollections,
-        options.preserveFid,
-        options.geojsonPrecision,
-        options.csvGeometryMode
-      );
+    if (type === 'convert') {
+      const input = copyToHeap(fileData);
+      const plan = createPlan(outputFormat, options);
+      // the native side frees the input, early when it runs short of its memory budget
+      plan.adoptInput = true;
+      let outputId = 0;
 
-      if (!outputVector || outputVector.size() === 0) {
-        inputVector.delete();
-        if (outputVector) outputVector.delete();
+      try {
+        outputId = Module.Native.convertBufferWithPlan(
+          input.address,
+          input.size,
+          inputFormat,
+          plan
+        );
+      } finally {
+        plan.delete();
+      }
 
+      if (!outputId) {
         const lastError = typeof Module.Native.getLastError === 'function'
           ? Module.Native.getLastError()
           : '';
@@ -85,44 +600,203 @@ self.onmessage = async function(e) {
         throw new Error(lastError || 'Conversion failed - output is empty');
       }
 
-      // Convert C++ vector back to Uint8Array
-      const outputSize = outputVector.size();
-      const outputArray = new Uint8Array(outputSize);
-      for (let i = 0; i < outputSize; i++) {
-        outputArray[i] = outputVector.get(i);
+      const output = postOutput(outputId, fileName, stream, Boolean(resultKey));
+      if (resultKey) await cachePut(resultKey, output, output.size);
+
+    } else if (type === 'getVectorInfo') {
+      // For preview functionality
+      const input = copyToHeap(fileData);
+      let info;
+
+      try {
+        info = Module.Native.getVectorInfoFromBuffer(
+          input.address,
+          input.size,
+          inputFormat,
+          options.sourceCrs
+        );
+      } finally {
+        Module.Native.freeBuffer(input.address);
       }
 
-      // Clean up C++ objects
-      inputVector.delete();
-      outputVector.delete();
+      self.postMessage({
+        success: true,
+        info,
+        fileName
+      });
+      if (resultKey && isCacheableInfo(info)) await cachePut(resultKey, info, info.length * 2);
+
+    } else if (type === 'getVectorInfoFromBlob') {
+      // Read only the byte ranges GDAL needs instead of copying the whole file
+      const blobId = registerBlob(fileBlob);
+      let openedId = 0;
+      try {
+        openedId = Module.Native.openBlobSession(blobId, fileBlob.size, inputFormat);
+        if (!openedId) {
+          throw new Error(Module.Native.getLastError() || 'Failed to open input dataset');
+        }
+        const cached = postSessionInfoRecord(openedId, options, fileName, Boolean(resultKey));
+        if (cached) await cachePut(resultKey, cached, cached.byteLength);
+      } finally {
+        if (openedId) Module.Native.closeSession(openedId);
+        unregisterBlob(blobId);
+      }
+
+    } else if (type === 'openSession') {
+      // Keep the parsed dataset open for a preview plus any number of conversions.
+      // The native session adopts the heap buffer, so it is not freed here.
+      const input = copyToHeap(fileData);
+      const openedId = Module.Native.openSession(input.address, input.size, inputFormat);
+      if (!openedId) {
+        throw new Error(Module.Native.getLastError() || 'Failed to open input dataset');
+      }
 
-      // Send result back to main thread (transfer ownership for efficiency)
       self.postMessage({
         success: true,
-        data: outputArray.buffer,
+        sessionId: openedId,
         fileName
-      }, [outputArray.buffer]);
+      });
 
-    } else if (type === 'getVectorInfo') {
-      // For preview functionality
-      const inputArray = new Uint8Array(fileData);
-      const inputVector = new Module.VectorUint8();
+    } else if (type === 'openBlobSession') {
+      // Same as openSession, but the input stays in the Blob and is read on demand
+      const blobId = registerBlob(fileBlob);
+      const openedId = Module.Native.openBlobSession(blobId, fileBlob.size, inputFormat);
+      if (!openedId) {
+        unregisterBlob(blobId);
+        throw new Error(Module.Native.getLastError() || 'Failed to open input dataset');
+      }
+      sessionBlobs.set(openedId, blobId);
+
+      self.postMessage({
+        success: true,
+        sessionId: openedId,
+        fileName
+      });
+
+    } else if (type === 'getSessionInfo') {
+      const info = Module.Native.getSessionInfo(sessionId, options.sourceCrs, options.exact !== false);
 
-      for (let i = 0; i < inputArray.length; i++) {
-        inputVector.push_back(inputArray[i]);
+      self.postMessage({
+        success: true,
+        info,
+        fileName
+      });
+
+    } else if (type === 'getSessionInfoBinary') {
+      // The preview's info, read from the session it keeps for the feature table
+      const cached = postSessionInfoRecord(sessionId, options, fileName, Boolean(resultKey));
+      if (cached) await cachePut(resultKey, cached, cached.byteLength);
+
+    } else if (type === 'convertSession') {
+      const plan = createPlan(outputFormat, options);
+      let outputId = 0;
+      try {
+        outputId = Module.Native.convertSessionWithPlan(sessionId, plan);
+      } finally {
+        plan.delete();
       }
 
-      const info = Module.Native.getVectorInfo(
-        inputVector,
-        inputFormat,
-        options.sourceCrs
+      if (!outputId) {
+        throw new Error(Module.Native.getLastError() || 'Conversion failed - output is empty');
+      }
+
+      postOutput(outputId, fileName, stream);
+
+    } else if (type === 'getSessionLayerPlan') {
+      // Layers that convertSessionLayer can handle independently ([] = convert as a whole)
+      const plan = Module.Native.getSessionLayerPlan(
+        sessionId,
+        outputFormat,
+        options.layerName,
+        options.geometryTypeFilter
       );
 
-      inputVector.delete();
+      self.postMessage({
+        success: true,
+        layers: JSON.parse(plan),
+        fileName
+      });
+
+    } else if (type === 'convertSessionLayer') {
+      const plan = createPlan(outputFormat, options);
+      let outputId = 0;
+      try {
+        outputId = Module.Native.convertSessionLayerWithPlan(sessionId, layer, plan);
+      } finally {
+        plan.delete();
+      }
+
+      if (outputId < 0) {
+        // Layer had nothing to write (e.g. an empty GPX layer)
+        self.postMessage({ success: true, empty: true, fileName, timings: lastTimings(0) });
+      } else if (!outputId) {
+        throw new Error(Module.Native.getLastError() || 'Layer conversion failed');
+      } else {
+        postOutput(outputId, fileName, stream);
+      }
+
+    } else if (type === 'getFeatures') {
+      // One page of rows for the preview table (decoded by featurePage.js)
+      const outputId = Module.Native.getFeatures(sessionId, layer || '', offset || 0, limit || 100, fields || '');
+      if (!outputId) {
+        throw new Error(Module.Native.getLastError() || 'Failed to read features');
+      }
+      const page = takeOutput(outputId);
+
+      self.postMessage({
+        success: true,
+        page: page.buffer,
+        fileName
+      }, [page.buffer]);
+
+    } else if (type === 'convertBatch') {
+      await convertBatch({ files, inputFormat, outputFormat, options, merge, fileName, stream, cancelBuffer });
+
+    } else if (type === 'updateOutput') {
+      // update = { targetData, targetFormat, mode: 'append' | 'upsert', key }:
+      // an earlier GeoPackage or FlatGeobuf output gets the features of fileData,
+      // and the updated file is sent back like a conversion output
+      const plan = createPlan(update.targetFormat, options);
+      let outputId = 0;
+      try {
+        const target = copyToHeap(update.targetData);
+        let input;
+        try {
+          input = copyToHeap(fileData);
+        } catch (error) {
+          Module.Native.freeBuffer(target.address);
+          throw error;
+        }
+        // the native side adopts (and frees) both buffers
+        outputId = Module.Native.updateOutput(
+          target.address,
+          target.size,
+          update.targetFormat,
+          input.address,
+          input.size,
+          inputFormat,
+          plan,
+          update.mode || 'append',
+          update.key || ''
+        );
+      } finally {
+        plan.delete();
+      }
+
+      if (!outputId) {
+        throw new Error(Module.Native.getLastError() || 'Update failed - output is empty');
+      }
+      postOutput(outputId, fileName, stream);
+
+    } else if (type === 'closeSession') {
+      Module.Native.closeSession(sessionId);
+      if (sessionBlobs.has(sessionId)) {
+        unregisterBlob(sessionBlobs.get(sessionId));
+        sessionBlobs.delete(sessionId);
+      }
 
       self.postMessage({
         success: true,
-        info,
         fileName
       });
     }
@@ -135,7 +809,10 @@ self.onmessage = async function(e) {
     self.postMessage({
       success: false,
       error: nativeError || error.message,
-      fileName
+      fileName,
+      heapBytes: isInitialized ? heapU8().length : 0
     });
+  } finally {
+    if (isInitialized) gdalConfig.forEach(([key]) => Module.Native.setConfigOption(key, ''));
   }
 };
@@ -0,0 +1,124 @@
+/**
+ * Decoder for the binary feature pages of Native::getFeatures (the layout is
+ * described in the "feature pages" section of native.cpp).
+ *
+ * A decoded page holds its rows as plain arrays per column plus the WKB of
+ * every geometry as a view into the page buffer, so a preview only keeps the
+ * pages it shows.
+ */
+
+const COLUMN_TYPES = { 1: 'int32', 2: 'int64', 3: 'float64', 4: 'string' };
+
+const GEOMETRY_NAMES = {
+  1: 'Point',
+  2: 'LineString',
+  3: 'Polygon',
+  4: 'MultiPoint',
+  5: 'MultiLineString',
+  6: 'MultiPolygon',
+  7: 'GeometryCollection',
+  8: 'CircularString',
+  9: 'CompoundCurve',
+  10: 'CurvePolygon',
+  11: 'MultiCurve',
+  12: 'MultiSurface',
+  15: 'PolyhedralSurface',
+  16: 'TIN',
+  17: 'Triangle'
+};
+
+const textDecoder = new TextDecoder();
+
+// Variable-length values: end offsets, then the bytes (returns views and the next position)
+const readBlobs = (view, bytes, pos, rowCount) => {
+  const data = pos + rowCount * 4;
+  const blobs = new Array(rowCount);
+  let start = 0;
+  for (let i = 0; i < rowCount; i++) {
+    const end = view.getUint32(pos + i * 4, true);
+    blobs[i] = bytes.subarray(data + start, data + end);
+    start = end;
+  }
+  return [blobs, data + start];
+};
+
+/**
+ * Geometry type of an ISO WKB value ("Polygon Z", ...), null for no geometry.
+ */
+export const wkbGeometryType = (wkb) => {
+  if (!wkb || wkb.length < 5) return null;
+  const view = new DataView(wkb.buffer, wkb.byteOffset, wkb.byteLength);
+  const code = view.getUint32(1, wkb[0] === 1);
+  const name = GEOMETRY_NAMES[code % 1000] || 'Geometry';
+  const dims = ['', ' Z', ' M', ' ZM'][Math.floor(code / 1000)] || '';
+  return name + dims;
+};
+
+/**
+ * Decode one page: { rowCount, nextOffset (-1 at the end of the layer), fids,
+ * geometries (WKB views), columns: [{ name, type, values }] } with null for
+ * null values.
+ */
+export const decodeFeaturePage = (buffer) => {
+  const view = new DataView(buffer);
+  const bytes = new Uint8Array(buffer);
+  if (textDecoder.decode(bytes.subarray(0, 4)) !== 'GCF1') {
+    throw new Error('Not a feature page');
+  }
+
+  const rowCount = view.getUint32(4, true);
+  const columnCount = view.getUint32(8, true);
+  const nextOffset = view.getFloat64(12, true);
+  let pos = 20;
+
+  const columns = [];
+  for (let c = 0; c < columnCount; c++) {
+    const type = COLUMN_TYPES[view.getUint8(pos)] || 'string';
+    const nameLength = view.getUint32(pos + 1, true);
+    const name = textDecoder.decode(bytes.subarray(pos + 5, pos + 5 + nameLength));
+    columns.push({ name, type, values: new Array(rowCount) });
+    pos += 5 + nameLength;
+  }
+
+  const fids = new Array(rowCount);
+  for (let i = 0; i < rowCount; i++) {
+    fids[i] = Number(view.getBigInt64(pos + i * 8, true));
+  }
+  pos += rowCount * 8;
+
+  let geometries;
+  [geometries, pos] = readBlobs(view, bytes, pos, rowCount);
+  geometries = geometries.map((wkb) => (wkb.length > 0 ? wkb : null));
+
+  for (const column of columns) {
+    const nulls = bytes.subarray(pos, pos + Math.ceil(rowCount / 8));
+    const isNull = (i) => (nulls[i >> 3] & (1 << (i & 7))) !== 0;
+    pos += nulls.length;
+
+    if (column.type === 'string') {
+      let blobs;
+      [blobs, pos] = readBlobs(view, bytes, pos, rowCount);
+      for (let i = 0; i < rowCount; i++) {
+        column.values[i] = isNull(i) ? null : textDecoder.decode(blobs[i]);
+      }
+      continue;
+    }
+
+    const size = column.type === 'int32' ? 4 : 8;
+    for (let i = 0; i < rowCount; i++) {
+      const at = pos + i * size;
+      if (isNull(i)) {
+        column.values[i] = null;
+      } else if (column.type === 'int32') {
+        column.values[i] = view.getInt32(at, true);
+      } else if (column.type === 'int64') {
+        column.values[i] = Number(view.getBigInt64(at, true));
+      } else {
+        column.values[i] = view.getFloat64(at, true);
+      }
+    }
+    pos += rowCount * size;
+  }
+
+  return { rowCount, nextOffset, fids, geometries, columns };
+};
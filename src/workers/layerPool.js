@@ -0,0 +1,178 @@
+/**
+ * Layer-parallel conversion coordinator (runs on the main thread).
+ *
+ * Multi-layer inputs whose output is written one set of files per layer
+ * (Shapefile output, GPX input) are split across the converter worker pool.
+ * Every worker opens its own Blob session on the same input, converts the
+ * layers it is handed, and the per-layer ZIPs are merged into the final ZIP.
+ * Inputs with fewer than two such layers are converted whole on the session
+ * the plan was made on, so the input is opened only once.
+ */
+import { mergeZipArchives } from "./zipMerge";
+
+// Send one request to a pinned pool worker and resolve with its final message
+// ('chunk' messages of a streamed output are collected into data, 'progress'
+// messages go to onProgress; estimatedBytes orders it in the pool's queue)
+const request = (pin, message, onProgress, estimatedBytes = 0) => {
+  const chunks = [];
+  return pin.run(message, {
+    estimatedBytes,
+    onMessage: (data) => {
+      if (data.type === 'chunk') {
+        chunks.push(data.data);
+      } else if (data.type === 'progress' && onProgress) {
+        onProgress(data);
+      }
+    }
+  }).then((data) => {
+    if (!data.success) throw new Error(data.error);
+    return data.streamed ? { ...data, data: new Blob(chunks) } : data;
+  });
+};
+
+const openSession = async (pin, fileBlob, fileName, inputFormat) => {
+  const { sessionId } = await request(pin, {
+    type: 'openBlobSession',
+    fileBlob,
+    fileName,
+    inputFormat
+  });
+  return sessionId;
+};
+
+/**
+ * Convert the layers of one input in parallel.
+ *
+ * `pool` is the app's worker pool (workerPool.js); every session lives on a
+ * worker pinned for the job, the planning one included. An already open
+ * `session` ({ pin, sessionId }, e.g. the preview's) is used for planning
+ * instead of opening one, and is left open. Resolves with the
+ * output Blob: the merged ZIP, or the whole-file conversion of the planning
+ * session when the output is not split per layer or there is only one layer.
+ * onProgress receives the overall fraction (0..1) as layers are converted.
+ */
+export const convertLayersInParallel = async ({
+  pool,
+  session = null,
+  fileBlob,
+  fileName,
+  inputFormat,
+  outputFormat,
+  options,
+  onProgress,
+  poolSize = pool.size
+}) => {
+  const planPin = session ? session.pin : pool.pin();
+  let planSessionId = session ? session.sessionId : 0;
+  if (!session) {
+    try {
+      planSessionId = await openSession(planPin, fileBlob, fileName, inputFormat);
+    } catch (error) {
+      planPin.release();
+      throw error;
+    }
+  }
+  const closePlanSession = () => (session
+    ? Promise.resolve()
+    : request(planPin, { type: 'closeSession', sessionId: planSessionId, fileName })
+      .catch(() => {})
+      .finally(() => planPin.release()));
+
+  let layers;
+  try {
+    ({ layers } = await request(planPin, {
+      type: 'getSessionLayerPlan',
+      sessionId: planSessionId,
+      fileName,
+      outputFormat,
+      options
+    }));
+  } catch (error) {
+    await closePlanSession();
+    throw error;
+  }
+
+  const workerCount = Math.min(poolSize, layers.length);
+  if (workerCount < 2) {
+    try {
+      const result = await request(planPin, {
+        type: 'convertSession',
+        sessionId: planSessionId,
+        fileName,
+        outputFormat,
+        options,
+        stream: true
+      }, (p) => { if (onProgress && p.fraction >= 0) onProgress(p.fraction); }, fileBlob.size);
+      return new Blob([result.data], { type: 'application/octet-stream' });
+    } finally {
+      await closePlanSession();
+    }
+  }
+
+  // The planning worker keeps its session; the extra workers open their own
+  // (pins go to the least pinned workers, so each gets its own when it can)
+  const extraPins = Array.from({ length: workerCount - 1 }, () => pool.pin());
+  const shares = [{ pin: planPin, sessionId: planSessionId }];
+
+  try {
+    const extraSessions = await Promise.allSettled(
+      extraPins.map((pin) => openSession(pin, fileBlob, fileName, inputFormat))
+    );
+    extraSessions.forEach((result, i) => {
+      if (result.status === 'fulfilled') shares.push({ pin: extraPins[i], sessionId: result.value });
+    });
+    const failed = extraSessions.find((result) => result.status === 'rejected');
+    if (failed) throw failed.reason;
+
+    // Workers pull layers from a shared queue, so large layers do not stall the rest
+    const queue = [...layers];
+    const layerBytes = fileBlob.size / layers.length;
+    const layerZips = [];
+
+    // overall progress is the mean of the per-layer fractions
+    const layerProgress = new Map();
+    const reportLayer = (layer, fraction) => {
+      if (!onProgress) return;
+      layerProgress.set(layer, fraction);
+      let sum = 0;
+      for (const f of layerProgress.values()) sum += f;
+      onProgress(sum / layers.length);
+    };
+
+    const drain = async ({ pin, sessionId }) => {
+      while (queue.length > 0) {
+        const layer = queue.shift();
+        const result = await request(pin, {
+          type: 'convertSessionLayer',
+          sessionId,
+          layer,
+          fileName,
+          outputFormat,
+          options,
+          stream: true
+        }, (p) => { if (p.fraction >= 0) reportLayer(layer, p.fraction); }, layerBytes);
+        reportLayer(layer, 1);
+        if (!result.empty) {
+          layerZips.push(result.data);
+        }
+      }
+    };
+
+    await Promise.all(shares.map(drain));
+
+    if (layerZips.length === 0) {
+      throw new Error(outputFormat === 'shapefile'
+        ? 'No shapefile components created'
+        : 'No valid layers found in GPX file');
+    }
+
+    // Merge the per-layer ZIPs into one archive, members copied as they are
+    return await mergeZipArchives(layerZips);
+  } finally {
+    // the pool keeps its workers warm, so close every session before releasing them
+    await Promise.all(shares.slice(1).map(({ pin, sessionId }) =>
+      request(pin, { type: 'closeSession', sessionId, fileName }).catch(() => {})));
+    extraPins.forEach((pin) => pin.release());
+    await closePlanSession();
+  }
+};
@@ -0,0 +1,94 @@
+/**
+ * Decoder for the binary info records of Native::getSessionInfoBinary (the
+ * layout is described in the "binary info" section of native.cpp).
+ *
+ * Returns the same object the info JSON parses to, so callers take either.
+ */
+
+const VALUE_TYPES = { 1: 'Integer', 2: 'Float', 3: 'String', 4: 'Date' };
+
+const HAS_LAYER = 1;
+const PROBE = 2;
+const COUNT_EXACT = 4;
+const BBOX_EXACT = 8;
+const HAS_BBOX = 16;
+const BBOX_REPROJECTED = 32;
+const DEBUG = 64;
+
+// Offset of the flags byte (after "GCI1" and the layer count)
+export const INFO_FLAGS_OFFSET = 8;
+
+const textDecoder = new TextDecoder();
+
+/**
+ * Decode one info record: { layers, featureCount, featureCountExact and
+ * bboxExact (probes only), geometryType, crs, bboxOriginal, bboxReprojected,
+ * bbox, properties: [{ name, value, type }] }, plus debugCrs/debugTransform
+ * when the record was built with debug logging.
+ */
+export const decodeVectorInfo = (buffer) => {
+  const view = new DataView(buffer);
+  const bytes = new Uint8Array(buffer);
+  if (textDecoder.decode(bytes.subarray(0, 4)) !== 'GCI1') {
+    throw new Error('Not an info record');
+  }
+
+  const flags = view.getUint8(INFO_FLAGS_OFFSET);
+  const info = { layers: view.getUint32(4, true) };
+  const featureCount = view.getFloat64(9, true);
+  const bboxOriginal = [0, 1, 2, 3].map((i) => view.getFloat64(17 + i * 8, true));
+  const bbox = [0, 1, 2, 3].map((i) => view.getFloat64(49 + i * 8, true));
+  let pos = 81;
+
+  const readString = () => {
+    const length = view.getUint32(pos, true);
+    const value = textDecoder.decode(bytes.subarray(pos + 4, pos + 4 + length));
+    pos += 4 + length;
+    return value;
+  };
+  const geometryType = readString();
+  const crs = readString();
+  const debugCrs = readString();
+  const debugTransform = readString();
+
+  if (flags & HAS_LAYER) {
+    info.featureCount = featureCount;
+    if (flags & PROBE) {
+      info.featureCountExact = Boolean(flags & COUNT_EXACT);
+      info.bboxExact = Boolean(flags & BBOX_EXACT);
+    }
+    info.geometryType = geometryType;
+    info.crs = crs;
+    if (flags & DEBUG) info.debugCrs = debugCrs;
+    if (flags & HAS_BBOX) {
+      info.bboxOriginal = bboxOriginal;
+      info.bboxReprojected = Boolean(flags & BBOX_REPROJECTED);
+      if (flags & DEBUG) info.debugTransform = debugTransform;
+      info.bbox = bbox;
+    }
+  }
+
+  const propertyCount = view.getUint32(pos, true);
+  pos += 4;
+  info.properties = new Array(propertyCount);
+  for (let i = 0; i < propertyCount; i++) {
+    const type = VALUE_TYPES[view.getUint8(pos)] || 'String';
+    const isNull = view.getUint8(pos + 1) !== 0;
+    pos += 2;
+    const name = readString();
+
+    let value = null;
+    if (!isNull && type === 'Integer') {
+      value = Number(view.getBigInt64(pos, true));
+      pos += 8;
+    } else if (!isNull && type === 'Float') {
+      value = view.getFloat64(pos, true);
+      pos += 8;
+    } else if (!isNull) {
+      value = readString();
+    }
+    info.properties[i] = { name, value, type };
+  }
+
+  return info;
+};
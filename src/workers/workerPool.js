@@ -0,0 +1,217 @@
+/**
+ * Pool of warm converter workers (runs on the main thread).
+ *
+ * The WASM binary is compiled once here and the WebAssembly.Module is posted
+ * to every worker, which instantiates it and runs Native.initialize right away
+ * ('warmup'), so no request pays for compilation, driver registration or the
+ * PROJ data mount. Each worker runs one request at a time. Queued requests are
+ * taken smallest estimated input first, and large ones never occupy the last
+ * free worker, so previews do not wait behind an export. A worker whose heap
+ * grew past RECYCLE_HEAP_BYTES (WASM memory never shrinks), that aborted or
+ * that crashed is replaced by a fresh one.
+ */
+
+// Each worker holds a full WASM instance, so keep the pool small
+const MAX_POOL_SIZE = 4;
+// Workers started (and warmed) up front; the rest start when requests queue up
+const WARM_WORKERS = 2;
+// Requests with at least this many input bytes count as large
+const LARGE_JOB_BYTES = 32 * 1024 * 1024;
+// A worker is replaced once its heap has grown past this
+const RECYCLE_HEAP_BYTES = 1024 * 1024 * 1024;
+// Failures after which the WASM instance cannot be trusted any more
+const BROKEN_INSTANCE = /aborted|out of memory|cannot enlarge memory|unreachable/i;
+
+const createWorker = () => new Worker(
+  new URL('./converter.worker.js', import.meta.url)
+);
+
+// The converter binary compiled once for every worker (null: each compiles its own)
+let compiledModule = null;
+const compileConverterModule = () => {
+  if (!compiledModule) {
+    const url = (self.location.origin || '') + '/cpp.wasm';
+    compiledModule = (WebAssembly.compileStreaming
+      ? WebAssembly.compileStreaming(fetch(url))
+      : Promise.reject(new Error('no compileStreaming')))
+      // servers without the application/wasm type
+      .catch(() => fetch(url).then((r) => r.arrayBuffer()).then((bytes) => WebAssembly.compile(bytes)))
+      .catch((error) => {
+        console.warn('WASM precompile failed, workers compile their own:', error.message);
+        return null;
+      });
+  }
+  return compiledModule;
+};
+
+/**
+ * Create a pool. run(message, { transfer, estimatedBytes, onMessage }) queues
+ * a request and resolves with its final message (success or not) after
+ * passing every typed message (progress, chunk, probe, batchItem) to
+ * onMessage; it rejects only when the worker crashed. pin() returns
+ * { run, release } whose requests all go to one worker, for sessions that
+ * live in that worker; a pinned worker is recycled only once released.
+ */
+export const createWorkerPool = ({
+  size = Math.max(2, Math.min(MAX_POOL_SIZE, navigator.hardwareConcurrency || 2))
+} = {}) => {
+  const slots = [];     // { worker, busy, warming, large, pins, retiring }
+  const queue = [];     // { message, transfer, estimatedBytes, onMessage, slot, resolve, reject, seq }
+  let nextSeq = 0;
+  let terminated = false;
+
+  const spawn = () => {
+    const slot = { worker: createWorker(), busy: true, warming: true, large: false, pins: 0, retiring: false };
+    slots.push(slot);
+    // warmup runs before anything else on the worker
+    compileConverterModule().then((wasmModule) => {
+      if (terminated || !slots.includes(slot)) return;
+      dispatch(slot, {
+        message: { type: 'warmup', wasmModule },
+        transfer: [],
+        estimatedBytes: 0,
+        // a failed warmup leaves the worker to initialize on its first request
+        resolve: () => { slot.warming = false; },
+        reject: () => {}
+      });
+    });
+    return slot;
+  };
+
+  const retire = (slot) => {
+    const index = slots.indexOf(slot);
+    if (index >= 0) slots.splice(index, 1);
+    slot.worker.terminate();
+    // requests pinned to it had their sessions there
+    for (let i = queue.length - 1; i >= 0; i--) {
+      if (queue[i].slot === slot) {
+        queue.splice(i, 1)[0].reject(new Error('Worker was restarted'));
+      }
+    }
+    if (!terminated && slots.length < WARM_WORKERS) spawn();
+  };
+
+  const dispatch = (slot, job) => {
+    slot.busy = true;
+    slot.large = job.estimatedBytes >= LARGE_JOB_BYTES;
+    const { worker } = slot;
+
+    const finish = () => {
+      worker.removeEventListener('message', handleMessage);
+      worker.removeEventListener('error', handleError);
+      slot.busy = false;
+      slot.large = false;
+    };
+    const handleMessage = (e) => {
+      if (e.data.type) {
+        if (job.onMessage) job.onMessage(e.data);
+        return;
+      }
+      finish();
+      const broken = !e.data.success && BROKEN_INSTANCE.test(e.data.error || '');
+      if (broken || e.data.heapBytes > RECYCLE_HEAP_BYTES) slot.retiring = true;
+      if (slot.retiring && slot.pins === 0) retire(slot);
+      job.resolve(e.data);
+      schedule();
+    };
+    const handleError = (e) => {
+      e.preventDefault();
+      finish();
+      retire(slot);
+      job.reject(new Error(e.message || 'Converter worker crashed'));
+      schedule();
+    };
+
+    worker.addEventListener('message', handleMessage);
+    worker.addEventListener('error', handleError);
+    worker.postMessage(job.message, job.transfer || []);
+  };
+
+  // The next queued job the slot may take: smallest first; large ones leave one
+  // worker free and stay off workers holding sessions while others are free of them
+  const nextJobFor = (slot) => {
+    const largeRunning = slots.filter((s) => s.busy && s.large).length;
+    const unpinnedSlots = slots.some((s) => s.pins === 0 && !s.retiring);
+    let best = -1;
+    queue.forEach((job, i) => {
+      if (job.slot && job.slot !== slot) return;
+      if (!job.slot && slot.retiring) return;
+      if (job.estimatedBytes >= LARGE_JOB_BYTES) {
+        if (slots.length > 1 && largeRunning >= slots.length - 1) return;
+        if (!job.slot && slot.pins > 0 && unpinnedSlots) return;
+      }
+      const current = queue[best];
+      if (best < 0 || job.estimatedBytes < current.estimatedBytes ||
+          (job.estimatedBytes === current.estimatedBytes && job.seq < current.seq)) {
+        best = i;
+      }
+    });
+    return best;
+  };
+
+  const schedule = () => {
+    if (terminated) return;
+    for (const slot of slots) {
+      if (slot.busy) continue;
+      const index = nextJobFor(slot);
+      if (index >= 0) dispatch(slot, queue.splice(index, 1)[0]);
+    }
+    // unpinned work waiting and no free (or soon free) worker without sessions: grow
+    if (queue.some((job) => !job.slot) && slots.length < size &&
+        slots.every((s) => (s.busy && !s.warming) || s.pins > 0)) {
+      spawn();
+    }
+  };
+
+  const enqueue = (message, options = {}, slot = null) => new Promise((resolve, reject) => {
+    if (terminated) {
+      reject(new Error('Worker pool terminated'));
+      return;
+    }
+    queue.push({
+      message,
+      transfer: options.transfer,
+      estimatedBytes: options.estimatedBytes || 0,
+      onMessage: options.onMessage,
+      slot,
+      resolve,
+      reject,
+      seq: nextSeq++
+    });
+    schedule();
+  });
+
+  const pin = () => {
+    if (terminated) throw new Error('Worker pool terminated');
+    if (slots.length < size && slots.every((s) => s.pins > 0)) spawn();
+    const candidates = slots.filter((s) => !s.retiring);
+    const slot = (candidates.length > 0 ? candidates : slots)
+      .reduce((a, b) => (b.pins < a.pins ? b : a));
+    slot.pins++;
+    let released = false;
+    return {
+      run: (message, options) => enqueue(message, options, slot),
+      release: () => {
+        if (released) return;
+        released = true;
+        slot.pins--;
+        if (slot.retiring && slot.pins === 0 && !slot.busy) retire(slot);
+        schedule();
+      }
+    };
+  };
+
+  for (let i = 0; i < Math.min(WARM_WORKERS, size); i++) spawn();
+
+  return {
+    size,
+    run: (message, options) => enqueue(message, options),
+    pin,
+    terminate: () => {
+      terminated = true;
+      slots.forEach((slot) => slot.worker.terminate());
+      slots.length = 0;
+      queue.splice(0).forEach((job) => job.reject(new Error('Worker pool terminated')));
+    }
+  };
+};
@@ -0,0 +1,92 @@
+/**
+ * Merge of ZIP archives into one without touching their members (runs on the
+ * main thread, for the per-layer ZIPs of convertSessionLayer).
+ *
+ * Local records are copied as Blob slices, deflated or stored as the worker
+ * wrote them (so zipCompression 'store' is kept), and only the central
+ * directory is rebuilt. Reads archives without ZIP64 or a trailing comment,
+ * which is what the native ZIP writer produces.
+ */
+
+const EOCD_SIGNATURE = 0x06054b50;
+const EOCD_SIZE = 22;
+const CENTRAL_SIGNATURE = 0x02014b50;
+const CENTRAL_HEADER_SIZE = 46;
+const LOCAL_OFFSET_FIELD = 42;
+
+const textDecoder = new TextDecoder();
+
+// Central directory entries of one archive, each with its local record
+// (header, data and any data descriptor) as a slice of the archive
+const readEntries = async (zip) => {
+  if (zip.size < EOCD_SIZE) throw new Error('Not a ZIP archive');
+  const end = new DataView(await zip.slice(zip.size - EOCD_SIZE).arrayBuffer());
+  if (end.getUint32(0, true) !== EOCD_SIGNATURE) {
+    throw new Error('Unsupported ZIP archive (ZIP64 or comment)');
+  }
+  const count = end.getUint16(10, true);
+  const centralSize = end.getUint32(12, true);
+  const centralOffset = end.getUint32(16, true);
+
+  const central = new Uint8Array(await zip.slice(centralOffset, centralOffset + centralSize).arrayBuffer());
+  const view = new DataView(central.buffer);
+  const entries = [];
+  let pos = 0;
+  for (let i = 0; i < count; i++) {
+    if (pos + CENTRAL_HEADER_SIZE > central.length || view.getUint32(pos, true) !== CENTRAL_SIGNATURE) {
+      throw new Error('Corrupt ZIP central directory');
+    }
+    const nameLength = view.getUint16(pos + 28, true);
+    const length = CENTRAL_HEADER_SIZE + nameLength + view.getUint16(pos + 30, true) + view.getUint16(pos + 32, true);
+    entries.push({
+      name: textDecoder.decode(central.subarray(pos + CENTRAL_HEADER_SIZE, pos + CENTRAL_HEADER_SIZE + nameLength)),
+      header: central.slice(pos, pos + length),
+      localOffset: view.getUint32(pos + LOCAL_OFFSET_FIELD, true)
+    });
+    pos += length;
+  }
+
+  // records are contiguous: each one ends where the next (or the directory) starts
+  const byOffset = [...entries].sort((a, b) => a.localOffset - b.localOffset);
+  byOffset.forEach((entry, i) => {
+    const next = i + 1 < byOffset.length ? byOffset[i + 1].localOffset : centralOffset;
+    entry.record = zip.slice(entry.localOffset, next);
+  });
+  return entries;
+};
+
+/**
+ * Merge archives (Blobs) into one ZIP Blob. Directory entries are dropped; a
+ * member name that appears again replaces the earlier member.
+ */
+export const mergeZipArchives = async (zips) => {
+  const members = new Map();
+  for (const zip of zips) {
+    for (const entry of await readEntries(zip)) {
+      if (!entry.name.endsWith('/')) members.set(entry.name, entry);
+    }
+  }
+
+  const records = [];
+  const central = [];
+  let offset = 0;
+  let centralSize = 0;
+  for (const { header, record } of members.values()) {
+    new DataView(header.buffer).setUint32(LOCAL_OFFSET_FIELD, offset, true);
+    records.push(record);
+    central.push(header);
+    offset += record.size;
+    centralSize += header.length;
+  }
+  if (offset + centralSize > 0xFFFFFFFF || members.size > 0xFFFF) {
+    throw new Error('ZIP output larger than 4 GB is not supported');
+  }
+
+  const end = new DataView(new ArrayBuffer(EOCD_SIZE));
+  end.setUint32(0, EOCD_SIGNATURE, true);
+  end.setUint16(8, members.size, true);
+  end.setUint16(10, members.size, true);
+  end.setUint32(12, centralSize, true);
+  end.setUint32(16, offset, true);
+  return new Blob([...records, ...central, end.buffer], { type: 'application/zip' });
+};
@@ -4,6 +4,14 @@ import viteCppjsPlugin from '@cpp.js/plugin-vite'
 import tailwindcss from '@tailwindcss/vite'
 import path from 'path'
 
+// The pthreads WASM build needs SharedArrayBuffer, i.e. a cross-origin isolated
+// page. credentialless (not require-corp) keeps the third-party font, analytics
+// and basemap requests working. Production hosting sends the same headers
+// (public/_headers).
+const crossOriginIsolation = {
+  'Cross-Origin-Opener-Policy': 'same-origin',
+  'Cross-Origin-Embedder-Policy': 'credentialless',
+}
 
 // https://vitejs.dev/config/
 export default defineConfig({
@@ -13,4 +21,10 @@ export default defineConfig({
       '@': path.resolve(__dirname, './src'),
     },
   },
+  server: {
+    headers: crossOriginIsolation,
+  },
+  preview: {
+    headers: crossOriginIsolation,
+  },
 })